@@ -0,0 +1,39 @@
+#pragma once
+
+#include "SplineEvaluator.h"
+
+namespace FCSE {
+    // Distance along a keyframe path, sampled at fixed curve parameters per segment. Maps distances back to a segment and
+    // curve parameter for evenly spaced markers and constant-speed timing. Samples are stored as 16-bit fractions of
+    // their segment's length, so a path of n keyframes takes about 34 bytes per segment.
+    class ArcLengthTable {
+    public:
+        static constexpr uint32_t kSamplesPerSegment = 16;
+
+        void Build(std::span<const RE::NiPoint3> a_points, std::span<const InterpolationMode> a_modes);
+        void Clear();
+        // Re-measures the segments whose curve depends on keyframe a_index after it was moved
+        void UpdateKeyframe(std::span<const RE::NiPoint3> a_points, std::span<const InterpolationMode> a_modes, size_t a_index);
+
+        bool IsEmpty() const { return m_keyframeDistances.size() < 2; }
+        size_t GetSegmentCount() const { return m_keyframeDistances.empty() ? 0 : m_keyframeDistances.size() - 1; }
+        float GetTotalLength() const { return m_keyframeDistances.empty() ? 0.f : m_keyframeDistances.back(); }
+        // Distance along the path at keyframe a_index
+        float GetKeyframeDistance(size_t a_index) const { return m_keyframeDistances[a_index]; }
+        float GetSegmentLength(size_t a_segment) const { return m_keyframeDistances[a_segment + 1] - m_keyframeDistances[a_segment]; }
+
+        // Segment and curve parameter at a_distance along the path, clamped to the path's ends
+        void Locate(float a_distance, size_t& a_segment, float& a_t) const;
+
+    private:
+        static constexpr uint32_t kFractionsPerSegment = kSamplesPerSegment - 1;  // 0 and 1 are implicit
+        static constexpr float kFractionScale = 65535.f;
+
+        // Returns the segment length and writes its interior sample fractions
+        static float MeasureSegment(std::span<const RE::NiPoint3> a_points, std::span<const InterpolationMode> a_modes, size_t a_segment,
+                                    uint16_t* a_fractions);
+
+        std::vector<float> m_keyframeDistances;  // prefix sum of the segment lengths
+        std::vector<uint16_t> m_fractions;       // kFractionsPerSegment per segment
+    }; // class ArcLengthTable
+} // namespace FCSE
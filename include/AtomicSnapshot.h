@@ -0,0 +1,26 @@
+#pragma once
+
+namespace FCSE {
+    // An immutable value published to any number of threads. Readers load the current snapshot without locking and keep
+    // it alive for as long as they hold it; writers copy the current one, modify the copy and swap it in, serialised by
+    // a mutex so concurrent edits are not lost.
+    template <class T>
+    class AtomicSnapshot {
+    public:
+        std::shared_ptr<const T> Load() const {
+            return m_value.load(std::memory_order_acquire);
+        }
+
+        template <class Func>
+        void Modify(Func&& a_modify) {
+            std::lock_guard lock(m_writeMutex);
+            auto next = std::make_shared<T>(*m_value.load(std::memory_order_relaxed));
+            a_modify(*next);
+            m_value.store(std::move(next), std::memory_order_release);
+        }
+
+    private:
+        std::atomic<std::shared_ptr<const T>> m_value{ std::make_shared<const T>() };
+        std::mutex m_writeMutex;  // serialises writers only, readers never take it
+    }; // class AtomicSnapshot
+} // namespace FCSE
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "SplineEvaluator.h"
+#include "TimelineFile.h"
+
+namespace FCSE {
+    // Streaming low-pass filter whose cutoff rises with speed (the one-euro filter): slow motion is smoothed hard, which
+    // removes jitter, fast motion is followed with little lag. The N channels are filtered together and share the
+    // cutoff picked from their combined speed.
+    template <size_t N>
+    class OneEuroFilter {
+    public:
+        using Value = std::array<float, N>;
+
+        void SetParameters(float a_minCutoff, float a_beta, float a_derivativeCutoff) {
+            m_minCutoff = a_minCutoff;
+            m_beta = a_beta;
+            m_derivativeCutoff = a_derivativeCutoff;
+        }
+
+        void Reset() { m_isInitialized = false; }
+
+        Value Filter(const Value& a_value, float a_deltaTime) {
+            if (!m_isInitialized || a_deltaTime <= 0.f) {
+                m_isInitialized = true;
+                m_value = a_value;
+                m_derivative = {};
+                return m_value;
+            }
+
+            const float derivativeAlpha = GetAlpha(m_derivativeCutoff, a_deltaTime);
+            float speedSquared = 0.f;
+            for (size_t i = 0; i < N; ++i) {
+                const float derivative = (a_value[i] - m_value[i]) / a_deltaTime;
+                m_derivative[i] += derivativeAlpha * (derivative - m_derivative[i]);
+                speedSquared += m_derivative[i] * m_derivative[i];
+            }
+
+            const float alpha = GetAlpha(m_minCutoff + m_beta * std::sqrt(speedSquared), a_deltaTime);
+            for (size_t i = 0; i < N; ++i) {
+                m_value[i] += alpha * (a_value[i] - m_value[i]);
+            }
+            return m_value;
+        }
+
+    private:
+        static float GetAlpha(float a_cutoff, float a_deltaTime) {
+            const float tau = 1.f / (2.f * std::numbers::pi_v<float> * a_cutoff);
+            return 1.f / (1.f + tau / a_deltaTime);
+        }
+
+        float m_minCutoff = 1.f;  // Hz
+        float m_beta = 0.f;       // cutoff added per unit of speed
+        float m_derivativeCutoff = 1.f;
+        bool m_isInitialized = false;
+        Value m_value{};
+        Value m_derivative{};
+    }; // class OneEuroFilter
+
+    // Records the free camera every frame and keeps only the keyframes needed to reproduce the motion. Samples are
+    // filtered to remove jitter and held in a ring buffer; translation and rotation are fitted separately, each keeps
+    // extending its last segment until a buffered sample deviates from the Catmull-Rom segment FCFW would play back by
+    // more than the tolerance, and then emits the sample before as a keyframe. The check includes the segment before,
+    // whose end tangent depends on the new keyframe, so every emitted segment is verified against the tangents it is
+    // played back with.
+    class CameraRecorder {
+    public:
+        static CameraRecorder& GetSingleton() {
+            static CameraRecorder instance;
+            return instance;
+        }
+        CameraRecorder(const CameraRecorder&) = delete;
+        CameraRecorder& operator=(const CameraRecorder&) = delete;
+
+        // Reads tolerances and filter parameters from the [Recorder] section of the plugin INI
+        void LoadSettings(const char* a_iniPath);
+
+        void Start();
+        // Adds the camera state of one frame, a_deltaTime seconds after the previous one. Angles are in radians.
+        void AddSample(float a_deltaTime, const RE::NiPoint3& a_position, float a_pitch, float a_yaw);
+        // Emits the last sample and hands over the keyframes, with times starting at 0. Yaw is unwrapped, so it can
+        // leave [-pi, pi] and the camera never turns the long way round between two keyframes.
+        TimelineData Stop();
+
+        bool IsRecording() const { return m_isRecording; }
+        uint64_t GetSampleCount() const { return m_sampleCount; }
+        size_t GetKeyframeCount() const { return m_translation.points.size() + m_rotation.points.size(); }
+
+    private:
+        CameraRecorder() { m_rotation.isRotation = true; }
+        ~CameraRecorder() = default;
+
+        struct Sample {
+            float time = 0.f;
+            RE::NiPoint3 position;
+            RE::NiPoint3 rotation;  // pitch, yaw, 0
+        };
+
+        // Keyframes emitted for one track, as sample values
+        struct Track {
+            bool isRotation = false;
+            std::vector<float> times;
+            std::vector<RE::NiPoint3> points;
+            uint64_t anchor = 0;    // sample of the last keyframe
+            uint64_t previous = 0;  // sample of the keyframe before, equal to anchor while there is one keyframe
+
+            void Clear() {
+                times.clear();
+                points.clear();
+                anchor = 0;
+                previous = 0;
+            }
+        };
+
+        static constexpr size_t kCapacity = 1024;  // samples; bounds the length of two consecutive segments
+        static constexpr float kMaxDeltaTime = 0.1f;  // longer frames, such as while a menu is open, are shortened
+
+        const RE::NiPoint3& GetValue(const Track& a_track, uint64_t a_sample) const;
+        bool IsWithinTolerance(const Track& a_track, const RE::NiPoint3& a_predicted, const RE::NiPoint3& a_actual) const;
+        bool FitsSegment(const Track& a_track, const RE::NiPoint3& a_p0, uint64_t a_from, uint64_t a_to, const RE::NiPoint3& a_p3) const;
+        void Advance(Track& a_track, uint64_t a_sample);
+        void Emit(Track& a_track, uint64_t a_sample);
+
+        float m_positionTolerance = 2.f;  // game units
+        float m_angleTolerance = 0.25f * std::numbers::pi_v<float> / 180.f;
+        OneEuroFilter<3> m_positionFilter;
+        OneEuroFilter<2> m_rotationFilter;
+        float m_minCutoff = 1.f;
+        float m_positionBeta = 0.1f;
+        float m_rotationBeta = 20.f;
+        float m_derivativeCutoff = 1.f;
+
+        bool m_isRecording = false;
+        std::array<Sample, kCapacity> m_samples;
+        uint64_t m_sampleCount = 0;
+        float m_time = 0.f;
+        float m_lastRawYaw = 0.f;
+        float m_yaw = 0.f;  // unwrapped
+        Track m_translation;
+        Track m_rotation;
+    }; // class CameraRecorder
+} // namespace FCSE
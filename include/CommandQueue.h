@@ -0,0 +1,42 @@
+#pragma once
+
+namespace FCSE {
+    // Lock-free single-producer / single-consumer ring buffer.
+    // The producer only writes m_tail, the consumer only writes m_head.
+    template <class T, size_t Capacity>
+    class CommandQueue {
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        // Returns false if the queue is full
+        bool Push(const T& a_item) {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_head.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+            m_items[tail & (Capacity - 1)] = a_item;
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Returns false if the queue is empty
+        bool Pop(T& a_item) {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            a_item = m_items[head & (Capacity - 1)];
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool IsEmpty() const {
+            return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::array<T, Capacity> m_items{};
+        alignas(64) std::atomic<size_t> m_head = 0;
+        alignas(64) std::atomic<size_t> m_tail = 0;
+    }; // class CommandQueue
+} // namespace FCSE
@@ -1,34 +1,9 @@
 #pragma once
 
-namespace FCSE {
-    struct DXScanCode{
-        uint32_t key;
-
-        explicit DXScanCode(uint32_t a_key) : key(a_key) {
-            if (a_key > InputMap::kMaxMacros) { // not a valid DXScanCode
-                key = InputMap::kMaxMacros;
-            }
-        }
-
-        // Default constructor
-        DXScanCode() : key(InputMap::kMaxMacros) {}
+#include "CommandQueue.h"
+#include "InputDispatcher.h"
 
-        // Allow explicit conversion to uint32_t
-        explicit operator uint32_t() const { return key; }
-
-        DXScanCode& operator=(uint32_t a_newKey) {
-            key = a_newKey;
-            return *this;
-        }
-    
-        bool operator==(const DXScanCode& a_other) const {
-            return key == a_other.key;
-        }
-        bool operator==(uint32_t a_otherKey) const {
-            return key == a_otherKey;
-        }
-    };
-    
+namespace FCSE {
     class ControlsManager : public RE::BSTEventSink<RE::InputEvent*> {
     public:
         static ControlsManager& GetSingleton() {
@@ -40,10 +15,36 @@ namespace FCSE {
 
         RE::BSEventNotifyControl ProcessEvent(RE::InputEvent* const* a_event, RE::BSTEventSource<RE::InputEvent*>*) override;
 
+        // Builds the dispatch table from kDefaultKeyBindings and the [Controls] section of the INI
+        void LoadSettings(const char* a_iniPath);
+
+        // Executes the actions queued by the input sink, called from the main update hook
+        void Update();
+
     private:
         ControlsManager() = default;
         ~ControlsManager() = default;
-        
-        RE::NiPointer<RE::NiAVObject> GetTargetPoint(RE::Actor* a_actor);
+
+        // Input events only queue commands, all FCFW calls happen on the main update in Update()
+        using Command = InputDispatcher::Command;
+        static constexpr size_t kCommandQueueSize = 64;
+        static constexpr long long kCommandBudgetMicroseconds = 1000;
+        static constexpr float kScrubSecondsPerCount = 0.01f;  // timeline seconds per horizontal mouse count
+        static constexpr RE::FormID kSceneReferenceID = 0xd8c58;  // actor the reference scene is built around
+
+        static bool IsBlockedWhileImporting(Action a_action);
+        // The take selected in the library, else a_defaultPath; its binary copy while that is up to date
+        static std::string GetImportPath(std::string_view a_defaultPath);
+        void QueueCommand(const Command& a_command);
+        // Releases every held key; the sink misses releases while the game is paused or in the background
+        void ResetInput();
+        void ExecuteAction(Action a_action);
+        void ExecuteRelease(Action a_action);
+
+        InputDispatcher m_dispatcher;              // input thread
+        CommandQueue<Command, kCommandQueueSize> m_commands;
+        bool m_isScrubbing = false;                // input thread
+        std::atomic<int32_t> m_scrubMouseDelta = 0;  // accumulated by the input thread, consumed by Update
+        std::atomic<bool> m_isInputStale = false;    // set by Update while the game is in the background
     }; // class ControlsManager
 } // namespace FCSE
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "ViewFrustum.h"
+
+namespace FCSE {
+    // Collects draw work from all FCSE visual producers and executes it within a per-frame budget.
+    // Items closer to the camera and nearer to the crosshair go first; items that do not fit are
+    // deferred and gain priority every frame they wait, so the backlog is worked off round-robin.
+    class DrawScheduler {
+    public:
+        static DrawScheduler& GetSingleton() {
+            static DrawScheduler instance;
+            return instance;
+        }
+        DrawScheduler(const DrawScheduler&) = delete;
+        DrawScheduler& operator=(const DrawScheduler&) = delete;
+
+        enum class Producer : uint8_t {
+            kPath,
+            kKeyframes,
+            kGizmos,
+            kOverlay
+        };
+
+        // Reads the budget from the [Draw] section of the plugin INI
+        void LoadSettings(const char* a_iniPath);
+
+        // Sets the view used to prioritise the items enqueued this frame
+        void BeginFrame(const ViewFrustum& a_frustum);
+
+        // a_key must be unique per producer; a_primitiveCount is the number of TrueHUD calls a_draw makes
+        void Enqueue(Producer a_producer, uint64_t a_key, const RE::NiPoint3& a_position, float a_radius,
+                     uint32_t a_primitiveCount, std::function<void()> a_draw);
+
+        // Executes queued items in priority order until the budget is used up, defers the rest
+        void Flush();
+
+        size_t GetDeferredCount() const { return m_deferredCount; }
+
+    private:
+        DrawScheduler() = default;
+        ~DrawScheduler() = default;
+
+        struct WorkItem {
+            uint64_t id = 0;
+            float priority = 0.f;
+            uint32_t primitiveCount = 0;
+            std::function<void()> draw;
+        };
+
+        static constexpr float kCrosshairBoost = 4.f;     // priority factor for items right under the crosshair
+        static constexpr float kWaitBoost = 0.25f;        // priority factor added per deferred frame
+        static constexpr std::array<float, 4> kProducerWeights = { 1.f, 1.5f, 1.5f, 2.f };
+
+        static uint64_t MakeID(Producer a_producer, uint64_t a_key) {
+            return (static_cast<uint64_t>(a_producer) << 56) ^ a_key;
+        }
+
+        uint32_t m_budgetMicroseconds = 2000;  // 0 = unlimited
+        uint32_t m_budgetPrimitives = 4000;    // 0 = unlimited
+
+        ViewFrustum m_frustum;
+        std::vector<WorkItem> m_queue;
+        std::unordered_map<uint64_t, uint32_t> m_waitFrames;
+        size_t m_deferredCount = 0;
+    }; // class DrawScheduler
+} // namespace FCSE
@@ -0,0 +1,243 @@
+#pragma once
+
+// Batch evaluation of cubic path segments with SSE2 and a scalar fallback, selected once at runtime.
+// Only depends on the standard library and compiler intrinsics, so it can be used outside the plugin.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#    define FCSE_SIMD_X86 1
+#    include <immintrin.h>
+#else
+#    define FCSE_SIMD_X86 0
+#endif
+
+namespace FCSE {
+    enum class SimdLevel : uint8_t {
+        kScalar,
+        kSSE2
+    };
+
+    // One segment in power basis, stored per axis: value = c[0] + c[1] u + c[2] u^2 + c[3] u^3
+    struct CubicSegment {
+        std::array<std::array<float, 4>, 3> c{};
+
+        // Catmull-Rom style Hermite segment p1 -> p2 with tangents (p2 - p0) / 2 and (p3 - p1) / 2, as used by FCFW
+        static CubicSegment FromHermite(const std::array<float, 3>& a_p0, const std::array<float, 3>& a_p1,
+                                        const std::array<float, 3>& a_p2, const std::array<float, 3>& a_p3) {
+            CubicSegment segment;
+            for (size_t axis = 0; axis < 3; ++axis) {
+                const float m1 = (a_p2[axis] - a_p0[axis]) * 0.5f;
+                const float m2 = (a_p3[axis] - a_p1[axis]) * 0.5f;
+                segment.c[axis] = { a_p1[axis], m1, 3.f * (a_p2[axis] - a_p1[axis]) - 2.f * m1 - m2, 2.f * (a_p1[axis] - a_p2[axis]) + m1 + m2 };
+            }
+            return segment;
+        }
+
+        static CubicSegment FromLinear(const std::array<float, 3>& a_p1, const std::array<float, 3>& a_p2) {
+            CubicSegment segment;
+            for (size_t axis = 0; axis < 3; ++axis) {
+                segment.c[axis] = { a_p1[axis], a_p2[axis] - a_p1[axis], 0.f, 0.f };
+            }
+            return segment;
+        }
+
+        // First derivative with respect to u, itself a (quadratic) segment
+        CubicSegment Derivative() const {
+            CubicSegment derivative;
+            for (size_t axis = 0; axis < 3; ++axis) {
+                derivative.c[axis] = { c[axis][1], 2.f * c[axis][2], 3.f * c[axis][3], 0.f };
+            }
+            return derivative;
+        }
+    };
+
+    // Output of a batch evaluation, one array per axis with at least as many entries as parameters
+    struct SampleArrays {
+        float* x = nullptr;
+        float* y = nullptr;
+        float* z = nullptr;
+    };
+
+    // Pieces of a curve under subdivision, one array per component. All pieces of a batch cover parameter ranges of
+    // the same length, a third of which is span.
+    struct HullArrays {
+        std::array<const float*, 3> start{};
+        std::array<const float*, 3> end{};
+        std::array<const float*, 3> startTangent{};
+        std::array<const float*, 3> endTangent{};
+        float span = 0.f;
+    };
+
+    // Error allowed for a piece: errorScaleSq * max(squared camera distance of its nearer end, minDistanceSq)
+    struct HullTolerance {
+        std::array<float, 3> camera{};
+        float errorScaleSq = 0.f;
+        float minDistanceSq = 0.f;
+    };
+
+    namespace detail {
+        // AVX2 versions were measured in tools/SplineBench and made no difference to tessellation, whose batches
+        // rarely exceed a few dozen pieces, so SSE2 (part of x64) is the widest path
+        inline SimdLevel DetectSimdLevel() {
+#if FCSE_SIMD_X86
+            return SimdLevel::kSSE2;
+#else
+            return SimdLevel::kScalar;
+#endif
+        }
+
+        inline const SimdLevel kDetectedSimdLevel = DetectSimdLevel();
+        inline SimdLevel g_simdLevel = kDetectedSimdLevel;
+
+        // Horner's scheme in the same operation order for every width, without fused multiply-adds, so all paths
+        // produce the same bits as the scalar one
+        inline void EvaluateCubicScalar(const CubicSegment& a_segment, const float* a_u, size_t a_begin, size_t a_end, const SampleArrays& a_out) {
+            float* out[3] = { a_out.x, a_out.y, a_out.z };
+            for (size_t axis = 0; axis < 3; ++axis) {
+                const auto& c = a_segment.c[axis];
+                for (size_t i = a_begin; i < a_end; ++i) {
+                    const float u = a_u[i];
+                    out[axis][i] = ((c[3] * u + c[2]) * u + c[1]) * u + c[0];
+                }
+            }
+        }
+
+        // The Bezier hull of a piece has the control points start + startTangent * span and end - endTangent * span.
+        // A piece is split if either of them is farther from the chord than the allowed error.
+        inline void TestHullsScalar(const HullArrays& a_hulls, const HullTolerance& a_tolerance, size_t a_begin, size_t a_end, uint8_t* a_split) {
+            for (size_t i = a_begin; i < a_end; ++i) {
+                std::array<float, 3> dir, v1, v2, toStart, toEnd;
+                for (size_t axis = 0; axis < 3; ++axis) {
+                    const float start = a_hulls.start[axis][i];
+                    const float end = a_hulls.end[axis][i];
+                    dir[axis] = end - start;
+                    v1[axis] = (start + a_hulls.startTangent[axis][i] * a_hulls.span) - start;
+                    v2[axis] = (end - a_hulls.endTangent[axis][i] * a_hulls.span) - start;
+                    toStart[axis] = start - a_tolerance.camera[axis];
+                    toEnd[axis] = end - a_tolerance.camera[axis];
+                }
+
+                const auto dot = [](const std::array<float, 3>& a_a, const std::array<float, 3>& a_b) {
+                    return (a_a[0] * a_b[0] + a_a[1] * a_b[1]) + a_a[2] * a_b[2];
+                };
+                const float lengthSq = dot(dir, dir);
+                const auto distanceSq = [&](const std::array<float, 3>& a_v) {
+                    // Degenerate chords measure the distance to the start point
+                    const float t = lengthSq < 1e-6f ? 0.f : std::min(std::max(dot(a_v, dir) / lengthSq, 0.f), 1.f);
+                    const std::array<float, 3> w = { a_v[0] - dir[0] * t, a_v[1] - dir[1] * t, a_v[2] - dir[2] * t };
+                    return dot(w, w);
+                };
+
+                const float flatnessSq = std::max(distanceSq(v1), distanceSq(v2));
+                const float cameraDistanceSq = std::min(dot(toStart, toStart), dot(toEnd, toEnd));
+                a_split[i] = flatnessSq > a_tolerance.errorScaleSq * std::max(cameraDistanceSq, a_tolerance.minDistanceSq);
+            }
+        }
+
+#if FCSE_SIMD_X86
+        inline size_t EvaluateCubicSSE2(const CubicSegment& a_segment, const float* a_u, size_t a_count, const SampleArrays& a_out) {
+            float* out[3] = { a_out.x, a_out.y, a_out.z };
+            const size_t blocks = a_count & ~size_t(3);
+            for (size_t axis = 0; axis < 3; ++axis) {
+                const auto& c = a_segment.c[axis];
+                const __m128 c0 = _mm_set1_ps(c[0]);
+                const __m128 c1 = _mm_set1_ps(c[1]);
+                const __m128 c2 = _mm_set1_ps(c[2]);
+                const __m128 c3 = _mm_set1_ps(c[3]);
+                for (size_t i = 0; i < blocks; i += 4) {
+                    const __m128 u = _mm_loadu_ps(a_u + i);
+                    __m128 value = _mm_add_ps(_mm_mul_ps(c3, u), c2);
+                    value = _mm_add_ps(_mm_mul_ps(value, u), c1);
+                    value = _mm_add_ps(_mm_mul_ps(value, u), c0);
+                    _mm_storeu_ps(out[axis] + i, value);
+                }
+            }
+            return blocks;
+        }
+
+        inline __m128 Dot3SSE2(const __m128* a_a, const __m128* a_b) {
+            return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a_a[0], a_b[0]), _mm_mul_ps(a_a[1], a_b[1])), _mm_mul_ps(a_a[2], a_b[2]));
+        }
+
+        inline __m128 SqrDistanceToChordSSE2(const __m128* a_v, const __m128* a_dir, __m128 a_lengthSq, __m128 a_isLine) {
+            const __m128 t = _mm_and_ps(a_isLine, _mm_min_ps(_mm_max_ps(_mm_div_ps(Dot3SSE2(a_v, a_dir), a_lengthSq), _mm_setzero_ps()), _mm_set1_ps(1.f)));
+            const __m128 w[3] = { _mm_sub_ps(a_v[0], _mm_mul_ps(a_dir[0], t)), _mm_sub_ps(a_v[1], _mm_mul_ps(a_dir[1], t)),
+                                  _mm_sub_ps(a_v[2], _mm_mul_ps(a_dir[2], t)) };
+            return Dot3SSE2(w, w);
+        }
+
+        inline size_t TestHullsSSE2(const HullArrays& a_hulls, const HullTolerance& a_tolerance, size_t a_count, uint8_t* a_split) {
+            const size_t blocks = a_count & ~size_t(3);
+            const __m128 epsilon = _mm_set1_ps(1e-6f);
+            const __m128 errorScaleSq = _mm_set1_ps(a_tolerance.errorScaleSq);
+            const __m128 minDistanceSq = _mm_set1_ps(a_tolerance.minDistanceSq);
+            const __m128 span = _mm_set1_ps(a_hulls.span);
+            for (size_t i = 0; i < blocks; i += 4) {
+                __m128 dir[3], v1[3], v2[3], toStart[3], toEnd[3];
+                for (size_t axis = 0; axis < 3; ++axis) {
+                    const __m128 start = _mm_loadu_ps(a_hulls.start[axis] + i);
+                    const __m128 end = _mm_loadu_ps(a_hulls.end[axis] + i);
+                    const __m128 camera = _mm_set1_ps(a_tolerance.camera[axis]);
+                    dir[axis] = _mm_sub_ps(end, start);
+                    v1[axis] = _mm_sub_ps(_mm_add_ps(start, _mm_mul_ps(_mm_loadu_ps(a_hulls.startTangent[axis] + i), span)), start);
+                    v2[axis] = _mm_sub_ps(_mm_sub_ps(end, _mm_mul_ps(_mm_loadu_ps(a_hulls.endTangent[axis] + i), span)), start);
+                    toStart[axis] = _mm_sub_ps(start, camera);
+                    toEnd[axis] = _mm_sub_ps(end, camera);
+                }
+
+                const __m128 lengthSq = Dot3SSE2(dir, dir);
+                const __m128 isLine = _mm_cmpge_ps(lengthSq, epsilon);
+                const __m128 flatnessSq = _mm_max_ps(SqrDistanceToChordSSE2(v1, dir, lengthSq, isLine), SqrDistanceToChordSSE2(v2, dir, lengthSq, isLine));
+                const __m128 cameraDistanceSq = _mm_min_ps(Dot3SSE2(toStart, toStart), Dot3SSE2(toEnd, toEnd));
+                const int mask = _mm_movemask_ps(_mm_cmpgt_ps(flatnessSq, _mm_mul_ps(errorScaleSq, _mm_max_ps(cameraDistanceSq, minDistanceSq))));
+                for (size_t lane = 0; lane < 4; ++lane) {
+                    a_split[i + lane] = (mask >> lane) & 1;
+                }
+            }
+            return blocks;
+        }
+#endif
+    }
+
+    // Widest instruction set available to this build
+    inline SimdLevel GetDetectedSimdLevel() { return detail::kDetectedSimdLevel; }
+    // Instruction set used by the batch functions; can be lowered to compare against the scalar path
+    inline SimdLevel GetSimdLevel() { return detail::g_simdLevel; }
+    inline void SetSimdLevel(SimdLevel a_level) { detail::g_simdLevel = a_level < detail::kDetectedSimdLevel ? a_level : detail::kDetectedSimdLevel; }
+
+    inline const char* GetSimdLevelName(SimdLevel a_level) {
+        switch (a_level) {
+        case SimdLevel::kSSE2:
+            return "SSE2";
+        default:
+            return "scalar";
+        }
+    }
+
+    // Evaluates a_segment at every parameter in a_u. Use a_segment.Derivative() for tangents.
+    inline void EvaluateCubic(const CubicSegment& a_segment, std::span<const float> a_u, const SampleArrays& a_out) {
+        size_t done = 0;
+#if FCSE_SIMD_X86
+        if (detail::g_simdLevel == SimdLevel::kSSE2) {
+            done = detail::EvaluateCubicSSE2(a_segment, a_u.data(), a_u.size(), a_out);
+        }
+#endif
+        detail::EvaluateCubicScalar(a_segment, a_u.data(), done, a_u.size(), a_out);
+    }
+
+    // Sets a_split[i] for every piece whose Bezier hull deviates from its chord by more than the allowed error
+    inline void TestHulls(const HullArrays& a_hulls, const HullTolerance& a_tolerance, size_t a_count, uint8_t* a_split) {
+        size_t done = 0;
+#if FCSE_SIMD_X86
+        if (detail::g_simdLevel == SimdLevel::kSSE2) {
+            done = detail::TestHullsSSE2(a_hulls, a_tolerance, a_count, a_split);
+        }
+#endif
+        detail::TestHullsScalar(a_hulls, a_tolerance, done, a_count, a_split);
+    }
+} // namespace FCSE
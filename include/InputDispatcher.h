@@ -0,0 +1,197 @@
+#pragma once
+
+namespace FCSE {
+    struct DXScanCode{
+        uint32_t key;
+
+        explicit DXScanCode(uint32_t a_key) : key(a_key) {
+            if (a_key > InputMap::kMaxMacros) { // not a valid DXScanCode
+                key = InputMap::kMaxMacros;
+            }
+        }
+
+        // Default constructor
+        DXScanCode() : key(InputMap::kMaxMacros) {}
+
+        // Allow explicit conversion to uint32_t
+        explicit operator uint32_t() const { return key; }
+
+        DXScanCode& operator=(uint32_t a_newKey) {
+            key = a_newKey;
+            return *this;
+        }
+    
+        bool operator==(const DXScanCode& a_other) const {
+            return key == a_other.key;
+        }
+        bool operator==(uint32_t a_otherKey) const {
+            return key == a_otherKey;
+        }
+    };
+    
+    enum class Action : uint8_t {
+        kNone,
+        kTogglePause,
+        kStopPlayback,
+        kToggleUserRotation,
+        kBuildReferenceScene,
+        kClearTimeline,
+        kStartPlayback,
+        kStartRecording,
+        kStopRecording,
+        kExportTimeline,
+        kImportTimeline,
+        kRegisterTimeline,
+        kUnregisterTimeline,
+        kCycleUp,
+        kCycleDown,
+        kToggleRotationGizmos,
+        kUndo,
+        kRedo,
+        kToggleDrag,
+        kScrub,
+        kRetimeConstantSpeed,
+        kTogglePreview,
+        kNextTake,
+        kPreviousTake,
+        kTotal
+    };
+
+    enum class Trigger : uint8_t {
+        kPress,   // fires once when the key goes down
+        kHold,    // fires once after the key was held for the action's time
+        kRepeat   // fires on press, then every action time while held
+    };
+
+    // Bitmask of modifier keys that must be held for a binding
+    enum Modifier : uint8_t {
+        kModifierNone = 0,
+        kModifierShift = 1 << 0,
+        kModifierCtrl = 1 << 1,
+        kModifierAlt = 1 << 2,
+        kModifierCombinations = 1 << 3
+    };
+
+    struct KeyBinding {
+        Action action;
+        uint32_t key;        // DX scan code, mouse buttons start at InputMap::kMacro_MouseButtonOffset
+        uint8_t modifiers;
+        Trigger trigger;
+        float time;          // hold time or repeat interval in seconds
+    };
+
+    // Default key layout, each entry can be overridden in the [Controls] section of the INI
+    inline constexpr std::array<KeyBinding, static_cast<size_t>(Action::kTotal) - 1> kDefaultKeyBindings = { {
+        { Action::kTogglePause, 2, kModifierNone, Trigger::kPress, 0.f },            // 1
+        { Action::kStopPlayback, 3, kModifierNone, Trigger::kPress, 0.f },           // 2
+        { Action::kToggleUserRotation, 4, kModifierNone, Trigger::kPress, 0.f },     // 3
+        { Action::kBuildReferenceScene, 5, kModifierNone, Trigger::kPress, 0.f },    // 4
+        { Action::kClearTimeline, 6, kModifierNone, Trigger::kPress, 0.f },          // 5
+        { Action::kStartPlayback, 7, kModifierNone, Trigger::kPress, 0.f },          // 6
+        { Action::kStartRecording, 8, kModifierNone, Trigger::kPress, 0.f },         // 7
+        { Action::kStopRecording, 9, kModifierNone, Trigger::kPress, 0.f },          // 8
+        { Action::kExportTimeline, 10, kModifierNone, Trigger::kPress, 0.f },        // 9
+        { Action::kImportTimeline, 11, kModifierNone, Trigger::kPress, 0.f },        // 0
+        { Action::kRegisterTimeline, 20, kModifierNone, Trigger::kPress, 0.f },      // T
+        { Action::kUnregisterTimeline, 21, kModifierNone, Trigger::kPress, 0.f },    // Y
+        { Action::kCycleUp, 22, kModifierNone, Trigger::kRepeat, 0.3f },             // U
+        { Action::kToggleRotationGizmos, 24, kModifierNone, Trigger::kPress, 0.f },  // O
+        { Action::kCycleDown, 35, kModifierNone, Trigger::kRepeat, 0.3f },           // H
+        { Action::kUndo, 44, kModifierCtrl, Trigger::kRepeat, 0.3f },                // Ctrl+Z
+        { Action::kRedo, 21, kModifierCtrl, Trigger::kRepeat, 0.3f },                // Ctrl+Y
+        { Action::kToggleDrag, 34, kModifierNone, Trigger::kPress, 0.f },            // G
+        { Action::kScrub, 47, kModifierNone, Trigger::kPress, 0.f },                 // V, hold and move the mouse
+        { Action::kRetimeConstantSpeed, 46, kModifierNone, Trigger::kPress, 0.f },   // C
+        { Action::kTogglePreview, 25, kModifierNone, Trigger::kPress, 0.f },         // P
+        { Action::kNextTake, 27, kModifierNone, Trigger::kRepeat, 0.3f },            // ]
+        { Action::kPreviousTake, 26, kModifierNone, Trigger::kRepeat, 0.3f }         // [
+    } };
+
+    // Names used for the INI keys, indexed by Action
+    inline constexpr std::array<std::string_view, static_cast<size_t>(Action::kTotal)> kActionNames = {
+        "None"sv, "TogglePause"sv, "StopPlayback"sv, "ToggleUserRotation"sv, "BuildReferenceScene"sv, "ClearTimeline"sv,
+        "StartPlayback"sv, "StartRecording"sv, "StopRecording"sv, "ExportTimeline"sv, "ImportTimeline"sv,
+        "RegisterTimeline"sv, "UnregisterTimeline"sv, "CycleUp"sv, "CycleDown"sv, "ToggleRotationGizmos"sv,
+        "Undo"sv, "Redo"sv, "ToggleDrag"sv, "Scrub"sv, "RetimeConstantSpeed"sv, "TogglePreview"sv,
+        "NextTake"sv, "PreviousTake"sv
+    };
+
+    // Turns the button events of an input event chain into actions, through a table indexed by scan code and held
+    // modifiers, and tracks hold and repeat triggers per key. Modifiers are read from every chain rather than carried
+    // over from earlier ones, since the game sends an event for each key that is down. Held keys only get their press
+    // and release once, so the owner resets them whenever a release may have been missed.
+    class InputDispatcher {
+    public:
+        struct Command {
+            Action action = Action::kNone;
+            bool isRelease = false;  // only for actions that last while their key is held
+        };
+
+        InputDispatcher() { BuildDispatchTable(kDefaultKeyBindings); }
+
+        template <size_t N>
+        void BuildDispatchTable(const std::array<KeyBinding, N>& a_bindings) {
+            for (auto& row : m_dispatchTable) {
+                row.fill(Action::kNone);
+            }
+            for (const auto& binding : a_bindings) {
+                Bind(binding);
+            }
+        }
+
+        // Calls a_onCommand for every action the chain fires or releases, in the order of its events
+        template <class Func>
+        void ProcessEvents(const RE::InputEvent* a_event, Func&& a_onCommand) {
+            m_modifiers = GetModifiers(a_event);
+            for (auto* event = a_event; event; event = event->next) {
+                if (event->GetEventType() != RE::INPUT_EVENT_TYPE::kButton) {
+                    continue;
+                }
+                Command command;
+                if (ProcessButton(static_cast<const RE::ButtonEvent*>(event), command)) {
+                    a_onCommand(command);
+                }
+            }
+        }
+
+        // Forgets every held key and modifier, and calls a_onRelease for each held action that lasts while its key is held
+        template <class Func>
+        void Reset(Func&& a_onRelease) {
+            for (auto& state : m_keyStates) {
+                if (LastsWhileHeld(state.action)) {
+                    a_onRelease(Command{ state.action, true });
+                }
+                state = {};
+            }
+            m_modifiers = kModifierNone;
+        }
+
+        uint8_t GetModifiers() const { return m_modifiers; }
+
+        static bool LastsWhileHeld(Action a_action) { return a_action == Action::kScrub; }
+
+    private:
+        struct ActionSettings {
+            Trigger trigger = Trigger::kPress;
+            float time = 0.f;
+        };
+
+        // Per key state for hold / repeat triggers
+        struct KeyState {
+            Action action = Action::kNone;
+            uint32_t fireCount = 0;
+        };
+
+        static DXScanCode GetScanCode(const RE::ButtonEvent* a_buttonEvent);
+        static uint8_t GetModifier(uint32_t a_key);
+        static uint8_t GetModifiers(const RE::InputEvent* a_event);
+        void Bind(const KeyBinding& a_binding);
+        // Returns true if a_buttonEvent fires or releases an action, written to a_command
+        bool ProcessButton(const RE::ButtonEvent* a_buttonEvent, Command& a_command);
+
+        std::array<std::array<Action, kModifierCombinations>, InputMap::kMaxMacros> m_dispatchTable;
+        std::array<ActionSettings, static_cast<size_t>(Action::kTotal)> m_actionSettings;
+        std::array<KeyState, InputMap::kMaxMacros> m_keyStates;
+        uint8_t m_modifiers = kModifierNone;
+    }; // class InputDispatcher
+} // namespace FCSE
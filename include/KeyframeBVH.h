@@ -0,0 +1,42 @@
+#pragma once
+
+namespace FCSE {
+    // Bounding volume hierarchy over the translation keyframes of a path, for picking keyframes under the crosshair.
+    // Moving a single keyframe only refits the bounds on its way to the root.
+    class KeyframeBVH {
+    public:
+        static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+        void Build(std::span<const RE::NiPoint3> a_points);
+        void Clear();
+        // Moves point a_index and updates the bounds of its leaf and ancestors
+        void Refit(uint32_t a_index, const RE::NiPoint3& a_position);
+
+        // Index of the point closest to the ray in angle, within a_maxAngle radians of it; kInvalidIndex if none
+        uint32_t PickRay(const RE::NiPoint3& a_origin, const RE::NiPoint3& a_direction, float a_maxAngle) const;
+        // Indices of all points within a_radius of a_center
+        void QueryRadius(const RE::NiPoint3& a_center, float a_radius, std::vector<uint32_t>& a_out) const;
+
+        bool IsEmpty() const { return m_nodes.empty(); }
+        const RE::NiPoint3& GetPoint(uint32_t a_index) const { return m_points[a_index]; }
+
+    private:
+        struct Node {
+            RE::NiPoint3 min;
+            RE::NiPoint3 max;
+            uint32_t parent = kInvalidIndex;
+            uint32_t first = 0;       // leaf: first entry in m_order, inner: left child (right child is first + 1)
+            uint32_t count = 0;       // number of points, 0 for inner nodes
+        };
+
+        static constexpr uint32_t kLeafSize = 4;
+
+        void BuildNode(uint32_t a_node, uint32_t a_parent, uint32_t a_begin, uint32_t a_end);
+        void UpdateLeafBounds(Node& a_node) const;
+
+        std::vector<RE::NiPoint3> m_points;
+        std::vector<Node> m_nodes;
+        std::vector<uint32_t> m_order;       // point indices, grouped by leaf
+        std::vector<uint32_t> m_leafOfPoint;  // point index -> leaf node
+    }; // class KeyframeBVH
+} // namespace FCSE
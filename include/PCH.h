@@ -6,6 +6,8 @@
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/msvc_sink.h>
 
+#include <numbers>
+
 using namespace SKSE;
 using namespace SKSE::log;
 using namespace SKSE::stl;
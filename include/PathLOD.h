@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ViewFrustum.h"
+
+namespace FCSE {
+    // Splits a keyframe path into runs with bounding spheres and precomputes a pyramid of coarser polylines per run.
+    // Runs outside the view frustum are skipped; visible runs are drawn at the coarsest level whose
+    // error stays below the screen-space tolerance, so the draw cost follows what is visible.
+    class PathLOD {
+    public:
+        void Build(std::span<const RE::NiPoint3> a_keyframes);
+        void Clear();
+        // Rebuilds only the runs whose curve depends on keyframe a_index after it was moved
+        void UpdateKeyframe(std::span<const RE::NiPoint3> a_keyframes, size_t a_index);
+
+        size_t GetRunCount() const { return m_runs.size(); }
+
+        // A visible run at the level of detail chosen for this frame
+        struct RunView {
+            size_t index = 0;
+            size_t first = 0;         // index of the run's first keyframe in the path
+            uint32_t level = 0;
+            uint32_t generation = 0;  // changes whenever the run's level 0 polyline is rebuilt
+            uint32_t revision = 0;    // changes whenever one of the run's keyframes moves
+            std::span<const RE::NiPoint3> polyline;
+            std::span<const RE::NiPoint3> keyframes;
+        };
+
+        // Calls a_func(const RunView&) for every run inside the view frustum
+        template <class Func>
+        void ForEachVisibleRun(std::span<const RE::NiPoint3> a_keyframes, const ViewFrustum& a_frustum, float a_tolerancePixels, Func&& a_func) {
+            for (size_t i = 0; i < m_runs.size(); ++i) {
+                RunView view;
+                if (GetVisibleRun(i, a_keyframes, a_frustum, a_tolerancePixels, view)) {
+                    a_func(view);
+                }
+            }
+        }
+
+    private:
+        // Level 0 is the tessellated curve, level 1 the keyframes, level k every 2^(k-1)-th keyframe
+        static constexpr uint32_t kMaxLevels = 8;
+        static constexpr size_t kRunLength = 32;
+        static constexpr float kMinDistance = 50.f;
+
+        struct Run {
+            size_t first = 0;  // keyframe indices, inclusive
+            size_t last = 0;
+            RE::NiPoint3 center;
+            float radius = 0.f;
+
+            uint32_t levelCount = 2;
+            std::array<float, kMaxLevels> levelError{};  // max world-space deviation from the curve
+            std::array<uint32_t, kMaxLevels> levelOffset{};
+            std::array<uint32_t, kMaxLevels> levelSize{};
+
+            std::vector<RE::NiPoint3> tessellation;
+            RE::NiPoint3 tessellationOrigin;
+            uint32_t tessellationGeneration = 0;
+            bool isTessellated = false;
+            uint32_t revision = 0;
+        };
+
+        // Bounds and coarse levels of a run; a_append adds its decimated points, otherwise they are overwritten in place
+        void BuildRun(Run& a_run, std::span<const RE::NiPoint3> a_keyframes, bool a_append);
+
+        // Returns false if the run is culled
+        bool GetVisibleRun(size_t a_runIndex, std::span<const RE::NiPoint3> a_keyframes, const ViewFrustum& a_frustum,
+                           float a_tolerancePixels, RunView& a_view);
+        void Tessellate(Run& a_run, std::span<const RE::NiPoint3> a_keyframes, const ViewFrustum& a_frustum, float a_tolerancePixels);
+
+        std::vector<Run> m_runs;
+        std::array<std::vector<RE::NiPoint3>, kMaxLevels> m_levelPoints;  // decimated points of levels >= 2
+    }; // class PathLOD
+} // namespace FCSE
@@ -0,0 +1,66 @@
+#pragma once
+
+namespace FCSE {
+    // Caches the references and skeleton nodes that ref-tracked keyframes point at, so repeated scene builds and
+    // per-frame previews do not look forms up or search skeletons by name again. References are held as handles and
+    // nodes together with the 3D root they were found in; entries of a reference are dropped when it is attached to
+    // or detached from a cell or its 3D is (re)loaded.
+    class ReferenceResolver : public RE::BSTEventSink<RE::TESCellAttachDetachEvent>,
+                              public RE::BSTEventSink<RE::TESObjectLoadedEvent> {
+    public:
+        static ReferenceResolver& GetSingleton() {
+            static ReferenceResolver instance;
+            return instance;
+        }
+        ReferenceResolver(const ReferenceResolver&) = delete;
+        ReferenceResolver& operator=(const ReferenceResolver&) = delete;
+
+        // Registers for the invalidation events, call once the game data is loaded
+        void Register();
+
+        RE::TESObjectREFR* GetReference(RE::FormID a_formID);
+        // Target node of the actor's body part, e.g. the head; falls back to the race's default part if it has none
+        RE::NiPointer<RE::NiAVObject> GetBodyPartNode(RE::FormID a_formID, RE::BGSBodyPartDefs::LIMB_ENUM a_part);
+        RE::NiPointer<RE::NiAVObject> GetBoneNode(RE::FormID a_formID, const RE::BSFixedString& a_name);
+
+        void Invalidate(RE::FormID a_formID);
+        void Clear();
+
+        RE::BSEventNotifyControl ProcessEvent(const RE::TESCellAttachDetachEvent* a_event, RE::BSTEventSource<RE::TESCellAttachDetachEvent>*) override;
+        RE::BSEventNotifyControl ProcessEvent(const RE::TESObjectLoadedEvent* a_event, RE::BSTEventSource<RE::TESObjectLoadedEvent>*) override;
+
+    private:
+        ReferenceResolver() = default;
+        ~ReferenceResolver() = default;
+
+        // Body parts and bone names share one table; bone names are interned, so their address identifies them
+        struct NodeKey {
+            RE::FormID formID = 0;
+            uint32_t part = kNoPart;
+            const char* name = nullptr;
+
+            bool operator==(const NodeKey&) const = default;
+        };
+        struct NodeKeyHash {
+            size_t operator()(const NodeKey& a_key) const {
+                size_t hash = std::hash<uint64_t>{}((static_cast<uint64_t>(a_key.formID) << 32) | a_key.part);
+                return hash ^ (std::hash<const void*>{}(a_key.name) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2));
+            }
+        };
+        struct NodeEntry {
+            RE::NiPointer<RE::NiAVObject> node;
+            const RE::NiAVObject* root = nullptr;  // the reference's 3D at lookup time; a different root means a reload
+        };
+
+        static constexpr uint32_t kNoPart = std::numeric_limits<uint32_t>::max();
+
+        RE::NiPointer<RE::NiAVObject> GetNode(const NodeKey& a_key, const RE::BSFixedString* a_name);
+        static RE::NiAVObject* FindNode(RE::TESObjectREFR* a_reference, RE::NiAVObject* a_root, const NodeKey& a_key, const RE::BSFixedString* a_name);
+
+        std::mutex m_mutex;  // events may arrive from loading threads
+        std::unordered_map<RE::FormID, RE::ObjectRefHandle> m_references;
+        std::unordered_map<NodeKey, NodeEntry, NodeKeyHash> m_nodes;
+        std::unordered_multimap<RE::FormID, NodeKey> m_nodeKeys;  // per reference, for invalidation
+        bool m_isRegistered = false;
+    }; // class ReferenceResolver
+} // namespace FCSE
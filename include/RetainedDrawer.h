@@ -0,0 +1,60 @@
+#pragma once
+
+namespace FCSE {
+    // Retained-mode layer on top of the TrueHUD debug draw API.
+    // Primitive groups are submitted once with a lifetime and only renewed shortly before they expire
+    // or when their version changes, instead of being resubmitted every frame.
+    // A group whose version changed since the last frame is drawn for that frame only, and retained once its version
+    // stayed the same for a frame; a group edited every frame, such as a dragged curve, leaves no copies behind.
+    //
+    // Retained geometry can only be added: TrueHUD has no call to remove a submission. A group that changes, is
+    // cleared or is forgotten keeps its last retained copy on screen until its lifetime runs out, up to kLifetime after
+    // the change. Geometry that moves every frame, such as the scrub ghost, the pick highlight and the parts of the
+    // path a drag moves, is therefore drawn with kImmediate instead of through this class.
+    class RetainedDrawer {
+    public:
+        static constexpr float kLifetime = 0.5f;     // seconds a submission stays on screen
+        static constexpr float kRenewMargin = 0.1f;  // renew this long before expiry to avoid flicker
+        static constexpr float kImmediate = 0.f;     // TrueHUD duration of geometry drawn for one frame
+
+        // Advances the clock used for expiry, call once per frame before Submit()
+        void BeginFrame();
+
+        // Returns true if the group a_key must be (re)submitted this frame
+        bool NeedsSubmit(uint64_t a_key, uint64_t a_version) const;
+        // Duration to submit the group a_key with this frame: kImmediate while its version is new, else kLifetime
+        float GetLifetime(uint64_t a_key, uint64_t a_version) const;
+
+        // Calls a_draw(lifetime) if the group a_key is new, changed or about to expire
+        template <class Func>
+        bool Submit(uint64_t a_key, uint64_t a_version, Func&& a_draw) {
+            if (!NeedsSubmit(a_key, a_version)) {
+                return false;
+            }
+            const float lifetime = GetLifetime(a_key, a_version);
+            a_draw(lifetime);
+            MarkSubmitted(a_key, a_version, lifetime);
+            return true;
+        }
+
+        // Records that the group a_key was drawn with a_lifetime, for callers that defer the actual draw
+        void MarkSubmitted(uint64_t a_key, uint64_t a_version, float a_lifetime) {
+            m_entries[a_key] = Entry{ a_version, m_now + a_lifetime };
+        }
+
+        // Forgets all groups; their geometry stays on screen until it expires, within kLifetime
+        void Clear();
+
+        // Drops bookkeeping for groups that have already expired
+        void Prune();
+
+    private:
+        struct Entry {
+            uint64_t version = 0;
+            double expiry = 0.0;
+        };
+
+        double m_now = 0.0;
+        std::unordered_map<uint64_t, Entry> m_entries;
+    }; // class RetainedDrawer
+} // namespace FCSE
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "TimelineScrubber.h"
+#include "ViewFrustum.h"
+
+namespace FCSE {
+    // View-direction gizmos for the rotation keyframes of a timeline.
+    // The instance list is read from FCFW once and only rebuilt when the rotation count or the path changes.
+    class RotationGizmos {
+    public:
+        struct Instance {
+            RE::NiPoint3 position;
+            RE::NiPoint3 direction;
+        };
+
+        bool IsCurrent(int a_rotationCount, uint32_t a_pathVersion) const {
+            return m_isValid && m_rotationCount == a_rotationCount && m_pathVersion == a_pathVersion;
+        }
+
+        // Places the gizmos on a_scrubber's path at a_rotationTimes, one per rotation keyframe. Without those times they
+        // are spread over a_translationPoints by their index.
+        void Rebuild(size_t a_timelineID, int a_rotationCount, std::span<const RE::NiPoint3> a_translationPoints, const TimelineScrubber& a_scrubber,
+                     std::span<const float> a_rotationTimes, uint32_t a_pathVersion);
+        void Invalidate() { m_isValid = false; }
+
+        // Collects the indices of the up to a_maxCount instances inside the frustum nearest to the camera, in no
+        // particular order
+        void GetVisible(const ViewFrustum& a_frustum, size_t a_maxCount, std::vector<uint32_t>& a_out) const;
+
+        const Instance& GetInstance(uint32_t a_index) const { return m_instances[a_index]; }
+        uint32_t GetVersion() const { return m_version; }
+
+        static constexpr float kArrowLength = 60.f;
+
+    private:
+        std::vector<Instance> m_instances;
+        int m_rotationCount = 0;
+        uint32_t m_pathVersion = 0;
+        uint32_t m_version = 0;
+        bool m_isValid = false;
+    }; // class RotationGizmos
+} // namespace FCSE
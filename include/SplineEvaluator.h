@@ -0,0 +1,320 @@
+#pragma once
+
+#include "HermiteKernel.h"
+
+namespace FCSE {
+    // Mirrors FCFW's a_interpolationMode values
+    enum class InterpolationMode : int {
+        kNone = 0,
+        kLinear = 1,
+        kCubicHermite = 2
+    };
+
+    // Remaps the local segment parameter like FCFW does during playback.
+    // Easing only changes the timing along a segment, not the shape of the path.
+    inline float ApplyEasing(float a_t, bool a_easeIn, bool a_easeOut) {
+        if (a_easeIn && a_easeOut) {
+            return a_t * a_t * (3.f - 2.f * a_t);
+        }
+        if (a_easeIn) {
+            return a_t * a_t;
+        }
+        if (a_easeOut) {
+            return a_t * (2.f - a_t);
+        }
+        return a_t;
+    }
+
+    // Evaluates the segment p1->p2. p0 and p3 are the neighbouring keyframes (equal to p1 / p2 at the path ends).
+    template <InterpolationMode Mode>
+    struct SegmentEvaluator;
+
+    template <>
+    struct SegmentEvaluator<InterpolationMode::kNone> {
+        static constexpr bool kIsStraight = true;
+
+        static RE::NiPoint3 Evaluate(const RE::NiPoint3&, const RE::NiPoint3& a_p1, const RE::NiPoint3& a_p2, const RE::NiPoint3&, float a_t) {
+            return a_t < 1.f ? a_p1 : a_p2;
+        }
+
+        static RE::NiPoint3 Derivative(const RE::NiPoint3&, const RE::NiPoint3&, const RE::NiPoint3&, const RE::NiPoint3&, float) {
+            return RE::NiPoint3();
+        }
+    };
+
+    template <>
+    struct SegmentEvaluator<InterpolationMode::kLinear> {
+        static constexpr bool kIsStraight = true;
+
+        static RE::NiPoint3 Evaluate(const RE::NiPoint3&, const RE::NiPoint3& a_p1, const RE::NiPoint3& a_p2, const RE::NiPoint3&, float a_t) {
+            return a_p1 + (a_p2 - a_p1) * a_t;
+        }
+
+        static RE::NiPoint3 Derivative(const RE::NiPoint3&, const RE::NiPoint3& a_p1, const RE::NiPoint3& a_p2, const RE::NiPoint3&, float) {
+            return a_p2 - a_p1;
+        }
+    };
+
+    // Catmull-Rom style tangents, as used by FCFW's CubicHermite mode
+    template <>
+    struct SegmentEvaluator<InterpolationMode::kCubicHermite> {
+        static constexpr bool kIsStraight = false;
+
+        static RE::NiPoint3 Evaluate(const RE::NiPoint3& a_p0, const RE::NiPoint3& a_p1, const RE::NiPoint3& a_p2, const RE::NiPoint3& a_p3, float a_t) {
+            const float t2 = a_t * a_t;
+            const float t3 = t2 * a_t;
+            const float h00 = 2.f * t3 - 3.f * t2 + 1.f;
+            const float h10 = t3 - 2.f * t2 + a_t;
+            const float h01 = -2.f * t3 + 3.f * t2;
+            const float h11 = t3 - t2;
+            const RE::NiPoint3 m1 = (a_p2 - a_p0) * 0.5f;
+            const RE::NiPoint3 m2 = (a_p3 - a_p1) * 0.5f;
+            return a_p1 * h00 + m1 * h10 + a_p2 * h01 + m2 * h11;
+        }
+
+        static RE::NiPoint3 Derivative(const RE::NiPoint3& a_p0, const RE::NiPoint3& a_p1, const RE::NiPoint3& a_p2, const RE::NiPoint3& a_p3, float a_t) {
+            const float t2 = a_t * a_t;
+            const float d00 = 6.f * t2 - 6.f * a_t;
+            const float d10 = 3.f * t2 - 4.f * a_t + 1.f;
+            const float d01 = -6.f * t2 + 6.f * a_t;
+            const float d11 = 3.f * t2 - 2.f * a_t;
+            const RE::NiPoint3 m1 = (a_p2 - a_p0) * 0.5f;
+            const RE::NiPoint3 m2 = (a_p3 - a_p1) * 0.5f;
+            return a_p1 * d00 + m1 * d10 + a_p2 * d01 + m2 * d11;
+        }
+    };
+
+    struct TessellationParams {
+        RE::NiPoint3 cameraPosition;
+        float pixelsPerRadian = 1000.f;  // screen pixels covered by one radian of view angle
+        float tolerancePixels = 2.f;     // maximum screen-space deviation of a line from the curve
+        float minDistance = 50.f;        // clamps the camera distance so nearby curves do not explode
+        uint32_t maxDepth = 8;           // at most 2^maxDepth lines per segment
+    };
+
+    namespace detail {
+        inline float DistanceToLine(const RE::NiPoint3& a_point, const RE::NiPoint3& a_start, const RE::NiPoint3& a_end) {
+            const RE::NiPoint3 dir = a_end - a_start;
+            const float lengthSq = dir.SqrLength();
+            if (lengthSq < 1e-6f) {
+                return a_point.GetDistance(a_start);
+            }
+            const float t = std::clamp((a_point - a_start).Dot(dir) / lengthSq, 0.f, 1.f);
+            return a_point.GetDistance(a_start + dir * t);
+        }
+
+        inline float AllowedError(const TessellationParams& a_params, const RE::NiPoint3& a_a, const RE::NiPoint3& a_b) {
+            const float distance = std::min(a_a.GetDistance(a_params.cameraPosition), a_b.GetDistance(a_params.cameraPosition));
+            return a_params.tolerancePixels * std::max(distance, a_params.minDistance) / a_params.pixelsPerRadian;
+        }
+
+        inline std::array<float, 3> ToArray(const RE::NiPoint3& a_point) {
+            return { a_point.x, a_point.y, a_point.z };
+        }
+
+        // Splits a curve breadth-first until the Bezier hull of every piece lies within the screen-space tolerance.
+        // Split points lie on a grid of 2^maxDepth + 1 parameters, so pieces are pairs of grid indices. Each pass tests
+        // all open pieces of one depth in a batch and evaluates the midpoints of those that are too coarse in another;
+        // tangents are evaluated once per grid point and shared by the pieces on both sides of it. The end points of
+        // finished pieces are marked on the grid and appended in order at the end.
+        // a_start / a_end are the keyframes the curve joins. They are stored as the grid ends instead of evaluating the
+        // power basis there, which is not bit-exact, so the last point appended is exactly a_end.
+        inline void Subdivide(const CubicSegment& a_curve, const RE::NiPoint3& a_start, const RE::NiPoint3& a_end,
+                              const TessellationParams& a_params, std::vector<RE::NiPoint3>& a_out) {
+            struct Scratch {
+                std::array<std::vector<float>, 3> position;  // per grid index
+                std::array<std::vector<float>, 3> tangent;
+                std::vector<uint64_t> isEnd;
+                std::vector<uint32_t> open;
+                std::vector<uint32_t> next;
+                std::array<std::vector<float>, 3> start;  // per open piece
+                std::array<std::vector<float>, 3> end;
+                std::array<std::vector<float>, 3> startTangent;
+                std::array<std::vector<float>, 3> endTangent;
+                std::vector<uint8_t> split;
+                std::vector<uint32_t> mids;  // per split piece
+                std::vector<float> u;
+                std::array<std::vector<float>, 3> midPosition;
+                std::array<std::vector<float>, 3> midTangent;
+            };
+            thread_local Scratch scratch;
+
+            const uint32_t maxDepth = std::min(a_params.maxDepth, 16u);
+            const uint32_t gridSize = 1u << maxDepth;
+            const size_t pieceCapacity = std::max(gridSize / 2, 1u);
+            if (scratch.position[0].size() != gridSize + 1) {
+                for (size_t axis = 0; axis < 3; ++axis) {
+                    for (auto* values : { &scratch.position[axis], &scratch.tangent[axis] }) {
+                        values->resize(gridSize + 1);
+                    }
+                    for (auto* values : { &scratch.start[axis], &scratch.end[axis], &scratch.startTangent[axis], &scratch.endTangent[axis],
+                                          &scratch.midPosition[axis], &scratch.midTangent[axis] }) {
+                        values->resize(pieceCapacity);
+                    }
+                }
+                scratch.split.resize(pieceCapacity);
+                scratch.u.resize(pieceCapacity);
+            }
+            scratch.isEnd.assign(gridSize / 64 + 1, 0);
+
+            const CubicSegment derivative = a_curve.Derivative();
+            const auto start = ToArray(a_start);
+            const auto end = ToArray(a_end);
+            for (size_t axis = 0; axis < 3; ++axis) {
+                const auto& d = derivative.c[axis];
+                scratch.position[axis][0] = start[axis];
+                scratch.position[axis][gridSize] = end[axis];
+                scratch.tangent[axis][0] = d[0];
+                scratch.tangent[axis][gridSize] = (d[0] + d[1]) + d[2];
+            }
+
+            HullTolerance tolerance;
+            tolerance.camera = ToArray(a_params.cameraPosition);
+            const float errorScale = a_params.tolerancePixels / a_params.pixelsPerRadian;
+            tolerance.errorScaleSq = errorScale * errorScale;
+            tolerance.minDistanceSq = a_params.minDistance * a_params.minDistance;
+
+            const auto markEnd = [](uint32_t a_index) { scratch.isEnd[a_index / 64] |= uint64_t(1) << (a_index % 64); };
+            const float inverseGridSize = 1.f / static_cast<float>(gridSize);
+
+            scratch.open.assign(1, 0);
+            uint32_t width = gridSize;
+            for (uint32_t depth = 0; !scratch.open.empty(); ++depth, width /= 2) {
+                const size_t count = scratch.open.size();
+                if (depth >= maxDepth) {
+                    for (const uint32_t first : scratch.open) {
+                        markEnd(first + width);
+                    }
+                    break;
+                }
+
+                HullArrays hulls;
+                for (size_t axis = 0; axis < 3; ++axis) {
+                    for (size_t i = 0; i < count; ++i) {
+                        const uint32_t first = scratch.open[i];
+                        scratch.start[axis][i] = scratch.position[axis][first];
+                        scratch.end[axis][i] = scratch.position[axis][first + width];
+                        scratch.startTangent[axis][i] = scratch.tangent[axis][first];
+                        scratch.endTangent[axis][i] = scratch.tangent[axis][first + width];
+                    }
+                    hulls.start[axis] = scratch.start[axis].data();
+                    hulls.end[axis] = scratch.end[axis].data();
+                    hulls.startTangent[axis] = scratch.startTangent[axis].data();
+                    hulls.endTangent[axis] = scratch.endTangent[axis].data();
+                }
+                hulls.span = static_cast<float>(width) * inverseGridSize / 3.f;
+                TestHulls(hulls, tolerance, count, scratch.split.data());
+
+                scratch.next.clear();
+                scratch.mids.clear();
+                for (size_t i = 0; i < count; ++i) {
+                    const uint32_t first = scratch.open[i];
+                    if (!scratch.split[i]) {
+                        markEnd(first + width);
+                        continue;
+                    }
+                    const uint32_t mid = first + width / 2;
+                    scratch.u[scratch.mids.size()] = static_cast<float>(mid) * inverseGridSize;
+                    scratch.mids.push_back(mid);
+                    scratch.next.push_back(first);
+                    scratch.next.push_back(mid);
+                }
+
+                const size_t midCount = scratch.mids.size();
+                if (midCount > 0) {
+                    const std::span<const float> u(scratch.u.data(), midCount);
+                    EvaluateCubic(a_curve, u, { scratch.midPosition[0].data(), scratch.midPosition[1].data(), scratch.midPosition[2].data() });
+                    EvaluateCubic(derivative, u, { scratch.midTangent[0].data(), scratch.midTangent[1].data(), scratch.midTangent[2].data() });
+                    for (size_t axis = 0; axis < 3; ++axis) {
+                        for (size_t k = 0; k < midCount; ++k) {
+                            scratch.position[axis][scratch.mids[k]] = scratch.midPosition[axis][k];
+                            scratch.tangent[axis][scratch.mids[k]] = scratch.midTangent[axis][k];
+                        }
+                    }
+                }
+                std::swap(scratch.open, scratch.next);
+            }
+
+            for (size_t word = 0; word < scratch.isEnd.size(); ++word) {
+                for (uint64_t bits = scratch.isEnd[word]; bits != 0; bits &= bits - 1) {
+                    const size_t index = word * 64 + static_cast<size_t>(std::countr_zero(bits));
+                    a_out.emplace_back(scratch.position[0][index], scratch.position[1][index], scratch.position[2][index]);
+                }
+            }
+        }
+    }
+
+    // Appends the points of segment p1->p2 to a_out, excluding p1 itself.
+    // Straight segments always produce a single line.
+    template <InterpolationMode Mode>
+    void TessellateSegment(const RE::NiPoint3& a_p0, const RE::NiPoint3& a_p1, const RE::NiPoint3& a_p2, const RE::NiPoint3& a_p3,
+                           const TessellationParams& a_params, std::vector<RE::NiPoint3>& a_out) {
+        if constexpr (SegmentEvaluator<Mode>::kIsStraight) {
+            a_out.push_back(a_p2);
+        } else {
+            const CubicSegment curve = CubicSegment::FromHermite(detail::ToArray(a_p0), detail::ToArray(a_p1), detail::ToArray(a_p2), detail::ToArray(a_p3));
+            detail::Subdivide(curve, a_p1, a_p2, a_params, a_out);
+        }
+    }
+
+    // Tessellates a whole keyframe path. a_modes holds the interpolation mode per keyframe, which (as in FCFW)
+    // applies to the segment leading into that keyframe. If a_modes is empty, CubicHermite is assumed.
+    inline void TessellatePath(std::span<const RE::NiPoint3> a_points, std::span<const InterpolationMode> a_modes,
+                               const TessellationParams& a_params, std::vector<RE::NiPoint3>& a_out) {
+        a_out.clear();
+        if (a_points.empty()) {
+            return;
+        }
+
+        a_out.push_back(a_points.front());
+        const size_t count = a_points.size();
+        for (size_t i = 0; i + 1 < count; ++i) {
+            const RE::NiPoint3& p0 = a_points[i > 0 ? i - 1 : i];
+            const RE::NiPoint3& p1 = a_points[i];
+            const RE::NiPoint3& p2 = a_points[i + 1];
+            const RE::NiPoint3& p3 = a_points[i + 2 < count ? i + 2 : i + 1];
+
+            const InterpolationMode mode = i + 1 < a_modes.size() ? a_modes[i + 1] : InterpolationMode::kCubicHermite;
+            switch (mode) {
+            case InterpolationMode::kNone:
+                TessellateSegment<InterpolationMode::kNone>(p0, p1, p2, p3, a_params, a_out);
+                break;
+            case InterpolationMode::kLinear:
+                TessellateSegment<InterpolationMode::kLinear>(p0, p1, p2, p3, a_params, a_out);
+                break;
+            default:
+                TessellateSegment<InterpolationMode::kCubicHermite>(p0, p1, p2, p3, a_params, a_out);
+                break;
+            }
+        }
+    }
+
+    // Evaluates the path at segment a_segment (p[a_segment] -> p[a_segment + 1]) and local parameter a_t,
+    // including the ease flags of the segment's end keyframe
+    inline RE::NiPoint3 EvaluatePath(std::span<const RE::NiPoint3> a_points, std::span<const InterpolationMode> a_modes,
+                                     size_t a_segment, float a_t, bool a_easeIn, bool a_easeOut) {
+        const size_t count = a_points.size();
+        if (count == 0) {
+            return RE::NiPoint3();
+        }
+        if (a_segment + 1 >= count) {
+            return a_points.back();
+        }
+
+        const RE::NiPoint3& p0 = a_points[a_segment > 0 ? a_segment - 1 : a_segment];
+        const RE::NiPoint3& p1 = a_points[a_segment];
+        const RE::NiPoint3& p2 = a_points[a_segment + 1];
+        const RE::NiPoint3& p3 = a_points[a_segment + 2 < count ? a_segment + 2 : a_segment + 1];
+        const float t = ApplyEasing(std::clamp(a_t, 0.f, 1.f), a_easeIn, a_easeOut);
+
+        const InterpolationMode mode = a_segment + 1 < a_modes.size() ? a_modes[a_segment + 1] : InterpolationMode::kCubicHermite;
+        switch (mode) {
+        case InterpolationMode::kNone:
+            return SegmentEvaluator<InterpolationMode::kNone>::Evaluate(p0, p1, p2, p3, t);
+        case InterpolationMode::kLinear:
+            return SegmentEvaluator<InterpolationMode::kLinear>::Evaluate(p0, p1, p2, p3, t);
+        default:
+            return SegmentEvaluator<InterpolationMode::kCubicHermite>::Evaluate(p0, p1, p2, p3, t);
+        }
+    }
+} // namespace FCSE
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "TimelineFile.h"
+
+#include <thread>
+
+namespace FCSE {
+    // What the take library knows about one timeline file without reading it again
+    struct TakeSummary {
+        std::string path;        // relative to the Data folder, like the paths passed to FCFW
+        uint64_t fileSize = 0;
+        int64_t writeTime = 0;   // file clock ticks, only compared for equality
+        uint32_t translationCount = 0;
+        uint32_t rotationCount = 0;
+        float duration = 0.f;    // time of the last keyframe
+        // Over the keyframes with a world position, keyframes bound to the camera or a reference are left out
+        RE::NiPoint3 boundsMin;
+        RE::NiPoint3 boundsMax;
+        RE::NiPoint3 startPosition;
+        RE::NiPoint3 endPosition;
+        std::array<float, 2> startRotation{};  // pitch, yaw of the first and last rotation keyframe
+        std::array<float, 2> endRotation{};
+        std::vector<RE::NiPoint3> polyline;    // world positions evenly picked by index, at most kPolylinePoints
+        std::vector<float> polylineTimes;      // time of each polyline point
+
+        static constexpr size_t kPolylinePoints = 64;
+
+        std::string_view GetName() const;
+        // The polyline as a preview, for drawing a take without reading its file
+        TimelinePreview GetPreview() const;
+    };
+
+    // Index of the timeline files under a folder with a summary of each, so takes can be browsed and previewed without
+    // importing them one by one. Summaries are stored in an index file in that folder; a scan only reads the files
+    // whose size or write time differs from their entry. Scans run on a background thread and publish a new list
+    // when done, which readers load without locking.
+    class TakeLibrary {
+    public:
+        static TakeLibrary& GetSingleton() {
+            static TakeLibrary instance;
+            return instance;
+        }
+        TakeLibrary(const TakeLibrary&) = delete;
+        TakeLibrary& operator=(const TakeLibrary&) = delete;
+
+        using Entries = std::vector<TakeSummary>;
+
+        // Reads the folder from the [TakeLibrary] section of the plugin INI
+        void LoadSettings(const char* a_iniPath);
+
+        // Starts a scan on a background thread unless one is running
+        void StartScan();
+        bool IsScanning() const { return m_isScanning.load(std::memory_order_acquire); }
+        // Takes found by the last scan, sorted by path; never null
+        std::shared_ptr<const Entries> GetEntries() const { return m_entries.load(std::memory_order_acquire); }
+
+        // Selects the take a_step entries away from the selected one, wrapping around and skipping takes without
+        // keyframes; null if there are no takes. Main thread only.
+        std::shared_ptr<const TakeSummary> Select(int a_step);
+        std::shared_ptr<const TakeSummary> GetSelected() const;
+
+    private:
+        TakeLibrary() = default;
+        ~TakeLibrary() = default;
+
+        struct IndexHeader {
+            std::array<char, 4> magic = kIndexMagic;
+            uint16_t version = kIndexVersion;
+            uint16_t reserved = 0;
+            uint32_t entryCount = 0;
+            uint32_t checksum = 0;  // CRC-32 of all bytes after the header
+        };
+
+        static constexpr std::array<char, 4> kIndexMagic = { 'F', 'C', 'T', 'L' };
+        static constexpr uint16_t kIndexVersion = 2;
+        static constexpr std::string_view kIndexFileName = "FCSE_TakeLibrary.idx";
+
+        static Entries Scan(const std::string& a_folder, const Entries& a_known);
+        static bool Summarize(std::string_view a_path, TakeSummary& a_out);
+        static bool ReadIndex(std::string_view a_path, Entries& a_out);
+        static bool WriteIndex(std::string_view a_path, const Entries& a_entries);
+        std::string GetIndexPath() const;
+
+        std::string m_folder = "SKSE/Plugins";
+        std::atomic<std::shared_ptr<const Entries>> m_entries{ std::make_shared<const Entries>() };
+        std::atomic<bool> m_isScanning = false;
+        std::atomic<bool> m_isRescanRequested = false;
+        std::string m_selectedPath;  // main thread only
+    }; // class TakeLibrary
+} // namespace FCSE
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "TimelineFile.h"
+
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+namespace FCSE {
+    // Writes the binary copies of exported timelines (see TimelineFile) on a background thread. The YAML file is written
+    // by FCFW before a job is queued; the worker either encodes a model snapshot, for which the caller only pays the
+    // copy that shares its keyframe chunks with the model, or converts the YAML file FCFW wrote. The result is reported
+    // back on the main thread through the SKSE task interface. Jobs run one at a time in the order queued.
+    class TimelineExporter {
+    public:
+        static TimelineExporter& GetSingleton() {
+            static TimelineExporter instance;
+            return instance;
+        }
+        TimelineExporter(const TimelineExporter&) = delete;
+        TimelineExporter& operator=(const TimelineExporter&) = delete;
+
+        // Called on the main thread with whether the binary file was written
+        using Callback = std::function<void(bool)>;
+
+        // Queues a_snapshot to be written in the binary format to a_binaryPath
+        void Export(TimelineModel::Snapshot a_snapshot, std::string a_binaryPath, Callback a_onDone);
+        // Queues the YAML file at a_yamlPath to be converted to the binary format at a_binaryPath, for timelines with
+        // keyframes the model has not seen
+        void Convert(std::string a_yamlPath, std::string a_binaryPath, Callback a_onDone);
+
+        size_t GetPendingCount() const { return m_pendingCount.load(std::memory_order_relaxed); }
+
+    private:
+        TimelineExporter() = default;
+        ~TimelineExporter() = default;
+
+        struct Job {
+            TimelineModel::Snapshot snapshot;
+            std::string yamlPath;  // converted instead of the snapshot if not empty
+            std::string binaryPath;
+            Callback onDone;
+        };
+
+        void Queue(Job a_job);
+        void Run();
+        static bool Write(const Job& a_job);
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<Job> m_jobs;
+        std::atomic<size_t> m_pendingCount = 0;
+        bool m_isWorkerStarted = false;
+    }; // class TimelineExporter
+} // namespace FCSE
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "TimelineModel.h"
+
+namespace FCSE {
+    // Keyframes of one timeline file, in the form TimelineModel stores them
+    struct TimelineData {
+        std::vector<TranslationKeyframe> translations;
+        std::vector<RotationKeyframe> rotations;
+
+        static TimelineData FromSnapshot(const TimelineModel::Snapshot& a_snapshot);
+    };
+
+    // World positions of the translation keyframes of a timeline file, enough to draw its path without registering it
+    // with FCFW. Keyframes bound to the camera or a reference have no fixed position and are left out.
+    struct TimelinePreview {
+        std::vector<RE::NiPoint3> points;  // sorted by time
+        std::vector<float> times;
+        RE::NiPoint3 boundsMin;
+        RE::NiPoint3 boundsMax;
+        size_t skippedCount = 0;
+
+        // Keeps the capacity, so reading into the same preview again does not allocate
+        void Clear();
+    };
+
+    namespace detail {
+        // Four characters that read in order in a little-endian file
+        constexpr uint32_t MakeChunkID(const char (&a_name)[5]) {
+            return static_cast<uint32_t>(a_name[0]) | (static_cast<uint32_t>(a_name[1]) << 8) | (static_cast<uint32_t>(a_name[2]) << 16) |
+                   (static_cast<uint32_t>(a_name[3]) << 24);
+        }
+    }
+
+    // Reads timelines in FCFW's YAML export format, reads and writes them in FCSE's binary format, and converts YAML to
+    // binary. YAML files are only ever written by FCFW, whose writer knows its own layout and how it stores references.
+    // Paths are relative to the Data folder, like the paths passed to FCFW.
+    //
+    // Assumed YAML layout, as FCFW's export writes it; unknown keys are skipped when reading. Comments start at a '#'
+    // after whitespace outside quoted values, as in YAML:
+    //   translationPoints:
+    //     - time: 1.5
+    //       type: world                  # world | camera | reference
+    //       position: {x: 0.0, y: 0.0, z: 0.0}
+    //       reference: 0x000D8C58        # reference points only, offset in position
+    //       isOffsetRelative: true       # reference points only
+    //       easeIn: false
+    //       easeOut: false
+    //       interpolationMode: cubicHermite  # none | linear | cubicHermite
+    //   rotationPoints:
+    //     - time: 1.5
+    //       type: world
+    //       rotation: {pitch: 0.0, yaw: 0.0}
+    //       ...                          # same keys as above
+    //
+    // The binary format is little-endian and laid out for memory-mapping: a header, a table with the offset of every
+    // chunk and one chunk per keyframe field, each an array that MappedTimeline reads in place. Positions are stored as
+    // 32-bit integers in steps of 1/256 unit around an origin, and a CRC-32 over everything after the header detects
+    // truncated or damaged files.
+    class TimelineFile {
+    public:
+        // Fails if the file has no points, or points without the time or value keys of the layout above, so files in
+        // another layout can be passed on to FCFW's reader
+        static bool ReadYaml(std::string_view a_path, TimelineData& a_out);
+        static bool WriteBinary(std::string_view a_path, const TimelineData& a_data);
+        static bool ReadBinary(std::string_view a_path, TimelineData& a_out);
+        // Reads either format, chosen by the file extension
+        static bool Read(std::string_view a_path, TimelineData& a_out);
+        static bool IsBinaryPath(std::string_view a_path) { return a_path.ends_with(kBinaryExtension); }
+        // Reads only what TimelinePreview needs. YAML files are scanned in place through a memory mapping and the
+        // rotation section is skipped unparsed.
+        static bool ReadPreview(std::string_view a_path, TimelinePreview& a_out);
+
+        static bool ConvertYamlToBinary(std::string_view a_yamlPath, std::string_view a_binaryPath);
+
+        static std::filesystem::path GetFullPath(std::string_view a_path);
+        // Path of the binary copy kept next to a YAML file
+        static std::string GetBinaryPath(std::string_view a_yamlPath);
+        // Writes a temporary file next to a_path and renames it over a_path, so readers never see a partly written file
+        // and a failed write leaves the previous one intact
+        static bool ReplaceFile(std::string_view a_path, std::span<const std::byte> a_bytes);
+        // True if a_path exists and was written no earlier than a_source, or a_source does not exist
+        static bool IsUpToDate(std::string_view a_path, std::string_view a_source);
+
+        struct Header {
+            std::array<char, 4> magic = kMagic;
+            uint16_t version = kVersion;
+            uint16_t headerSize = sizeof(Header);
+            uint32_t chunkCount = 0;
+            uint32_t checksum = 0;  // CRC-32 of all bytes after the header
+            uint64_t fileSize = 0;
+        };
+
+        struct ChunkEntry {
+            uint32_t id = 0;
+            uint32_t count = 0;  // number of elements
+            uint64_t offset = 0;
+            uint64_t size = 0;   // in bytes
+        };
+
+        // Prefix of the position chunks
+        struct Quantization {
+            std::array<float, 3> origin{};
+            float step = kPositionStep;
+        };
+
+        enum ChunkID : uint32_t {
+            kTranslationTimes = detail::MakeChunkID("TTIM"),
+            kTranslationPositions = detail::MakeChunkID("TPOS"),  // Quantization, then int32 x, y, z per keyframe
+            kTranslationFlags = detail::MakeChunkID("TFLG"),      // uint8 KeyframeFlags
+            kTranslationModes = detail::MakeChunkID("TMOD"),      // uint8 InterpolationMode
+            kTranslationReferences = detail::MakeChunkID("TREF"),
+            kRotationTimes = detail::MakeChunkID("RTIM"),
+            kRotationValues = detail::MakeChunkID("RROT"),        // float pitch, yaw per keyframe
+            kRotationFlags = detail::MakeChunkID("RFLG"),
+            kRotationModes = detail::MakeChunkID("RMOD"),
+            kRotationReferences = detail::MakeChunkID("RREF")
+        };
+
+        static constexpr std::string_view kBinaryExtension = ".fcsb";
+        static constexpr std::array<char, 4> kMagic = { 'F', 'C', 'S', 'B' };
+        static constexpr uint16_t kVersion = 1;
+        static constexpr float kPositionStep = 1.f / 256.f;
+        static constexpr size_t kChunkAlignment = 16;
+
+        static uint32_t ComputeChecksum(std::span<const std::byte> a_bytes);
+    }; // class TimelineFile
+
+    // Read-only memory mapping of a whole file
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { Close(); }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const std::filesystem::path& a_path);
+        void Close();
+        bool IsOpen() const { return m_isOpen; }
+
+        // Empty for empty files, which cannot be mapped
+        std::span<const std::byte> GetBytes() const { return { m_data, m_size }; }
+        std::string_view GetText() const { return { reinterpret_cast<const char*>(m_data), m_size }; }
+
+    private:
+        const std::byte* m_data = nullptr;
+        size_t m_size = 0;
+        void* m_file = nullptr;     // platform handles of the mapping
+        void* m_mapping = nullptr;
+        bool m_isOpen = false;
+    }; // class MappedFile
+
+    // A binary timeline file mapped into memory. The accessors decode keyframes straight from the mapping.
+    class MappedTimeline {
+    public:
+        MappedTimeline() = default;
+        ~MappedTimeline() { Close(); }
+        MappedTimeline(const MappedTimeline&) = delete;
+        MappedTimeline& operator=(const MappedTimeline&) = delete;
+
+        // Fails if the file is missing, has an unknown version or layout, does not match its checksum or has keyframes
+        // out of time order
+        bool Open(std::string_view a_path, bool a_verifyChecksum = true);
+        void Close();
+        bool IsOpen() const { return m_file.IsOpen(); }
+
+        size_t GetTranslationCount() const { return m_translationTimes.size(); }
+        size_t GetRotationCount() const { return m_rotationTimes.size(); }
+        std::span<const float> GetTranslationTimes() const { return m_translationTimes; }
+        std::span<const float> GetRotationTimes() const { return m_rotationTimes; }
+
+        TranslationKeyframe GetTranslation(size_t a_index) const;
+        RotationKeyframe GetRotation(size_t a_index) const;
+        void ReadAll(TimelineData& a_out) const;
+
+    private:
+        template <class T>
+        bool GetChunk(uint32_t a_id, size_t a_prefixSize, size_t a_elementsPerKeyframe, std::span<const T>& a_out, const std::byte** a_prefix = nullptr) const;
+
+        MappedFile m_file;
+        const std::byte* m_data = nullptr;  // bytes of m_file
+        size_t m_size = 0;
+
+        std::span<const TimelineFile::ChunkEntry> m_chunks;
+        TimelineFile::Quantization m_quantization;
+        std::span<const float> m_translationTimes;
+        std::span<const int32_t> m_positions;
+        std::span<const uint8_t> m_translationFlags;
+        std::span<const uint8_t> m_translationModes;
+        std::span<const RE::FormID> m_translationReferences;
+        std::span<const float> m_rotationTimes;
+        std::span<const float> m_rotationValues;
+        std::span<const uint8_t> m_rotationFlags;
+        std::span<const uint8_t> m_rotationModes;
+        std::span<const RE::FormID> m_rotationReferences;
+    }; // class MappedTimeline
+} // namespace FCSE
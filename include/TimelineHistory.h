@@ -0,0 +1,34 @@
+#pragma once
+
+#include "TimelineModel.h"
+
+namespace FCSE {
+    // Undo / redo stack of committed TimelineModel states. The snapshots share their keyframe chunks with each
+    // other and with the model, so each entry only costs the chunks its edit actually changed.
+    class TimelineHistory {
+    public:
+        // Records a committed edit; a_before is only stored when the history is still empty
+        void Record(const TimelineModel::Snapshot& a_before, const TimelineModel::Snapshot& a_after);
+
+        // Return the state to restore, nullptr if there is nothing to undo / redo
+        const TimelineModel::Snapshot* Undo();
+        const TimelineModel::Snapshot* Redo();
+
+        void Clear();
+
+        size_t GetVersionCount() const { return m_versions.size(); }
+        // Bytes held by chunks referenced from the history, chunks shared between versions are counted once
+        size_t GetMemoryUsage() const { return m_chunkBytes + m_versions.capacity() * sizeof(TimelineModel::Snapshot); }
+
+    private:
+        void Push(const TimelineModel::Snapshot& a_snapshot);
+        void PopBack();
+        void AddChunk(const void* a_chunk, size_t a_bytes);
+        void ReleaseChunk(const void* a_chunk, size_t a_bytes);
+
+        std::vector<TimelineModel::Snapshot> m_versions;
+        size_t m_current = 0;  // index of the version matching the model
+        std::unordered_map<const void*, uint32_t> m_chunkRefs;  // versions referencing each chunk
+        size_t m_chunkBytes = 0;
+    }; // class TimelineHistory
+} // namespace FCSE
@@ -1,5 +1,16 @@
 #pragma once
 
+#include "ArcLengthTable.h"
+#include "AtomicSnapshot.h"
+#include "KeyframeBVH.h"
+#include "PathLOD.h"
+#include "RetainedDrawer.h"
+#include "RotationGizmos.h"
+#include "TimelineHistory.h"
+#include "TimelineFile.h"
+#include "TimelineRegistry.h"
+#include "TimelineScrubber.h"
+
 namespace FCSE {
     class TimelineManager {
         public:
@@ -12,19 +23,251 @@ namespace FCSE {
 
             void Initialize();
             void Update();
-            size_t GetTimelineID();
+            size_t GetTimelineID() const;
             
             size_t RegisterTimeline();
             bool UnregisterTimeline();
             size_t CycleUp();
             size_t CycleDown();
 
+            // Marks the cached path of a_timelineID stale so it is re-read from FCFW on the next draw.
+            // Safe to call from any thread.
+            void InvalidateCache(size_t a_timelineID);
+            // Tracks playback state of owned timelines from FCFW's playback events. Safe to call from any thread, the
+            // event is applied on the main thread.
+            void OnFCFWMessage(SKSE::MessagingInterface::Message* a_msg);
+            // Records the free camera every frame with the CameraRecorder, which keeps only the keyframes needed to follow
+            // it. When stopped the keyframes replace those of the timeline as one undo step, like an FCFW recording
+            // started without append. Recording stops by itself when the camera leaves free camera mode.
+            bool StartRecording(size_t a_timelineID);
+            bool StopRecording();
+            bool IsRecording(size_t a_timelineID) const { return m_recording.isActive && m_recording.timelineID == a_timelineID; }
+
+            bool ToggleRotationGizmos();
+
+            // Timelines owned by FCSE with their cached metadata; main thread only
+            TimelineRegistry& GetRegistry() { return m_registry; }
+            const TimelineRegistry& GetRegistry() const { return m_registry; }
+
+            // Local keyframe model of an owned timeline; main thread only.
+            // Edits are sent to FCFW by CommitModel as one batch of the changed keyframes.
+            TimelineModel& GetModel(size_t a_timelineID) { return m_models[a_timelineID]; }
+            bool CommitModel(size_t a_timelineID);
+            // Empties the model after the FCFW timeline was cleared, the clear can be undone
+            void ResetModel(size_t a_timelineID);
+            // Writes the timeline as YAML through FCFW, then a binary copy (see TimelineFile) on a background thread: from
+            // a snapshot for timelines the model holds completely, else converted from FCFW's file. The result is shown
+            // as a notification once the copy is written.
+            bool ExportTimeline(size_t a_timelineID, std::string_view a_yamlPath, std::string_view a_binaryPath);
+            // Reads a timeline file (see TimelineFile) on a worker thread, then adds its keyframes to the model and FCFW
+            // one batch per frame. Until the last batch is committed the timeline is kImporting, which keeps FCSE from
+            // drawing, scrubbing or playing it; one import runs at a time. The batches reach FCFW as they are added, so
+            // playback started on the timeline by another plugin would see it half imported.
+            bool BeginImport(size_t a_timelineID, std::string_view a_path);
+            // Stops the running import and removes the keyframes it already added
+            bool CancelImport();
+            bool IsImporting(size_t a_timelineID) const { return m_import.isActive && m_import.timelineID == a_timelineID; }
+
+            // Draws the path and bounds of a timeline file without registering it with FCFW, to pick a take before
+            // importing it. The file is read on a worker thread; the preview stays until EndPreview.
+            bool BeginPreview(std::string_view a_path);
+            // Draws a preview that was read already, such as the polyline of a take library summary
+            void ShowPreview(std::string_view a_path, TimelinePreview a_preview);
+            void EndPreview();
+            // True while a file preview started by BeginPreview is shown
+            bool IsPreviewing() const { return m_preview.isActive && !m_preview.isSummary; }
+
+            // Restore the previous / next committed model state of the current timeline
+            bool Undo();
+            bool Redo();
+
+            // Grabs the keyframe under the crosshair, or releases the grabbed one. While grabbed the keyframe stays
+            // at its distance in front of the camera; FCFW is updated periodically and once more on release.
+            bool ToggleDrag();
+
+            // Previews the current timeline at a time moved by Scrub, without starting FCFW playback
+            bool BeginScrub();
+            void Scrub(float a_deltaSeconds);
+            void EndScrub();
+
+            // Rewrites the keyframe times of the current timeline so the camera travels at the same average speed on
+            // every segment, keeping the start time and duration
+            bool RetimeConstantSpeed();
+
         private:
+            // Editor state shared between the input, messaging and render paths. A published snapshot is never
+            // modified: writers copy it, change the copy and swap it in, readers hold on to whichever one they loaded.
+            struct EditorState {
+                size_t timelineID = 0;
+                int32_t selectedTranslationPoint = -1;
+                bool showRotationGizmos = false;
+                std::unordered_map<size_t, uint32_t> cacheVersions;  // bumped by InvalidateCache, by timeline ID
+
+                uint32_t GetCacheVersion(size_t a_timelineID) const {
+                    const auto it = cacheVersions.find(a_timelineID);
+                    return it != cacheVersions.end() ? it->second : 0;
+                }
+            };
+
+            // Translation points of a timeline as last read from FCFW
+            struct PathCache {
+                std::vector<RE::NiPoint3> translationPoints;
+                bool isValid = false;
+                uint32_t editVersion = 0;  // EditorState::cacheVersions entry the points were read at
+                uint32_t version = 0;  // incremented on every rebuild
+                PathLOD lod;
+                RotationGizmos gizmos;
+                KeyframeBVH bvh;  // over translationPoints, for picking
+                TimelineScrubber scrubber;  // built on the first scrub after each rebuild
+
+                // Timing of the translation keyframes from the model, empty when FCSE does not know it
+                std::vector<float> keyframeTimes;
+                std::vector<uint8_t> keyframeFlags;
+                std::vector<InterpolationMode> keyframeModes;
+
+                ArcLengthTable arcLength;
+                std::vector<uint32_t> segmentColors;  // speed heat-map, empty without keyframe times
+                float referenceSpeed = 0.f;           // speed drawn in the neutral colour
+                std::vector<RE::NiPoint3> distanceTicks;
+                uint32_t overlayRevision = 0;  // changes whenever segmentColors or distanceTicks change
+            };
+
+            static constexpr float kTessellationTolerancePixels = 1.5f;
+            static constexpr float kKeyframeMarkerSize = 6.f;
+            static constexpr uint32_t kPathColor = 0xFF0000FF;
+            static constexpr uint32_t kKeyframeColor = 0xFFFF00FF;
+            static constexpr uint32_t kGizmoColor = 0x00FFFFFF;
+            static constexpr uint32_t kHighlightColor = 0xFFFFFFFF;
+            static constexpr float kHighlightMarkerSize = 12.f;
+            static constexpr float kPickRadiusPixels = 12.f;
+            static constexpr size_t kMaxGizmosPerFrame = 64;
+            static constexpr uint64_t kGizmoKeyBase = 1ull << 62;  // keeps gizmo keys apart from path run keys
+            static constexpr uint64_t kHighlightKey = 0;
+            static constexpr auto kDragCommitInterval = std::chrono::milliseconds(100);
+            static constexpr uint64_t kScrubPreviewKey = 1;
+            static constexpr uint32_t kScrubPreviewColor = 0xFF8000FF;
+            static constexpr float kScrubPreviewLength = 60.f;
+            static constexpr float kScrubKeyframeSpacing = 1.f;  // seconds between keyframes whose times FCSE does not know
+            static constexpr float kTickSpacing = 256.f;  // distance between ticks, doubled until at most kMaxTicks fit
+            static constexpr size_t kMaxTicks = 512;
+            static constexpr size_t kTicksPerBatch = 32;
+            static constexpr float kTickMarkerSize = 3.f;
+            static constexpr uint32_t kTickColor = 0xFFFFFFFF;
+            static constexpr uint64_t kTickKeyBase = 1ull << 61;
+            static constexpr auto kImportFrameBudget = std::chrono::microseconds(2000);
+            static constexpr size_t kImportBatchSize = 64;  // keyframes added on the first frame, and at least on every frame
+            static constexpr auto kImportProgressInterval = std::chrono::seconds(1);
+            static constexpr uint32_t kPreviewColor = 0x80FF80FF;
+            static constexpr uint32_t kPreviewBoundsColor = 0x80FF8080;
+            static constexpr uint64_t kPreviewKeyBase = 1ull << 60;
+            static constexpr uint64_t kPreviewBoundsKey = kPreviewKeyBase - 1;
+
             TimelineManager() = default;
             ~TimelineManager() = default;
 
-            void DrawTimeline();
+            std::shared_ptr<const EditorState> GetState() const;
+            template <class Func>
+            void ModifyState(Func&& a_modify);
+
+            bool RestoreModel(size_t a_timelineID, const TimelineModel::Snapshot& a_snapshot);
+            void UpdateRecording();
+            void UpdateImport();
+            void FinishImport(bool a_succeeded);
+            void UpdatePreview();
+            void DrawFilePreview();
+            static void ShowTrueHUDMenu();
+            void DrawTimeline(const EditorState& a_state);
+            void UpdateDrag(const EditorState& a_state, PathCache& a_cache, const ViewFrustum& a_frustum);
+            void EndDrag();
+            void DrawPickHighlight(const PathCache& a_cache, const ViewFrustum& a_frustum);
+            // True if the model holds the times of all a_rotationCount rotation keyframes
+            bool HasRotationTimes(size_t a_timelineID, const PathCache& a_cache, int a_rotationCount);
+            void BuildScrubber(size_t a_timelineID, PathCache& a_cache, int a_rotationCount);
+            void ReadKeyframeTiming(size_t a_timelineID, PathCache& a_cache);
+            void BuildDistanceOverlay(PathCache& a_cache, bool a_updateReferenceSpeed);
+            void DrawDistanceTicks(const PathCache& a_cache, const ViewFrustum& a_frustum);
+            static uint32_t GetSpeedColor(float a_length, float a_duration, float a_referenceSpeed);
+            void DrawScrubPreview(const EditorState& a_state, PathCache& a_cache, int a_rotationCount);
+            void DrawRotationGizmos(const EditorState& a_state, PathCache& a_cache, int a_rotationCount, const ViewFrustum& a_frustum);
+            void SetCurrentTimeline(size_t a_timelineID);
+            PathCache& GetPathCache(const EditorState& a_state);
+
+            AtomicSnapshot<EditorState> m_state;
+
+            // Main thread only
+            TimelineRegistry m_registry;
+            std::unordered_map<size_t, TimelineModel> m_models;
+            std::unordered_map<size_t, TimelineHistory> m_histories;
+            size_t m_drawnTimelineID = 0;
+            std::unordered_map<size_t, PathCache> m_pathCaches;
+            RetainedDrawer m_pathDrawer;
+            std::vector<uint32_t> m_visibleGizmos;
+            uint32_t m_hoveredTranslationPoint = KeyframeBVH::kInvalidIndex;  // keyframe under the crosshair
+            ViewFrustum m_lastFrustum;
+
+            struct DragState {
+                bool isActive = false;
+                bool hasMoved = false;
+                size_t timelineID = 0;
+                uint32_t index = 0;
+                float distance = 0.f;
+                TimelineModel::Snapshot before;  // undo target for the whole drag
+                std::chrono::steady_clock::time_point nextCommit;
+            };
+            DragState m_drag;
+
+            struct ScrubState {
+                bool isActive = false;
+                size_t timelineID = 0;
+                float time = 0.f;
+            };
+            ScrubState m_scrub;
+
+            struct ImportState {
+                // Written by the worker thread until isDone is set, then only read by the main thread
+                struct Result {
+                    TimelineData data;
+                    bool succeeded = false;
+                    std::atomic<bool> isDone = false;
+                };
+
+                bool isActive = false;
+                size_t timelineID = 0;
+                std::string path;
+                std::shared_ptr<Result> result;
+                TimelineModel::Snapshot before;  // rollback and undo target
+                size_t nextTranslation = 0;
+                size_t nextRotation = 0;
+                size_t batchSize = kImportBatchSize;  // keyframes added this frame, adapted to kImportFrameBudget
+                uint32_t failed = 0;
+                std::chrono::steady_clock::time_point nextProgress;
+            };
+            ImportState m_import;
+
+            struct RecordingState {
+                bool isActive = false;
+                size_t timelineID = 0;
+                std::chrono::steady_clock::time_point lastSample;
+            };
+            RecordingState m_recording;
+
+            struct PreviewState {
+                // Written by the worker thread until isDone is set, then only read by the main thread
+                struct Result {
+                    TimelinePreview preview;
+                    bool succeeded = false;
+                    std::atomic<bool> isDone = false;
+                };
 
-            size_t m_currentTimelineID = 0;
+                bool isActive = false;
+                bool isLoaded = false;
+                bool isSummary = false;  // shown by ShowPreview
+                std::string path;
+                std::shared_ptr<Result> result;
+                PathLOD lod;
+                uint32_t version = 0;  // incremented for every loaded file, part of the draw versions
+            };
+            PreviewState m_preview;
+            RetainedDrawer m_previewDrawer;
     }; // class TimelineManager
 } // namespace FCSE
\ No newline at end of file
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "API/FCFW_API.h"
+#include "SplineEvaluator.h"
+
+namespace FCSE {
+    enum KeyframeFlags : uint8_t {
+        kKeyframeEaseIn = 1 << 0,
+        kKeyframeEaseOut = 1 << 1,
+        kKeyframeOffsetRelative = 1 << 2,  // reference offset is in the reference's local space
+        kKeyframeAtCamera = 1 << 3         // position / rotation is captured from the camera at playback start
+    };
+
+    // One keyframe of a track, used to pass keyframes in and out of the structure-of-arrays storage.
+    // For keyframes bound to a reference, value holds the offset from it.
+    template <size_t N>
+    struct Keyframe {
+        float time = 0.f;
+        std::array<float, N> value{};
+        uint8_t flags = 0;
+        InterpolationMode mode = InterpolationMode::kCubicHermite;
+        RE::FormID reference = 0;
+
+        bool operator==(const Keyframe&) const = default;
+    };
+
+    using TranslationKeyframe = Keyframe<3>;  // x, y, z
+    using RotationKeyframe = Keyframe<2>;     // pitch, yaw
+
+    // Keyframes of one track, sorted by time. The keyframes are split into fixed-capacity chunks that store one array
+    // per field. Chunks are shared between copies of a track and only cloned when a shared chunk is modified, so copying a
+    // track costs one pointer per chunk and an edit only duplicates the chunks it touches.
+    template <size_t N>
+    class KeyframeTrack {
+    public:
+        static constexpr size_t kChunkSize = 64;
+
+        struct Chunk {
+            uint32_t count = 0;
+            std::array<float, kChunkSize> times;
+            std::array<std::array<float, kChunkSize>, N> values;
+            std::array<uint8_t, kChunkSize> flags;
+            std::array<InterpolationMode, kChunkSize> modes;
+            std::array<RE::FormID, kChunkSize> references;
+
+            Keyframe<N> Get(size_t a_index) const;
+            void Set(size_t a_index, const Keyframe<N>& a_keyframe);
+        };
+
+        // Sequential read access; Get(size_t) has to walk the chunk list
+        class Cursor {
+        public:
+            explicit Cursor(const KeyframeTrack& a_track) : m_chunks(a_track.m_chunks) {}
+
+            bool AtEnd() const { return m_chunk >= m_chunks.size(); }
+            bool AtChunkStart() const { return m_offset == 0; }
+            const Chunk* GetChunk() const { return m_chunks[m_chunk].get(); }
+            size_t GetIndex() const { return m_index; }
+            float GetTime() const { return m_chunks[m_chunk]->times[m_offset]; }
+            Keyframe<N> Get() const { return m_chunks[m_chunk]->Get(m_offset); }
+
+            void Next() {
+                ++m_index;
+                if (++m_offset >= m_chunks[m_chunk]->count) {
+                    ++m_chunk;
+                    m_offset = 0;
+                }
+            }
+            void SkipChunk() {
+                m_index += m_chunks[m_chunk]->count - m_offset;
+                ++m_chunk;
+                m_offset = 0;
+            }
+
+        private:
+            const std::vector<std::shared_ptr<Chunk>>& m_chunks;
+            size_t m_chunk = 0;
+            size_t m_offset = 0;
+            size_t m_index = 0;
+        };
+
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        float GetLastTime() const { return m_chunks.back()->times[m_chunks.back()->count - 1]; }
+
+        Keyframe<N> Get(size_t a_index) const;
+        // Overwrites a keyframe in place, its time must keep the track sorted
+        void Set(size_t a_index, const Keyframe<N>& a_keyframe);
+        size_t Insert(const Keyframe<N>& a_keyframe);
+        void Append(const Keyframe<N>& a_keyframe);
+        void Erase(size_t a_index);
+        void Clear();
+        // Restores time order after bulk edits; keyframes with equal times keep their relative order
+        void SortByTime();
+
+        size_t GetChunkCount() const { return m_chunks.size(); }
+        const Chunk& GetChunk(size_t a_index) const { return *m_chunks[a_index]; }
+        // Write access for bulk loops, clones the chunk first if another track still shares it
+        Chunk& GetMutableChunk(size_t a_index);
+
+        template <class Func>
+        void ForEach(Func&& a_func) const {
+            for (const auto& chunk : m_chunks) {
+                for (uint32_t i = 0; i < chunk->count; ++i) {
+                    a_func(chunk->Get(i));
+                }
+            }
+        }
+
+        // Visits the chunk storage itself, used to measure memory shared between tracks
+        template <class Func>
+        void ForEachChunk(Func&& a_func) const {
+            for (const auto& chunk : m_chunks) {
+                a_func(static_cast<const Chunk*>(chunk.get()));
+            }
+        }
+
+    private:
+        // Chunk index and offset of a keyframe index
+        std::pair<size_t, size_t> Locate(size_t a_index) const;
+
+        std::vector<std::shared_ptr<Chunk>> m_chunks;
+        size_t m_size = 0;
+    };
+
+    // FCSE's own copy of a timeline it edits. Edits only touch the local arrays; Sync sends the difference to the
+    // last synced state to FCFW, so a batch of edits costs one Add / Remove call per keyframe that actually changed.
+    class TimelineModel {
+    public:
+        // Keyframes of the model at one point in time, shares its chunks with the model
+        struct Snapshot {
+            KeyframeTrack<3> translations;
+            KeyframeTrack<2> rotations;
+        };
+
+        struct SyncStats {
+            uint32_t removed = 0;
+            uint32_t added = 0;
+            uint32_t failed = 0;
+            bool rewritten = false;  // the timeline was cleared and rebuilt instead of patched
+        };
+
+        size_t AddTranslation(const TranslationKeyframe& a_keyframe);
+        size_t AddRotation(const RotationKeyframe& a_keyframe);
+        // Replaces a keyframe, returns its new index
+        size_t SetTranslation(size_t a_index, const TranslationKeyframe& a_keyframe);
+        bool RemoveTranslation(size_t a_index);
+        bool RemoveRotation(size_t a_index);
+        void Clear();
+
+        const KeyframeTrack<3>& GetTranslations() const { return m_translations; }
+        const KeyframeTrack<2>& GetRotations() const { return m_rotations; }
+        float GetDuration() const;
+
+        // Scales all keyframe times around 0 and shifts them by a_offset
+        void Retime(float a_scale, float a_offset);
+        // Maps all keyframe times through the piecewise linear function with knots a_from[i] -> a_to[i]. a_from must be
+        // sorted and a_to must not decrease; times outside the knots keep their offset to the nearest one.
+        void RemapTimes(std::span<const float> a_from, std::span<const float> a_to);
+        // Moves all translation keyframes that are not bound to the camera or a reference's local space
+        void Translate(const RE::NiPoint3& a_delta);
+        // Inserts all keyframes of a_other, shifted by a_timeOffset
+        void Splice(const TimelineModel& a_other, float a_timeOffset);
+        // Copies the keyframes within [a_begin, a_end] to a_begin + a_timeOffset
+        void Duplicate(float a_begin, float a_end, float a_timeOffset);
+
+        Snapshot GetSnapshot() const { return { m_translations, m_rotations }; }
+        Snapshot GetSyncedSnapshot() const { return { m_syncedTranslations, m_syncedRotations }; }
+        void Restore(const Snapshot& a_snapshot);
+
+        uint32_t GetVersion() const { return m_version; }
+        bool IsDirty() const { return m_version != m_syncedVersion; }
+
+        // FCFW changed the timeline behind the model's back (recording, file import), so the synced keyframe
+        // indices can no longer be trusted; the next Sync that needs to remove keyframes rewrites the timeline.
+        void MarkExternallyModified() { m_externallyModified = true; }
+        bool IsExternallyModified() const { return m_externallyModified; }
+        // The FCFW timeline was cleared outside the model
+        void ResetToEmpty();
+
+        SyncStats Sync(const FCFW_API::IVFCFW1& a_api, SKSE::PluginHandle a_handle, size_t a_timelineID);
+
+    private:
+        template <size_t N>
+        static void Diff(const KeyframeTrack<N>& a_synced, const KeyframeTrack<N>& a_current, std::vector<size_t>& a_removed, std::vector<Keyframe<N>>& a_added);
+        template <size_t N>
+        static void ExpandEqualTimes(const KeyframeTrack<N>& a_synced, const KeyframeTrack<N>& a_current, std::vector<size_t>& a_removed, std::vector<Keyframe<N>>& a_added);
+
+        static bool SendTranslation(const FCFW_API::IVFCFW1& a_api, SKSE::PluginHandle a_handle, size_t a_timelineID, const TranslationKeyframe& a_keyframe);
+        static bool SendRotation(const FCFW_API::IVFCFW1& a_api, SKSE::PluginHandle a_handle, size_t a_timelineID, const RotationKeyframe& a_keyframe);
+
+        KeyframeTrack<3> m_translations;
+        KeyframeTrack<2> m_rotations;
+        KeyframeTrack<3> m_syncedTranslations;  // state of the FCFW timeline after the last Sync
+        KeyframeTrack<2> m_syncedRotations;
+        uint32_t m_version = 0;
+        uint32_t m_syncedVersion = 0;
+        bool m_externallyModified = false;
+    }; // class TimelineModel
+} // namespace FCSE
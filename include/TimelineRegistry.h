@@ -0,0 +1,60 @@
+#pragma once
+
+#include "API/FCFW_API.h"
+
+namespace FCSE {
+    enum class PlaybackState : uint8_t {
+        kIdle,
+        kPlaying,
+        kWaiting,    // reached the end in kWait mode, camera is still held by FCFW
+        kRecording,
+        kImporting   // keyframes of a file are still being added, see TimelineManager::BeginImport
+    };
+
+    // Cached metadata of a timeline registered by FCSE
+    struct TimelineInfo {
+        size_t timelineID = 0;
+        int translationCount = 0;
+        int rotationCount = 0;
+        RE::NiPoint3 boundsMin;
+        RE::NiPoint3 boundsMax;
+        float duration = 0.f;     // length of the local TimelineModel, 0 if unknown
+        uint32_t version = 0;     // incremented whenever the metadata changes
+        std::string sourceFile;   // file the timeline was last imported from or exported to
+        PlaybackState playbackState = PlaybackState::kIdle;
+    };
+
+    // The timelines FCSE registered with FCFW, in registration order.
+    // Only touched from the main thread. Input commands and the update hook run there; FCFW messages can arrive on
+    // FCFW's thread and are passed on with SKSE's task interface by TimelineManager::OnFCFWMessage.
+    class TimelineRegistry {
+    public:
+        TimelineInfo& Add(size_t a_timelineID);
+        bool Remove(size_t a_timelineID);
+
+        TimelineInfo* Find(size_t a_timelineID);
+        const TimelineInfo* Find(size_t a_timelineID) const;
+        bool Contains(size_t a_timelineID) const { return m_indices.contains(a_timelineID); }
+
+        // Neighbouring registered timeline, wrapping around. Unknown IDs map to the first entry, 0 if the registry is empty.
+        size_t GetNext(size_t a_timelineID) const;
+        size_t GetPrevious(size_t a_timelineID) const;
+
+        // Updates counts and bounds after the points of a timeline were re-read from FCFW
+        void Refresh(size_t a_timelineID, int a_translationCount, int a_rotationCount, std::span<const RE::NiPoint3> a_translationPoints);
+        void SetDuration(size_t a_timelineID, float a_duration);
+        void SetSourceFile(size_t a_timelineID, std::string_view a_path);
+        void ResetMetadata(size_t a_timelineID);
+        void SetPlaybackState(size_t a_timelineID, PlaybackState a_state);
+        // Tracks playback from FCFW's messages. Returns true if the path has to be re-read, which is the case once
+        // playback ended because it may have resolved camera and reference points.
+        bool ApplyPlaybackMessage(size_t a_timelineID, FCFW_API::FCFWMessage a_message);
+
+        size_t GetSize() const { return m_entries.size(); }
+        std::span<const TimelineInfo> GetEntries() const { return m_entries; }
+
+    private:
+        std::vector<TimelineInfo> m_entries;
+        std::unordered_map<size_t, size_t> m_indices;  // timeline ID -> index into m_entries
+    }; // class TimelineRegistry
+} // namespace FCSE
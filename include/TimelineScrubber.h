@@ -0,0 +1,69 @@
+#pragma once
+
+#include "TimelineModel.h"
+
+namespace FCSE {
+    // Evaluates a timeline at arbitrary times without FCFW playback. Every span between two keyframes is turned into
+    // a cubic polynomial once per timeline version, so a sample is a binary search over the span start times
+    // followed by a Horner evaluation, without allocating.
+    class TimelineScrubber {
+    public:
+        struct Sample {
+            RE::NiPoint3 position;
+            float pitch = 0.f;
+            float yaw = 0.f;
+            bool hasRotation = false;
+        };
+
+        // Keyframe input for Build; times must be sorted
+        template <size_t N>
+        struct TrackInput {
+            std::span<const float> times;
+            std::span<const std::array<float, N>> values;
+            std::span<const uint8_t> flags;             // KeyframeFlags, may be empty
+            std::span<const InterpolationMode> modes;  // may be empty, defaults to kCubicHermite
+        };
+
+        void Build(const TrackInput<3>& a_translations, const TrackInput<2>& a_rotations, uint32_t a_version);
+        void Clear();
+
+        bool IsCurrent(uint32_t a_version) const { return m_isValid && m_version == a_version; }
+        bool IsEmpty() const { return m_translations.IsEmpty(); }
+        float GetStartTime() const { return m_startTime; }
+        float GetEndTime() const { return m_endTime; }
+
+        // Returns false if there is no translation keyframe
+        bool Evaluate(float a_time, Sample& a_out) const;
+
+    private:
+        template <size_t N>
+        class CubicTrack {
+        public:
+            void Build(const TrackInput<N>& a_input);
+            void Clear();
+            bool IsEmpty() const { return m_startTimes.empty(); }
+            float GetFirstTime() const { return m_startTimes.front(); }
+            float GetLastTime() const { return m_endTime; }
+            void Evaluate(float a_time, std::array<float, N>& a_out) const;
+
+        private:
+            struct Span {
+                std::array<std::array<float, N>, 4> coefficients;  // value = c0 + c1 u + c2 u^2 + c3 u^3
+                float inverseDuration = 0.f;
+                bool easeIn = false;
+                bool easeOut = false;
+            };
+
+            std::vector<float> m_startTimes;  // kept apart from the spans so the binary search stays in cache
+            std::vector<Span> m_spans;
+            float m_endTime = 0.f;
+        };
+
+        CubicTrack<3> m_translations;
+        CubicTrack<2> m_rotations;
+        float m_startTime = 0.f;
+        float m_endTime = 0.f;
+        uint32_t m_version = 0;
+        bool m_isValid = false;
+    }; // class TimelineScrubber
+} // namespace FCSE
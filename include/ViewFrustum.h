@@ -0,0 +1,43 @@
+#pragma once
+
+namespace FCSE {
+    // View frustum of the free camera, used to skip debug geometry that cannot be seen.
+    // The side planes are slightly widened, so culling errs on the side of drawing.
+    class ViewFrustum {
+    public:
+        // Returns false if the player camera is not in free camera mode
+        bool FromPlayerCamera(const RE::PlayerCamera* a_playerCamera);
+
+        // Unit view direction for a camera pitch / yaw in radians, as used by FreeCameraState and FCFW
+        static RE::NiPoint3 GetDirection(float a_pitch, float a_yaw) {
+            return RE::NiPoint3(std::sin(a_yaw) * std::cos(a_pitch), std::cos(a_yaw) * std::cos(a_pitch), -std::sin(a_pitch));
+        }
+
+        bool IsSphereVisible(const RE::NiPoint3& a_center, float a_radius) const;
+        bool IsSegmentVisible(const RE::NiPoint3& a_start, const RE::NiPoint3& a_end) const;
+
+        // World-space size that covers a_pixels on screen at a_distance from the camera
+        float GetWorldError(float a_pixels, float a_distance) const {
+            return a_pixels * a_distance / m_pixelsPerRadian;
+        }
+
+        const RE::NiPoint3& GetPosition() const { return m_position; }
+        const RE::NiPoint3& GetForward() const { return m_forward; }
+        float GetPixelsPerRadian() const { return m_pixelsPerRadian; }
+
+    private:
+        struct Plane {
+            RE::NiPoint3 normal;  // points into the frustum
+            float distance = 0.f;
+
+            float SignedDistance(const RE::NiPoint3& a_point) const { return normal.Dot(a_point) - distance; }
+        };
+
+        static constexpr float kFOVMarginDegrees = 10.f;
+
+        RE::NiPoint3 m_position;
+        RE::NiPoint3 m_forward{ 0.f, 1.f, 0.f };
+        float m_pixelsPerRadian = 1000.f;
+        std::array<Plane, 5> m_planes;  // near, left, right, top, bottom
+    }; // class ViewFrustum
+} // namespace FCSE
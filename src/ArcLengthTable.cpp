@@ -0,0 +1,138 @@
+#include "ArcLengthTable.h"
+
+namespace FCSE {
+
+    namespace {
+        constexpr uint32_t kSamples = ArcLengthTable::kSamplesPerSegment;
+
+        constexpr std::array<float, kSamples + 1> MakeSampleParameters() {
+            std::array<float, kSamples + 1> parameters{};
+            for (uint32_t k = 0; k <= kSamples; ++k) {
+                parameters[k] = static_cast<float>(k) / static_cast<float>(kSamples);
+            }
+            return parameters;
+        }
+
+        constexpr std::array<float, kSamples + 1> kSampleParameters = MakeSampleParameters();
+    }
+
+    void ArcLengthTable::Build(std::span<const RE::NiPoint3> a_points, std::span<const InterpolationMode> a_modes) {
+        Clear();
+
+        const size_t count = a_points.size();
+        if (count == 0) {
+            return;
+        }
+
+        m_keyframeDistances.resize(count);
+        m_fractions.resize((count - 1) * kFractionsPerSegment);
+        m_keyframeDistances[0] = 0.f;
+        for (size_t segment = 0; segment + 1 < count; ++segment) {
+            const float length = MeasureSegment(a_points, a_modes, segment, m_fractions.data() + segment * kFractionsPerSegment);
+            m_keyframeDistances[segment + 1] = m_keyframeDistances[segment] + length;
+        }
+    }
+
+    void ArcLengthTable::Clear() {
+        m_keyframeDistances.clear();
+        m_fractions.clear();
+    }
+
+    void ArcLengthTable::UpdateKeyframe(std::span<const RE::NiPoint3> a_points, std::span<const InterpolationMode> a_modes, size_t a_index) {
+        if (a_points.size() != m_keyframeDistances.size()) {
+            Build(a_points, a_modes);
+            return;
+        }
+        if (IsEmpty()) {
+            return;
+        }
+
+        // Through its tangents a keyframe shapes the two segments on either side of it
+        const size_t segmentCount = GetSegmentCount();
+        const size_t first = a_index >= 2 ? a_index - 2 : 0;
+        const size_t last = std::min(a_index + 1, segmentCount - 1);
+
+        const float oldEnd = m_keyframeDistances[last + 1];
+        for (size_t segment = first; segment <= last; ++segment) {
+            const float length = MeasureSegment(a_points, a_modes, segment, m_fractions.data() + segment * kFractionsPerSegment);
+            m_keyframeDistances[segment + 1] = m_keyframeDistances[segment] + length;
+        }
+        const float delta = m_keyframeDistances[last + 1] - oldEnd;
+        for (size_t i = last + 2; i < m_keyframeDistances.size(); ++i) {
+            m_keyframeDistances[i] += delta;
+        }
+    }
+
+    void ArcLengthTable::Locate(float a_distance, size_t& a_segment, float& a_t) const {
+        a_segment = 0;
+        a_t = 0.f;
+        if (IsEmpty()) {
+            return;
+        }
+
+        const float distance = std::clamp(a_distance, 0.f, GetTotalLength());
+        auto it = std::upper_bound(m_keyframeDistances.begin(), m_keyframeDistances.end(), distance);
+        const size_t segment = std::min(static_cast<size_t>(std::max<ptrdiff_t>(it - m_keyframeDistances.begin() - 1, 0)), GetSegmentCount() - 1);
+        a_segment = segment;
+
+        const float length = GetSegmentLength(segment);
+        if (length <= 0.f) {
+            return;
+        }
+
+        // Samples are monotonic, so the first one at or past the distance brackets it
+        const float fraction = (distance - m_keyframeDistances[segment]) / length * kFractionScale;
+        const uint16_t* fractions = m_fractions.data() + segment * kFractionsPerSegment;
+        uint32_t k = 0;
+        while (k < kFractionsPerSegment && fractions[k] < fraction) {
+            ++k;
+        }
+        const float lower = k == 0 ? 0.f : static_cast<float>(fractions[k - 1]);
+        const float upper = k < kFractionsPerSegment ? static_cast<float>(fractions[k]) : kFractionScale;
+        const float local = upper > lower ? (fraction - lower) / (upper - lower) : 0.f;
+        a_t = std::clamp((static_cast<float>(k) + local) / static_cast<float>(kSamplesPerSegment), 0.f, 1.f);
+    }
+
+    float ArcLengthTable::MeasureSegment(std::span<const RE::NiPoint3> a_points, std::span<const InterpolationMode> a_modes, size_t a_segment,
+                                         uint16_t* a_fractions) {
+        const size_t count = a_points.size();
+        const RE::NiPoint3& p0 = a_points[a_segment > 0 ? a_segment - 1 : a_segment];
+        const RE::NiPoint3& p1 = a_points[a_segment];
+        const RE::NiPoint3& p2 = a_points[a_segment + 1];
+        const RE::NiPoint3& p3 = a_points[a_segment + 2 < count ? a_segment + 2 : a_segment + 1];
+
+        const InterpolationMode mode = a_segment + 1 < a_modes.size() ? a_modes[a_segment + 1] : InterpolationMode::kCubicHermite;
+        if (mode != InterpolationMode::kCubicHermite) {
+            // Straight segments are measured directly; a kNone segment is a cut, the camera does not travel along it
+            for (uint32_t k = 0; k < kFractionsPerSegment; ++k) {
+                a_fractions[k] = static_cast<uint16_t>(static_cast<float>(k + 1) / static_cast<float>(kSamplesPerSegment) * kFractionScale + 0.5f);
+            }
+            return mode == InterpolationMode::kLinear ? p1.GetDistance(p2) : 0.f;
+        }
+
+        const CubicSegment curve = CubicSegment::FromHermite(detail::ToArray(p0), detail::ToArray(p1), detail::ToArray(p2), detail::ToArray(p3));
+        std::array<std::array<float, kSamplesPerSegment + 1>, 3> samples;
+        EvaluateCubic(curve, kSampleParameters, { samples[0].data(), samples[1].data(), samples[2].data() });
+
+        std::array<float, kSamplesPerSegment> lengths;
+        for (uint32_t k = 0; k < kSamplesPerSegment; ++k) {
+            const float dx = samples[0][k + 1] - samples[0][k];
+            const float dy = samples[1][k + 1] - samples[1][k];
+            const float dz = samples[2][k + 1] - samples[2][k];
+            lengths[k] = std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+
+        float total = 0.f;
+        for (uint32_t k = 0; k < kSamplesPerSegment; ++k) {
+            total += lengths[k];
+            lengths[k] = total;
+        }
+
+        const float scale = total > 0.f ? kFractionScale / total : 0.f;
+        for (uint32_t k = 0; k < kFractionsPerSegment; ++k) {
+            a_fractions[k] = total > 0.f ? static_cast<uint16_t>(std::min(lengths[k] * scale + 0.5f, kFractionScale))
+                                         : static_cast<uint16_t>(static_cast<float>(k + 1) / static_cast<float>(kSamplesPerSegment) * kFractionScale + 0.5f);
+        }
+        return total;
+    }
+} // namespace FCSE
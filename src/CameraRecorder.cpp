@@ -0,0 +1,182 @@
+#include "CameraRecorder.h"
+#include "_ts_SKSEFunctions.h"
+
+namespace FCSE {
+
+    void CameraRecorder::LoadSettings(const char* a_iniPath) {
+        constexpr float degreesPerRadian = 180.f / std::numbers::pi_v<float>;
+        float positionTolerance = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, "PositionTolerance:Recorder", a_iniPath, m_positionTolerance);
+        float angleTolerance = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, "AngleToleranceDegrees:Recorder", a_iniPath, m_angleTolerance * degreesPerRadian);
+        float minCutoff = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, "MinCutoff:Recorder", a_iniPath, m_minCutoff);
+        float positionBeta = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, "PositionBeta:Recorder", a_iniPath, m_positionBeta);
+        float rotationBeta = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, "RotationBeta:Recorder", a_iniPath, m_rotationBeta);
+
+        if (positionTolerance <= 0.f || angleTolerance <= 0.f || minCutoff <= 0.f || positionBeta < 0.f || rotationBeta < 0.f) {
+            log::warn("{}: Recorder settings in INI file are invalid. Using defaults.", __FUNCTION__);
+            return;
+        }
+
+        m_positionTolerance = positionTolerance;
+        m_angleTolerance = angleTolerance / degreesPerRadian;
+        m_minCutoff = minCutoff;
+        m_positionBeta = positionBeta;
+        m_rotationBeta = rotationBeta;
+        log::info("{}: Recorder tolerance: {} units, {} degrees; filter: {} Hz, beta {} / {}", __FUNCTION__, m_positionTolerance,
+                  angleTolerance, m_minCutoff, m_positionBeta, m_rotationBeta);
+    }
+
+    void CameraRecorder::Start() {
+        m_positionFilter.SetParameters(m_minCutoff, m_positionBeta, m_derivativeCutoff);
+        m_positionFilter.Reset();
+        m_rotationFilter.SetParameters(m_minCutoff, m_rotationBeta, m_derivativeCutoff);
+        m_rotationFilter.Reset();
+
+        m_sampleCount = 0;
+        m_time = 0.f;
+        m_translation.Clear();
+        m_rotation.Clear();
+        m_isRecording = true;
+    }
+
+    void CameraRecorder::AddSample(float a_deltaTime, const RE::NiPoint3& a_position, float a_pitch, float a_yaw) {
+        if (!m_isRecording) {
+            return;
+        }
+
+        const float deltaTime = std::min(a_deltaTime, kMaxDeltaTime);
+        if (m_sampleCount > 0) {
+            if (deltaTime <= 0.f) {
+                return;
+            }
+
+            // Unwrap yaw, so filtering and interpolation never see the jump between pi and -pi
+            constexpr float twoPi = 2.f * std::numbers::pi_v<float>;
+            float deltaYaw = std::fmod(a_yaw - m_lastRawYaw, twoPi);
+            if (deltaYaw > std::numbers::pi_v<float>) {
+                deltaYaw -= twoPi;
+            } else if (deltaYaw < -std::numbers::pi_v<float>) {
+                deltaYaw += twoPi;
+            }
+            m_yaw += deltaYaw;
+            m_time += deltaTime;
+        } else {
+            m_yaw = a_yaw;
+        }
+        m_lastRawYaw = a_yaw;
+
+        const auto position = m_positionFilter.Filter({ a_position.x, a_position.y, a_position.z }, deltaTime);
+        const auto rotation = m_rotationFilter.Filter({ a_pitch, m_yaw }, deltaTime);
+
+        const uint64_t index = m_sampleCount++;
+        Sample& sample = m_samples[index % kCapacity];
+        sample.time = m_time;
+        sample.position = RE::NiPoint3(position[0], position[1], position[2]);
+        sample.rotation = RE::NiPoint3(rotation[0], rotation[1], 0.f);
+
+        if (index == 0) {
+            Emit(m_translation, 0);
+            Emit(m_rotation, 0);
+            return;
+        }
+        Advance(m_translation, index);
+        Advance(m_rotation, index);
+    }
+
+    TimelineData CameraRecorder::Stop() {
+        TimelineData data;
+        if (!m_isRecording) {
+            return data;
+        }
+        m_isRecording = false;
+        if (m_sampleCount == 0) {
+            return data;
+        }
+
+        // The last segment was checked with the path end tangent the whole time, so it needs no further check
+        const uint64_t last = m_sampleCount - 1;
+        for (Track* track : { &m_translation, &m_rotation }) {
+            if (track->anchor != last) {
+                Emit(*track, last);
+            }
+        }
+
+        data.translations.reserve(m_translation.points.size());
+        for (size_t i = 0; i < m_translation.points.size(); ++i) {
+            const RE::NiPoint3& point = m_translation.points[i];
+            data.translations.push_back({ .time = m_translation.times[i], .value = { point.x, point.y, point.z } });
+        }
+        data.rotations.reserve(m_rotation.points.size());
+        for (size_t i = 0; i < m_rotation.points.size(); ++i) {
+            const RE::NiPoint3& point = m_rotation.points[i];
+            data.rotations.push_back({ .time = m_rotation.times[i], .value = { point.x, point.y } });
+        }
+
+        m_translation.Clear();
+        m_rotation.Clear();
+        return data;
+    }
+
+    const RE::NiPoint3& CameraRecorder::GetValue(const Track& a_track, uint64_t a_sample) const {
+        const Sample& sample = m_samples[a_sample % kCapacity];
+        return a_track.isRotation ? sample.rotation : sample.position;
+    }
+
+    bool CameraRecorder::IsWithinTolerance(const Track& a_track, const RE::NiPoint3& a_predicted, const RE::NiPoint3& a_actual) const {
+        if (!a_track.isRotation) {
+            return (a_predicted - a_actual).SqrLength() <= m_positionTolerance * m_positionTolerance;
+        }
+
+        // Angle between the view directions, small angle approximation; yaw matters less when looking up or down
+        const float pitchError = a_predicted.x - a_actual.x;
+        const float yawError = (a_predicted.y - a_actual.y) * std::cos(a_actual.x);
+        return pitchError * pitchError + yawError * yawError <= m_angleTolerance * m_angleTolerance;
+    }
+
+    bool CameraRecorder::FitsSegment(const Track& a_track, const RE::NiPoint3& a_p0, uint64_t a_from, uint64_t a_to, const RE::NiPoint3& a_p3) const {
+        using Evaluator = SegmentEvaluator<InterpolationMode::kCubicHermite>;
+
+        const RE::NiPoint3& p1 = GetValue(a_track, a_from);
+        const RE::NiPoint3& p2 = GetValue(a_track, a_to);
+        const float startTime = m_samples[a_from % kCapacity].time;
+        const float duration = m_samples[a_to % kCapacity].time - startTime;
+        if (duration <= 0.f) {
+            return true;
+        }
+
+        for (uint64_t i = a_from + 1; i < a_to; ++i) {
+            const float t = (m_samples[i % kCapacity].time - startTime) / duration;
+            if (!IsWithinTolerance(a_track, Evaluator::Evaluate(a_p0, p1, p2, a_p3, t), GetValue(a_track, i))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void CameraRecorder::Advance(Track& a_track, uint64_t a_sample) {
+        // Tries a_sample as the end of the last segment. It would also become p3 of the segment before.
+        const size_t count = a_track.points.size();
+        const RE::NiPoint3& end = GetValue(a_track, a_sample);
+        const RE::NiPoint3& lastP0 = count >= 2 ? a_track.points[count - 2] : a_track.points[count - 1];
+        bool fits = a_sample - a_track.previous + 1 < kCapacity && FitsSegment(a_track, lastP0, a_track.anchor, a_sample, end);
+        if (fits && count >= 2) {
+            const RE::NiPoint3& previousP0 = count >= 3 ? a_track.points[count - 3] : a_track.points[count - 2];
+            fits = FitsSegment(a_track, previousP0, a_track.previous, a_track.anchor, end);
+        }
+        if (fits) {
+            return;
+        }
+
+        // The sample before passed both checks on the last frame. Right after a keyframe there is none to fall back
+        // on, so the new sample is kept even if the segment before drifts.
+        Emit(a_track, a_sample - 1 > a_track.anchor ? a_sample - 1 : a_sample);
+    }
+
+    void CameraRecorder::Emit(Track& a_track, uint64_t a_sample) {
+        if (!a_track.points.empty()) {
+            a_track.previous = a_track.anchor;
+        }
+        a_track.anchor = a_sample;
+        a_track.times.push_back(m_samples[a_sample % kCapacity].time);
+        a_track.points.push_back(GetValue(a_track, a_sample));
+    }
+} // namespace FCSE
@@ -1,93 +1,35 @@
 #include "ControlsManager.h"
 #include "TimelineManager.h"
 #include "APIManager.h"
-#include "Offsets.h"
+#include "ReferenceResolver.h"
+#include "TakeLibrary.h"
+#include "_ts_SKSEFunctions.h"
+
+#include <charconv>
 
 namespace FCSE {
 
     RE::BSEventNotifyControl ControlsManager::ProcessEvent(RE::InputEvent* const* a_event, RE::BSTEventSource<RE::InputEvent*>*) {
 
-        if (!a_event || RE::UI::GetSingleton()->GameIsPaused()) {
+        if (!a_event) {
+            return RE::BSEventNotifyControl::kContinue;
+        }
+        if (RE::UI::GetSingleton()->GameIsPaused()) {
+            ResetInput();
             return RE::BSEventNotifyControl::kContinue;
         }
+        if (m_isInputStale.exchange(false, std::memory_order_relaxed)) {
+            ResetInput();
+        }
 
-        for (auto* event = *a_event; event; event = event->next) {
-            if (event->eventType == RE::INPUT_EVENT_TYPE::kButton) {
-                auto* buttonEvent = static_cast<RE::ButtonEvent*>(event);
-                if (!buttonEvent || !buttonEvent->IsDown()) {
-                    continue;
-                }
-                
-                int ret;
-
-                const char* relativePath = "SKSE/Plugins/FCSE_CameraPath.yaml";
-
-                SKSE::PluginHandle handle = SKSE::GetPluginHandle();
-                auto timelineID = TimelineManager::GetSingleton().GetTimelineID();
-
-                const uint32_t key = buttonEvent->GetIDCode();
-                if (key == 2) {
-                    if (APIs::FCFW->IsPlaybackPaused(handle, timelineID)) {
-                        ret = APIs::FCFW->ResumePlayback(handle, timelineID);
-                    } else {
-                        ret = APIs::FCFW->PausePlayback(handle, timelineID);
-                    }
-                } else if (key == 3) {
-                    ret = APIs::FCFW->StopPlayback(handle, timelineID);
-                } else if (key == 4) {
-                    APIs::FCFW->AllowUserRotation(handle, timelineID, !APIs::FCFW->IsUserRotationAllowed(handle, timelineID));
-                } else if (key == 5) {
-                    RE::TESObjectREFR* reference = nullptr;
-                    auto* form = RE::TESForm::LookupByID(0xd8c58);
-                    reference = form ? form->As<RE::TESObjectREFR>() : nullptr;
-                    if (reference) {
-                        bool isOffsetRelative = true;
-
-                        auto headPos = GetTargetPoint(reference->As<RE::Actor>());
-                        RE::NiPoint3 offset;
-                        if (headPos) {
-                            offset = headPos->world.translate - reference->GetPosition();
-                            offset.y += 20.f;
-                        }
-                        RE::BSTPoint2<float> rotOffset = {0.f, 0.f};
-
-                        ret = APIs::FCFW->AddTranslationPointAtCamera(handle, timelineID, 0.0f, true, true);
-                        ret = APIs::FCFW->AddRotationPointAtCamera(handle, timelineID, 0.f, true, true);
-                        ret = APIs::FCFW->AddRotationPointAtRef(handle, timelineID, 0.5f, reference, rotOffset, false, true, true);
-                        ret = APIs::FCFW->AddRotationPointAtRef(handle, timelineID, 1.5f, reference, rotOffset, false, true, true);
-                        ret = APIs::FCFW->AddTranslationPointAtRef(handle, timelineID, 2.f, reference, offset, isOffsetRelative, true, true);
-                        ret = APIs::FCFW->AddRotationPointAtRef(handle, timelineID, 2.f, reference, rotOffset, isOffsetRelative, true, true);
-                        ret = APIs::FCFW->AddTranslationPointAtRef(handle, timelineID, 8.f, reference, offset, isOffsetRelative, true, true);
-                        ret = APIs::FCFW->AddRotationPointAtRef(handle, timelineID, 8.f, reference, rotOffset, isOffsetRelative, true, true);
-                        ret = APIs::FCFW->AddRotationPointAtRef(handle, timelineID, 9.f, RE::PlayerCharacter::GetSingleton(), rotOffset, false, true, true);
-                        ret = APIs::FCFW->AddTranslationPointAtCamera(handle, timelineID, 10.0f, true, true);
-                        ret = APIs::FCFW->AddRotationPointAtCamera(handle, timelineID, 10.f, true, true);
-                        
-                        log::info("Created timeline {} with reference tracking", timelineID);
-                        ret = APIs::FCFW->StartPlayback(handle, timelineID, 1.0f, false, false, false, 0.0f);
-                    }
-                } else if (key == 6) {
-                    ret = APIs::FCFW->ClearTimeline(handle, timelineID);
-                } else if (key == 7) {
-                    ret = APIs::FCFW->StartPlayback(handle, timelineID, 1.0f, false, false, false, 0.0f);
-                } else if (key == 8) {
-                    ret = APIs::FCFW->StartRecording(handle, timelineID);
-                } else if (key == 9) {
-                    ret = APIs::FCFW->StopRecording(handle, timelineID);
-                } else if (key == 10) {
-                    RE::DebugNotification("Exporting camera path...");
-                    ret = APIs::FCFW->ExportTimeline(handle, timelineID, relativePath);
-                } else if (key == 11) {
-                    RE::DebugNotification("Importing camera path...");
-                    ret = APIs::FCFW->AddTimelineFromFile(handle, timelineID, relativePath);
-                } else if (key == 20) { // T
-                    ret = TimelineManager::GetSingleton().RegisterTimeline();
-                } else if (key == 21) { // Y
-                    ret = TimelineManager::GetSingleton().UnregisterTimeline();
-                } else if (key == 22) { // U
-                    ret = TimelineManager::GetSingleton().CycleUp();
-                } else if (key == 35) { // H
-                    ret = TimelineManager::GetSingleton().CycleDown();
+        m_dispatcher.ProcessEvents(*a_event, [this](const Command& a_command) { QueueCommand(a_command); });
+
+        if (m_isScrubbing) {
+            // Mouse moves are summed up instead of queued, one scrub step per frame is enough
+            for (auto* event = *a_event; event; event = event->next) {
+                if (event->eventType == RE::INPUT_EVENT_TYPE::kMouseMove) {
+                    auto* mouseEvent = static_cast<RE::MouseMoveEvent*>(event);
+                    m_scrubMouseDelta.fetch_add(mouseEvent->mouseInputX, std::memory_order_relaxed);
                 }
             }
         }
@@ -95,36 +37,281 @@ namespace FCSE {
         return RE::BSEventNotifyControl::kContinue;
     }
 
-    RE::NiPointer<RE::NiAVObject> ControlsManager::GetTargetPoint(RE::Actor* a_actor) {
-        RE::NiPointer<RE::NiAVObject> targetPoint = nullptr;
+    void ControlsManager::LoadSettings(const char* a_iniPath) {
+        auto bindings = kDefaultKeyBindings;
+        for (auto& binding : bindings) {
+            const std::string name(kActionNames[static_cast<size_t>(binding.action)]);
+            long key = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, (name + "Key:Controls").c_str(), a_iniPath, static_cast<long>(binding.key));
+            long modifiers = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, (name + "Modifiers:Controls").c_str(), a_iniPath, static_cast<long>(binding.modifiers));
+            long trigger = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, (name + "Trigger:Controls").c_str(), a_iniPath, static_cast<long>(binding.trigger));
+            long timeMs = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, (name + "TimeMs:Controls").c_str(), a_iniPath, static_cast<long>(binding.time * 1000.f));
+
+            if (key < 0 || key >= static_cast<long>(InputMap::kMaxMacros) || modifiers < 0 || modifiers >= kModifierCombinations ||
+                trigger < 0 || trigger > static_cast<long>(Trigger::kRepeat) || timeMs < 0) {
+                log::warn("{}: Invalid key binding for {} in INI file. Using default.", __FUNCTION__, name);
+                continue;
+            }
+
+            binding.key = static_cast<uint32_t>(key);
+            binding.modifiers = static_cast<uint8_t>(modifiers);
+            binding.trigger = static_cast<Trigger>(trigger);
+            binding.time = static_cast<float>(timeMs) / 1000.f;
+        }
+
+        m_dispatcher.BuildDispatchTable(bindings);
+    }
+
+    void ControlsManager::QueueCommand(const Command& a_command) {
+        if (a_command.action == Action::kScrub) {
+            m_isScrubbing = !a_command.isRelease;
+        }
+        if (!m_commands.Push(a_command)) {
+            log::warn("{}: Command queue is full, dropping {}{}", __FUNCTION__, a_command.isRelease ? "release of " : "",
+                      kActionNames[static_cast<size_t>(a_command.action)]);
+        }
+    }
+
+    void ControlsManager::ResetInput() {
+        m_dispatcher.Reset([this](const Command& a_release) { QueueCommand(a_release); });
+        m_isScrubbing = false;
+    }
+
+    void ControlsManager::Update() {
+        const auto start = std::chrono::steady_clock::now();
+
+        // Keys released while the window is in the background never reach the input sink
+        if (!RE::Main::GetSingleton()->gameActive) {
+            m_isInputStale.store(true, std::memory_order_relaxed);
+        }
 
-        if (!a_actor) {
-            return nullptr;
+        const int32_t scrubDelta = m_scrubMouseDelta.exchange(0, std::memory_order_relaxed);
+        if (scrubDelta != 0) {
+            TimelineManager::GetSingleton().Scrub(static_cast<float>(scrubDelta) * kScrubSecondsPerCount);
         }
 
-        auto race = a_actor->GetRace();
-        if (!race) {
-            return nullptr;
+        // At least one command runs per frame; the rest waits once the budget is used up
+        Command command;
+        while (m_commands.Pop(command)) {
+            if (command.isRelease) {
+                ExecuteRelease(command.action);
+            } else {
+                ExecuteAction(command.action);
+            }
+
+            const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            if (elapsed.count() >= kCommandBudgetMicroseconds) {
+                if (!m_commands.IsEmpty()) {
+                    log::debug("{}: Command budget used up after {} us, continuing next frame", __FUNCTION__, elapsed.count());
+                }
+                break;
+            }
         }
+    }
 
-        RE::BGSBodyPartData* bodyPartData = race->bodyPartData;
-        if (!bodyPartData) {
-            return nullptr;
+    void ControlsManager::ExecuteRelease(Action a_action) {
+        switch (a_action) {
+        case Action::kScrub:
+            TimelineManager::GetSingleton().EndScrub();
+            break;
+        default:
+            break;
         }
+    }
 
-        auto actor3D = a_actor->Get3D2();
-        if (!actor3D) {
-            return nullptr;
+    bool ControlsManager::IsBlockedWhileImporting(Action a_action) {
+        switch (a_action) {
+        case Action::kImportTimeline:
+        case Action::kRegisterTimeline:
+        case Action::kUnregisterTimeline:
+        case Action::kCycleUp:
+        case Action::kCycleDown:
+        case Action::kToggleRotationGizmos:
+        case Action::kTogglePreview:
+        case Action::kNextTake:
+        case Action::kPreviousTake:
+            return false;
+        default:
+            return true;
         }
-    
-        RE::BGSBodyPart* bodyPart = bodyPartData->parts[RE::BGSBodyPartDefs::LIMB_ENUM::kHead];
-        if (!bodyPart) {
-            bodyPart = bodyPartData->parts[RE::BGSBodyPartDefs::LIMB_ENUM::kTotal];
+    }
+
+    std::string ControlsManager::GetImportPath(std::string_view a_defaultPath) {
+        const auto take = TakeLibrary::GetSingleton().GetSelected();
+        std::string path(take ? std::string_view(take->path) : a_defaultPath);
+        if (TimelineFile::IsBinaryPath(path)) {
+            return path;
+        }
+
+        // The binary copy is only used while it is at least as new as the YAML file, which may have been hand-edited
+        std::string binaryPath = TimelineFile::GetBinaryPath(path);
+        return TimelineFile::IsUpToDate(binaryPath, path) ? binaryPath : path;
+    }
+
+    void ControlsManager::ExecuteAction(Action a_action) {
+        if (!APIs::FCFW) {
+            return;
+        }
+
+        int ret = 0;
+
+        const char* relativePath = "SKSE/Plugins/FCSE_CameraPath.yaml";
+        const char* binaryPath = "SKSE/Plugins/FCSE_CameraPath.fcsb";
+
+        SKSE::PluginHandle handle = SKSE::GetPluginHandle();
+        auto timelineID = TimelineManager::GetSingleton().GetTimelineID();
+
+        // A half-imported timeline is neither played nor edited until the import commits or is cancelled
+        if (TimelineManager::GetSingleton().IsImporting(timelineID) && IsBlockedWhileImporting(a_action)) {
+            RE::DebugNotification("Camera path is still importing");
+            return;
+        }
+
+        switch (a_action) {
+        case Action::kTogglePause:
+            if (APIs::FCFW->IsPlaybackPaused(handle, timelineID)) {
+                ret = APIs::FCFW->ResumePlayback(handle, timelineID);
+            } else {
+                ret = APIs::FCFW->PausePlayback(handle, timelineID);
+            }
+            break;
+        case Action::kStopPlayback:
+            ret = APIs::FCFW->StopPlayback(handle, timelineID);
+            break;
+        case Action::kToggleUserRotation:
+            APIs::FCFW->AllowUserRotation(handle, timelineID, !APIs::FCFW->IsUserRotationAllowed(handle, timelineID));
+            break;
+        case Action::kBuildReferenceScene: {
+            auto& resolver = ReferenceResolver::GetSingleton();
+            RE::TESObjectREFR* reference = resolver.GetReference(kSceneReferenceID);
+            if (reference) {
+                bool isOffsetRelative = true;
+
+                auto headPos = resolver.GetBodyPartNode(kSceneReferenceID, RE::BGSBodyPartDefs::LIMB_ENUM::kHead);
+                RE::NiPoint3 offset;
+                if (headPos) {
+                    offset = headPos->world.translate - reference->GetPosition();
+                    offset.y += 20.f;
+                }
+                RE::BSTPoint2<float> rotOffset = {0.f, 0.f};
+
+                // Built locally and sent to FCFW as one batch
+                auto& timelineManager = TimelineManager::GetSingleton();
+                auto& model = timelineManager.GetModel(timelineID);
+                constexpr uint8_t ease = kKeyframeEaseIn | kKeyframeEaseOut;
+                const uint8_t refFlags = static_cast<uint8_t>(isOffsetRelative ? ease | kKeyframeOffsetRelative : ease);
+                const RE::FormID refID = reference->GetFormID();
+                const RE::FormID playerID = RE::PlayerCharacter::GetSingleton()->GetFormID();
+
+                model.AddTranslation({ .time = 0.f, .flags = ease | kKeyframeAtCamera });
+                model.AddRotation({ .time = 0.f, .flags = ease | kKeyframeAtCamera });
+                model.AddRotation({ .time = 0.5f, .value = { rotOffset.x, rotOffset.y }, .flags = ease, .reference = refID });
+                model.AddRotation({ .time = 1.5f, .value = { rotOffset.x, rotOffset.y }, .flags = ease, .reference = refID });
+                model.AddTranslation({ .time = 2.f, .value = { offset.x, offset.y, offset.z }, .flags = refFlags, .reference = refID });
+                model.AddRotation({ .time = 2.f, .value = { rotOffset.x, rotOffset.y }, .flags = refFlags, .reference = refID });
+                model.AddTranslation({ .time = 8.f, .value = { offset.x, offset.y, offset.z }, .flags = refFlags, .reference = refID });
+                model.AddRotation({ .time = 8.f, .value = { rotOffset.x, rotOffset.y }, .flags = refFlags, .reference = refID });
+                model.AddRotation({ .time = 9.f, .value = { rotOffset.x, rotOffset.y }, .flags = ease, .reference = playerID });
+                model.AddTranslation({ .time = 10.f, .flags = ease | kKeyframeAtCamera });
+                model.AddRotation({ .time = 10.f, .flags = ease | kKeyframeAtCamera });
+                ret = timelineManager.CommitModel(timelineID);
+                
+                log::info("Created timeline {} with reference tracking", timelineID);
+                ret = APIs::FCFW->StartPlayback(handle, timelineID, 1.0f, false, false, false, 0.0f);
+            }
+            break;
+        }
+        case Action::kClearTimeline:
+            ret = APIs::FCFW->ClearTimeline(handle, timelineID);
+            if (ret) {
+                TimelineManager::GetSingleton().ResetModel(timelineID);
+            }
+            break;
+        case Action::kStartPlayback:
+            ret = APIs::FCFW->StartPlayback(handle, timelineID, 1.0f, false, false, false, 0.0f);
+            break;
+        case Action::kStartRecording:
+            ret = TimelineManager::GetSingleton().StartRecording(timelineID);
+            break;
+        case Action::kStopRecording:
+            ret = TimelineManager::GetSingleton().StopRecording();
+            break;
+        case Action::kExportTimeline:
+            ret = TimelineManager::GetSingleton().ExportTimeline(timelineID, relativePath, binaryPath);
+            break;
+        case Action::kImportTimeline:
+            // Pressing the key again while the import runs cancels it
+            if (TimelineManager::GetSingleton().IsImporting(timelineID)) {
+                ret = TimelineManager::GetSingleton().CancelImport();
+                break;
+            }
+            ret = TimelineManager::GetSingleton().BeginImport(timelineID, GetImportPath(relativePath));
+            if (!ret) {
+                RE::DebugNotification("Importing camera path failed");
+            }
+            break;
+        case Action::kRegisterTimeline:
+            ret = TimelineManager::GetSingleton().RegisterTimeline();
+            break;
+        case Action::kUnregisterTimeline:
+            ret = TimelineManager::GetSingleton().UnregisterTimeline();
+            break;
+        case Action::kCycleUp:
+            ret = TimelineManager::GetSingleton().CycleUp();
+            break;
+        case Action::kToggleRotationGizmos:
+            ret = TimelineManager::GetSingleton().ToggleRotationGizmos();
+            break;
+        case Action::kCycleDown:
+            ret = TimelineManager::GetSingleton().CycleDown();
+            break;
+        case Action::kUndo:
+            ret = TimelineManager::GetSingleton().Undo();
+            break;
+        case Action::kRedo:
+            ret = TimelineManager::GetSingleton().Redo();
+            break;
+        case Action::kToggleDrag:
+            ret = TimelineManager::GetSingleton().ToggleDrag();
+            break;
+        case Action::kScrub:
+            ret = TimelineManager::GetSingleton().BeginScrub();
+            break;
+        case Action::kRetimeConstantSpeed:
+            ret = TimelineManager::GetSingleton().RetimeConstantSpeed();
+            break;
+        case Action::kTogglePreview:
+            // Previews the file the import key would load
+            if (TimelineManager::GetSingleton().IsPreviewing()) {
+                TimelineManager::GetSingleton().EndPreview();
+                break;
+            }
+            ret = TimelineManager::GetSingleton().BeginPreview(GetImportPath(relativePath));
+            break;
+        case Action::kNextTake:
+        case Action::kPreviousTake: {
+            // Takes are drawn from their library summary, their files are only read on preview or import
+            auto& library = TakeLibrary::GetSingleton();
+            const auto take = library.Select(a_action == Action::kNextTake ? 1 : -1);
+            if (!take) {
+                RE::DebugNotification(library.IsScanning() ? "Take library is still being scanned" : "No camera paths found");
+                break;
+            }
+            TimelineManager::GetSingleton().ShowPreview(take->path, take->GetPreview());
+
+            std::array<char, 16> duration;
+            const auto result = std::to_chars(duration.data(), duration.data() + duration.size(), take->duration, std::chars_format::fixed, 1);
+            std::string message(take->GetName());
+            message += ": " + std::to_string(take->translationCount + take->rotationCount) + " keyframes, ";
+            message.append(duration.data(), result.ptr);
+            message += " s";
+            RE::DebugNotification(message.c_str());
+            ret = true;
+            break;
         }
-        if (bodyPart) {
-            targetPoint = RE::NiPointer<RE::NiAVObject>(NiAVObject_LookupBoneNodeByName(actor3D, bodyPart->targetName, true));
+        default:
+            return;
         }
 
-        return targetPoint;
+        log::debug("{}: {} returned {}", __FUNCTION__, kActionNames[static_cast<size_t>(a_action)], ret);
     }
 } // namespace FCSE
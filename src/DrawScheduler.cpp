@@ -0,0 +1,93 @@
+#include "DrawScheduler.h"
+#include "_ts_SKSEFunctions.h"
+
+namespace FCSE {
+
+    void DrawScheduler::LoadSettings(const char* a_iniPath) {
+        long budgetMicroseconds = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, "BudgetMicroseconds:Draw", a_iniPath, static_cast<long>(m_budgetMicroseconds));
+        long budgetPrimitives = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, "BudgetPrimitives:Draw", a_iniPath, static_cast<long>(m_budgetPrimitives));
+
+        if (budgetMicroseconds < 0 || budgetPrimitives < 0) {
+            log::warn("{}: Draw budget in INI file is invalid. Using defaults.", __FUNCTION__);
+            return;
+        }
+
+        m_budgetMicroseconds = static_cast<uint32_t>(budgetMicroseconds);
+        m_budgetPrimitives = static_cast<uint32_t>(budgetPrimitives);
+        log::info("{}: Draw budget: {} us, {} primitives per frame", __FUNCTION__, m_budgetMicroseconds, m_budgetPrimitives);
+    }
+
+    void DrawScheduler::BeginFrame(const ViewFrustum& a_frustum) {
+        m_frustum = a_frustum;
+    }
+
+    void DrawScheduler::Enqueue(Producer a_producer, uint64_t a_key, const RE::NiPoint3& a_position, float a_radius,
+                                uint32_t a_primitiveCount, std::function<void()> a_draw) {
+        const uint64_t id = MakeID(a_producer, a_key);
+
+        RE::NiPoint3 toItem = a_position - m_frustum.GetPosition();
+        const float distance = std::max(toItem.Unitize() - a_radius, 1.f);
+        const float alignment = std::max(toItem.Dot(m_frustum.GetForward()), 0.f);
+        const float crosshairFactor = 1.f + kCrosshairBoost * alignment * alignment * alignment * alignment;
+
+        auto waitIt = m_waitFrames.find(id);
+        const float waitFactor = 1.f + kWaitBoost * (waitIt != m_waitFrames.end() ? static_cast<float>(waitIt->second) : 0.f);
+
+        WorkItem item;
+        item.id = id;
+        item.priority = kProducerWeights[static_cast<size_t>(a_producer)] * crosshairFactor * waitFactor / distance;
+        item.primitiveCount = a_primitiveCount;
+        item.draw = std::move(a_draw);
+        m_queue.push_back(std::move(item));
+    }
+
+    void DrawScheduler::Flush() {
+        if (m_queue.empty()) {
+            m_deferredCount = 0;
+            return;
+        }
+
+        std::sort(m_queue.begin(), m_queue.end(), [](const WorkItem& a_lhs, const WorkItem& a_rhs) {
+            return a_lhs.priority > a_rhs.priority;
+        });
+
+        const auto start = std::chrono::steady_clock::now();
+        uint32_t primitives = 0;
+        size_t executed = 0;
+        for (; executed < m_queue.size(); ++executed) {
+            auto& item = m_queue[executed];
+
+            // Always execute at least one item so oversized items cannot starve
+            if (executed > 0) {
+                if (m_budgetPrimitives > 0 && primitives + item.primitiveCount > m_budgetPrimitives) {
+                    break;
+                }
+                if (m_budgetMicroseconds > 0) {
+                    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                    if (elapsed.count() >= m_budgetMicroseconds) {
+                        break;
+                    }
+                }
+            }
+
+            item.draw();
+            primitives += item.primitiveCount;
+        }
+
+        // Producers enqueue deferred items again next frame; remember how long they have waited.
+        // Items that were executed or not enqueued this frame start over.
+        std::unordered_map<uint64_t, uint32_t> waitFrames;
+        for (size_t i = executed; i < m_queue.size(); ++i) {
+            auto waitIt = m_waitFrames.find(m_queue[i].id);
+            waitFrames[m_queue[i].id] = (waitIt != m_waitFrames.end() ? waitIt->second : 0) + 1;
+        }
+        m_waitFrames.swap(waitFrames);
+        m_deferredCount = m_queue.size() - executed;
+
+        if (m_deferredCount > 0) {
+            log::trace("{}: Executed {} draw items ({} primitives), deferred {}", __FUNCTION__, executed, primitives, m_deferredCount);
+        }
+
+        m_queue.clear();
+    }
+} // namespace FCSE
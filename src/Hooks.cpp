@@ -1,5 +1,7 @@
 #include "Hooks.h"
 #include "TimelineManager.h"
+#include "ControlsManager.h"
+#include "DrawScheduler.h"
 
 namespace Hooks
 {
@@ -16,7 +18,9 @@ namespace Hooks
 	{
 		_Nullsub();
 
+		FCSE::ControlsManager::GetSingleton().Update();
 		FCSE::TimelineManager::GetSingleton().Update();
+		FCSE::DrawScheduler::GetSingleton().Flush();
 		
 	}
 
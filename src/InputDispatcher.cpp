@@ -0,0 +1,110 @@
+#include "InputDispatcher.h"
+
+namespace FCSE {
+
+    void InputDispatcher::Bind(const KeyBinding& a_binding) {
+        DXScanCode key(a_binding.key);
+        if (key == InputMap::kMaxMacros || a_binding.modifiers >= kModifierCombinations) {
+            return;
+        }
+
+        auto& slot = m_dispatchTable[static_cast<uint32_t>(key)][a_binding.modifiers];
+        if (slot != Action::kNone) {
+            log::warn("{}: Key {} (modifiers {}) is bound to both {} and {}, using the latter", __FUNCTION__, a_binding.key, a_binding.modifiers,
+                      kActionNames[static_cast<size_t>(slot)], kActionNames[static_cast<size_t>(a_binding.action)]);
+        }
+        slot = a_binding.action;
+        m_actionSettings[static_cast<size_t>(a_binding.action)] = { a_binding.trigger, a_binding.time };
+    }
+
+    DXScanCode InputDispatcher::GetScanCode(const RE::ButtonEvent* a_buttonEvent) {
+        switch (a_buttonEvent->GetDevice()) {
+        case RE::INPUT_DEVICE::kKeyboard:
+            return DXScanCode(a_buttonEvent->GetIDCode());
+        case RE::INPUT_DEVICE::kMouse:
+            return DXScanCode(a_buttonEvent->GetIDCode() + InputMap::kMacro_MouseButtonOffset);
+        default:
+            return DXScanCode();
+        }
+    }
+
+    uint8_t InputDispatcher::GetModifier(uint32_t a_key) {
+        switch (a_key) {
+        case 42:   // left shift
+        case 54:   // right shift
+            return kModifierShift;
+        case 29:   // left ctrl
+        case 157:  // right ctrl
+            return kModifierCtrl;
+        case 56:   // left alt
+        case 184:  // right alt
+            return kModifierAlt;
+        default:
+            return kModifierNone;
+        }
+    }
+
+    uint8_t InputDispatcher::GetModifiers(const RE::InputEvent* a_event) {
+        uint8_t modifiers = kModifierNone;
+        for (auto* event = a_event; event; event = event->next) {
+            if (event->GetEventType() != RE::INPUT_EVENT_TYPE::kButton || event->GetDevice() != RE::INPUT_DEVICE::kKeyboard) {
+                continue;
+            }
+            const auto* buttonEvent = static_cast<const RE::ButtonEvent*>(event);
+            if (buttonEvent->IsPressed()) {
+                modifiers |= GetModifier(buttonEvent->GetIDCode());
+            }
+        }
+        return modifiers;
+    }
+
+    bool InputDispatcher::ProcessButton(const RE::ButtonEvent* a_buttonEvent, Command& a_command) {
+        const DXScanCode scanCode = GetScanCode(a_buttonEvent);
+        if (scanCode == InputMap::kMaxMacros) {
+            return false;
+        }
+
+        const uint32_t key = static_cast<uint32_t>(scanCode);
+        auto& state = m_keyStates[key];
+
+        if (a_buttonEvent->IsDown()) {
+            // The action is latched on press, so releasing a modifier while holding does not change it
+            state.action = m_dispatchTable[key][m_modifiers];
+            state.fireCount = 0;
+        } else if (a_buttonEvent->IsUp()) {
+            const Action action = state.action;
+            state.action = Action::kNone;
+            if (!LastsWhileHeld(action)) {
+                return false;
+            }
+            a_command = Command{ action, true };
+            return true;
+        }
+
+        if (state.action == Action::kNone) {
+            return false;
+        }
+
+        const auto& settings = m_actionSettings[static_cast<size_t>(state.action)];
+        const float heldDuration = a_buttonEvent->HeldDuration();
+        uint32_t dueCount = 0;
+        switch (settings.trigger) {
+        case Trigger::kPress:
+            dueCount = 1;
+            break;
+        case Trigger::kHold:
+            dueCount = heldDuration >= settings.time ? 1 : 0;
+            break;
+        case Trigger::kRepeat:
+            dueCount = 1 + (settings.time > 0.f ? static_cast<uint32_t>(heldDuration / settings.time) : 0);
+            break;
+        }
+
+        if (dueCount <= state.fireCount) {
+            return false;
+        }
+        state.fireCount = dueCount;
+        a_command = Command{ state.action };
+        return true;
+    }
+} // namespace FCSE
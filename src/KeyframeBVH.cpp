@@ -0,0 +1,226 @@
+#include "KeyframeBVH.h"
+
+namespace FCSE {
+
+    namespace {
+        bool RayIntersectsBox(const RE::NiPoint3& a_origin, const RE::NiPoint3& a_direction, const RE::NiPoint3& a_min, const RE::NiPoint3& a_max) {
+            float tMin = 0.f;
+            float tMax = std::numeric_limits<float>::max();
+            const float origin[3] = { a_origin.x, a_origin.y, a_origin.z };
+            const float direction[3] = { a_direction.x, a_direction.y, a_direction.z };
+            const float boxMin[3] = { a_min.x, a_min.y, a_min.z };
+            const float boxMax[3] = { a_max.x, a_max.y, a_max.z };
+            for (int axis = 0; axis < 3; ++axis) {
+                if (std::abs(direction[axis]) < 1e-8f) {
+                    if (origin[axis] < boxMin[axis] || origin[axis] > boxMax[axis]) {
+                        return false;
+                    }
+                    continue;
+                }
+                const float inverse = 1.f / direction[axis];
+                float t0 = (boxMin[axis] - origin[axis]) * inverse;
+                float t1 = (boxMax[axis] - origin[axis]) * inverse;
+                if (t0 > t1) {
+                    std::swap(t0, t1);
+                }
+                tMin = std::max(tMin, t0);
+                tMax = std::min(tMax, t1);
+                if (tMin > tMax) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        float FarthestCornerDistance(const RE::NiPoint3& a_point, const RE::NiPoint3& a_min, const RE::NiPoint3& a_max) {
+            const RE::NiPoint3 far = {
+                std::max(std::abs(a_point.x - a_min.x), std::abs(a_point.x - a_max.x)),
+                std::max(std::abs(a_point.y - a_min.y), std::abs(a_point.y - a_max.y)),
+                std::max(std::abs(a_point.z - a_min.z), std::abs(a_point.z - a_max.z))
+            };
+            return far.Length();
+        }
+    }
+
+    void KeyframeBVH::Build(std::span<const RE::NiPoint3> a_points) {
+        Clear();
+        if (a_points.empty()) {
+            return;
+        }
+
+        const uint32_t count = static_cast<uint32_t>(a_points.size());
+        m_points.assign(a_points.begin(), a_points.end());
+        m_order.resize(count);
+        std::iota(m_order.begin(), m_order.end(), 0u);
+        m_leafOfPoint.resize(count);
+
+        // Leaves hold at least kLeafSize / 2 points, so 2 * count nodes is an upper bound
+        m_nodes.reserve(2 * static_cast<size_t>(count));
+        m_nodes.emplace_back();
+        BuildNode(0, kInvalidIndex, 0, count);
+    }
+
+    void KeyframeBVH::Clear() {
+        m_points.clear();
+        m_nodes.clear();
+        m_order.clear();
+        m_leafOfPoint.clear();
+    }
+
+    void KeyframeBVH::BuildNode(uint32_t a_node, uint32_t a_parent, uint32_t a_begin, uint32_t a_end) {
+        RE::NiPoint3 min = m_points[m_order[a_begin]];
+        RE::NiPoint3 max = min;
+        for (uint32_t i = a_begin + 1; i < a_end; ++i) {
+            const auto& point = m_points[m_order[i]];
+            min = { std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z) };
+            max = { std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z) };
+        }
+
+        m_nodes[a_node].min = min;
+        m_nodes[a_node].max = max;
+        m_nodes[a_node].parent = a_parent;
+
+        if (a_end - a_begin <= kLeafSize) {
+            m_nodes[a_node].first = a_begin;
+            m_nodes[a_node].count = a_end - a_begin;
+            for (uint32_t i = a_begin; i < a_end; ++i) {
+                m_leafOfPoint[m_order[i]] = a_node;
+            }
+            return;
+        }
+
+        // Median split along the longest axis
+        const RE::NiPoint3 extent = max - min;
+        const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+        const uint32_t mid = a_begin + (a_end - a_begin) / 2;
+        std::nth_element(m_order.begin() + a_begin, m_order.begin() + mid, m_order.begin() + a_end, [this, axis](uint32_t a_lhs, uint32_t a_rhs) {
+            return m_points[a_lhs][axis] < m_points[a_rhs][axis];
+        });
+
+        const uint32_t left = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+        m_nodes.emplace_back();
+        m_nodes[a_node].first = left;
+        m_nodes[a_node].count = 0;
+        BuildNode(left, a_node, a_begin, mid);
+        BuildNode(left + 1, a_node, mid, a_end);
+    }
+
+    void KeyframeBVH::UpdateLeafBounds(Node& a_node) const {
+        a_node.min = a_node.max = m_points[m_order[a_node.first]];
+        for (uint32_t i = a_node.first + 1; i < a_node.first + a_node.count; ++i) {
+            const auto& point = m_points[m_order[i]];
+            a_node.min = { std::min(a_node.min.x, point.x), std::min(a_node.min.y, point.y), std::min(a_node.min.z, point.z) };
+            a_node.max = { std::max(a_node.max.x, point.x), std::max(a_node.max.y, point.y), std::max(a_node.max.z, point.z) };
+        }
+    }
+
+    void KeyframeBVH::Refit(uint32_t a_index, const RE::NiPoint3& a_position) {
+        if (a_index >= m_points.size()) {
+            return;
+        }
+
+        m_points[a_index] = a_position;
+        uint32_t nodeIndex = m_leafOfPoint[a_index];
+        UpdateLeafBounds(m_nodes[nodeIndex]);
+
+        for (nodeIndex = m_nodes[nodeIndex].parent; nodeIndex != kInvalidIndex; nodeIndex = m_nodes[nodeIndex].parent) {
+            Node& node = m_nodes[nodeIndex];
+            const Node& left = m_nodes[node.first];
+            const Node& right = m_nodes[node.first + 1];
+            const RE::NiPoint3 min = { std::min(left.min.x, right.min.x), std::min(left.min.y, right.min.y), std::min(left.min.z, right.min.z) };
+            const RE::NiPoint3 max = { std::max(left.max.x, right.max.x), std::max(left.max.y, right.max.y), std::max(left.max.z, right.max.z) };
+            if (min == node.min && max == node.max) {
+                break;  // nothing above changes either
+            }
+            node.min = min;
+            node.max = max;
+        }
+    }
+
+    uint32_t KeyframeBVH::PickRay(const RE::NiPoint3& a_origin, const RE::NiPoint3& a_direction, float a_maxAngle) const {
+        if (m_nodes.empty()) {
+            return kInvalidIndex;
+        }
+
+        // Compare tangents of the angle between the ray and the direction to a point
+        float bestTan = std::tan(a_maxAngle);
+        uint32_t best = kInvalidIndex;
+
+        std::array<uint32_t, 64> stack;
+        size_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            const Node& node = m_nodes[stack[--stackSize]];
+
+            // Every point in the node is at most this far away, so growing the box by the allowed
+            // offset at that distance covers all points within the angle
+            const float grow = bestTan * FarthestCornerDistance(a_origin, node.min, node.max);
+            const RE::NiPoint3 margin = { grow, grow, grow };
+            if (!RayIntersectsBox(a_origin, a_direction, node.min - margin, node.max + margin)) {
+                continue;
+            }
+
+            if (node.count == 0) {
+                if (stackSize + 2 <= stack.size()) {
+                    stack[stackSize++] = node.first;
+                    stack[stackSize++] = node.first + 1;
+                }
+                continue;
+            }
+
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                const RE::NiPoint3 toPoint = m_points[m_order[i]] - a_origin;
+                const float along = toPoint.Dot(a_direction);
+                if (along <= 0.f) {
+                    continue;
+                }
+                const float across = (toPoint - a_direction * along).Length();
+                const float tangent = across / along;
+                if (tangent < bestTan) {
+                    bestTan = tangent;
+                    best = m_order[i];
+                }
+            }
+        }
+        return best;
+    }
+
+    void KeyframeBVH::QueryRadius(const RE::NiPoint3& a_center, float a_radius, std::vector<uint32_t>& a_out) const {
+        a_out.clear();
+        if (m_nodes.empty()) {
+            return;
+        }
+
+        const float radiusSquared = a_radius * a_radius;
+        std::array<uint32_t, 64> stack;
+        size_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0) {
+            const Node& node = m_nodes[stack[--stackSize]];
+
+            const RE::NiPoint3 closest = {
+                std::clamp(a_center.x, node.min.x, node.max.x),
+                std::clamp(a_center.y, node.min.y, node.max.y),
+                std::clamp(a_center.z, node.min.z, node.max.z)
+            };
+            if ((closest - a_center).SqrLength() > radiusSquared) {
+                continue;
+            }
+
+            if (node.count == 0) {
+                if (stackSize + 2 <= stack.size()) {
+                    stack[stackSize++] = node.first;
+                    stack[stackSize++] = node.first + 1;
+                }
+                continue;
+            }
+
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                if ((m_points[m_order[i]] - a_center).SqrLength() <= radiusSquared) {
+                    a_out.push_back(m_order[i]);
+                }
+            }
+        }
+    }
+} // namespace FCSE
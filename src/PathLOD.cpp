@@ -0,0 +1,168 @@
+#include "PathLOD.h"
+#include "SplineEvaluator.h"
+
+namespace FCSE {
+
+    void PathLOD::Clear() {
+        m_runs.clear();
+        for (auto& points : m_levelPoints) {
+            points.clear();
+        }
+    }
+
+    void PathLOD::Build(std::span<const RE::NiPoint3> a_keyframes) {
+        Clear();
+
+        const size_t count = a_keyframes.size();
+        if (count < 2) {
+            return;
+        }
+
+        m_runs.reserve((count - 2) / kRunLength + 1);
+        for (size_t first = 0; first + 1 < count; first += kRunLength) {
+            Run run;
+            run.first = first;
+            run.last = std::min(first + kRunLength, count - 1);
+            BuildRun(run, a_keyframes, true);
+            m_runs.push_back(std::move(run));
+        }
+
+        log::debug("{}: Built {} runs for {} keyframes", __FUNCTION__, m_runs.size(), count);
+    }
+
+    void PathLOD::BuildRun(Run& a_run, std::span<const RE::NiPoint3> a_keyframes, bool a_append) {
+        const size_t count = a_keyframes.size();
+
+        // Level 1: keyframes, deviating from the Hermite curve by at most its hull flatness
+        RE::NiPoint3 boundsMin = a_keyframes[a_run.first];
+        RE::NiPoint3 boundsMax = boundsMin;
+        float hullError = 0.f;
+        for (size_t i = a_run.first; i < a_run.last; ++i) {
+            const RE::NiPoint3& p0 = a_keyframes[i > 0 ? i - 1 : i];
+            const RE::NiPoint3& p1 = a_keyframes[i];
+            const RE::NiPoint3& p2 = a_keyframes[i + 1];
+            const RE::NiPoint3& p3 = a_keyframes[i + 2 < count ? i + 2 : i + 1];
+            const RE::NiPoint3 c1 = p1 + (p2 - p0) * (0.5f / 3.f);
+            const RE::NiPoint3 c2 = p2 - (p3 - p1) * (0.5f / 3.f);
+            hullError = std::max({ hullError, detail::DistanceToLine(c1, p1, p2), detail::DistanceToLine(c2, p1, p2) });
+
+            boundsMin = RE::NiPoint3(std::min(boundsMin.x, p2.x), std::min(boundsMin.y, p2.y), std::min(boundsMin.z, p2.z));
+            boundsMax = RE::NiPoint3(std::max(boundsMax.x, p2.x), std::max(boundsMax.y, p2.y), std::max(boundsMax.z, p2.z));
+        }
+        a_run.center = (boundsMin + boundsMax) * 0.5f;
+        a_run.radius = boundsMin.GetDistance(boundsMax) * 0.5f + hullError;
+        a_run.levelError[1] = hullError;
+
+        // Levels >= 2: keep every 2^(level-1)-th keyframe plus the run end, until only the end points are left
+        uint32_t level = 2;
+        for (size_t stride = 2; level < kMaxLevels && stride < a_run.last - a_run.first + 1; stride *= 2, ++level) {
+            auto& points = m_levelPoints[level];
+            if (a_append) {
+                a_run.levelOffset[level] = static_cast<uint32_t>(points.size());
+            }
+
+            float decimationError = 0.f;
+            size_t out = a_run.levelOffset[level];
+            auto write = [&](const RE::NiPoint3& a_point) {
+                if (a_append) {
+                    points.push_back(a_point);
+                } else {
+                    points[out] = a_point;
+                }
+                ++out;
+            };
+            for (size_t i = a_run.first; i < a_run.last; i += stride) {
+                const size_t next = std::min(i + stride, a_run.last);
+                for (size_t skipped = i + 1; skipped < next; ++skipped) {
+                    decimationError = std::max(decimationError, detail::DistanceToLine(a_keyframes[skipped], a_keyframes[i], a_keyframes[next]));
+                }
+                write(a_keyframes[i]);
+            }
+            write(a_keyframes[a_run.last]);
+
+            a_run.levelSize[level] = static_cast<uint32_t>(out) - a_run.levelOffset[level];
+            a_run.levelError[level] = decimationError + hullError;
+        }
+        a_run.levelCount = level;
+    }
+
+    void PathLOD::UpdateKeyframe(std::span<const RE::NiPoint3> a_keyframes, size_t a_index) {
+        if (m_runs.empty() || a_index >= a_keyframes.size()) {
+            return;
+        }
+
+        // Hermite segment i depends on keyframes i - 1 to i + 2, so segments a_index - 2 to a_index + 1 change.
+        // Run r covers segments [r * kRunLength, (r + 1) * kRunLength).
+        const size_t firstSegment = a_index >= 2 ? a_index - 2 : 0;
+        const size_t lastSegment = std::min(a_index + 1, a_keyframes.size() - 2);
+        for (size_t r = firstSegment / kRunLength; r <= lastSegment / kRunLength && r < m_runs.size(); ++r) {
+            Run& run = m_runs[r];
+            BuildRun(run, a_keyframes, false);
+            run.isTessellated = false;
+            ++run.revision;
+        }
+    }
+
+    bool PathLOD::GetVisibleRun(size_t a_runIndex, std::span<const RE::NiPoint3> a_keyframes, const ViewFrustum& a_frustum,
+                                float a_tolerancePixels, RunView& a_view) {
+        Run& run = m_runs[a_runIndex];
+        if (!a_frustum.IsSphereVisible(run.center, run.radius)) {
+            return false;
+        }
+
+        const float distance = std::max(run.center.GetDistance(a_frustum.GetPosition()) - run.radius, kMinDistance);
+        const float allowedError = a_frustum.GetWorldError(a_tolerancePixels, distance);
+
+        // Coarsest level that is still within tolerance; levelError grows with the level
+        uint32_t level = run.levelCount;
+        while (level > 1 && run.levelError[level - 1] > allowedError) {
+            --level;
+        }
+        --level;
+
+        a_view.index = a_runIndex;
+        a_view.first = run.first;
+        a_view.level = level;
+        a_view.revision = run.revision;
+        a_view.keyframes = a_keyframes.subspan(run.first, run.last - run.first + 1);
+        if (level == 0) {
+            Tessellate(run, a_keyframes, a_frustum, a_tolerancePixels);
+            a_view.generation = run.tessellationGeneration;
+            a_view.polyline = run.tessellation;
+        } else if (level == 1) {
+            a_view.polyline = a_view.keyframes;
+        } else {
+            a_view.polyline = std::span<const RE::NiPoint3>(m_levelPoints[level]).subspan(run.levelOffset[level], run.levelSize[level]);
+        }
+        return true;
+    }
+
+    void PathLOD::Tessellate(Run& a_run, std::span<const RE::NiPoint3> a_keyframes, const ViewFrustum& a_frustum, float a_tolerancePixels) {
+        const RE::NiPoint3& cameraPosition = a_frustum.GetPosition();
+        if (a_run.isTessellated) {
+            // Screen-space error scales with distance, so only re-tessellate once the camera moved by a fraction of it
+            const float distance = std::max(a_run.center.GetDistance(cameraPosition) - a_run.radius, kMinDistance);
+            if (cameraPosition.GetDistance(a_run.tessellationOrigin) < 0.25f * distance) {
+                return;
+            }
+        }
+
+        TessellationParams params;
+        params.cameraPosition = cameraPosition;
+        params.pixelsPerRadian = a_frustum.GetPixelsPerRadian();
+        params.tolerancePixels = a_tolerancePixels;
+        params.minDistance = kMinDistance;
+
+        // Tessellate including one neighbour on each side so the run's tangents match the full path
+        const size_t count = a_keyframes.size();
+        a_run.tessellation.clear();
+        a_run.tessellation.push_back(a_keyframes[a_run.first]);
+        for (size_t i = a_run.first; i < a_run.last; ++i) {
+            TessellateSegment<InterpolationMode::kCubicHermite>(a_keyframes[i > 0 ? i - 1 : i], a_keyframes[i], a_keyframes[i + 1],
+                                                                a_keyframes[i + 2 < count ? i + 2 : i + 1], params, a_run.tessellation);
+        }
+        a_run.tessellationOrigin = cameraPosition;
+        ++a_run.tessellationGeneration;
+        a_run.isTessellated = true;
+    }
+} // namespace FCSE
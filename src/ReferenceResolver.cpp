@@ -0,0 +1,130 @@
+#include "ReferenceResolver.h"
+#include "Offsets.h"
+
+namespace FCSE {
+
+    void ReferenceResolver::Register() {
+        if (m_isRegistered) {
+            return;
+        }
+
+        auto* eventSource = RE::ScriptEventSourceHolder::GetSingleton();
+        if (!eventSource) {
+            log::warn("{}: ScriptEventSourceHolder not available, cached nodes are only checked against their 3D root", __FUNCTION__);
+            return;
+        }
+        eventSource->AddEventSink<RE::TESCellAttachDetachEvent>(this);
+        eventSource->AddEventSink<RE::TESObjectLoadedEvent>(this);
+        m_isRegistered = true;
+    }
+
+    RE::TESObjectREFR* ReferenceResolver::GetReference(RE::FormID a_formID) {
+        if (a_formID == 0) {
+            return nullptr;
+        }
+
+        std::scoped_lock lock(m_mutex);
+        if (auto it = m_references.find(a_formID); it != m_references.end()) {
+            if (auto reference = it->second.get()) {
+                return reference.get();
+            }
+            m_references.erase(it);
+        }
+
+        auto* reference = RE::TESForm::LookupByID<RE::TESObjectREFR>(a_formID);
+        if (reference) {
+            m_references.emplace(a_formID, reference->GetHandle());
+        }
+        return reference;
+    }
+
+    RE::NiPointer<RE::NiAVObject> ReferenceResolver::GetBodyPartNode(RE::FormID a_formID, RE::BGSBodyPartDefs::LIMB_ENUM a_part) {
+        return GetNode({ .formID = a_formID, .part = static_cast<uint32_t>(a_part) }, nullptr);
+    }
+
+    RE::NiPointer<RE::NiAVObject> ReferenceResolver::GetBoneNode(RE::FormID a_formID, const RE::BSFixedString& a_name) {
+        if (a_name.empty()) {
+            return nullptr;
+        }
+        return GetNode({ .formID = a_formID, .name = a_name.c_str() }, &a_name);
+    }
+
+    RE::NiPointer<RE::NiAVObject> ReferenceResolver::GetNode(const NodeKey& a_key, const RE::BSFixedString* a_name) {
+        auto* reference = GetReference(a_key.formID);
+        if (!reference) {
+            return nullptr;
+        }
+        auto* root = reference->Get3D2();
+        if (!root) {
+            return nullptr;
+        }
+
+        std::scoped_lock lock(m_mutex);
+        auto it = m_nodes.find(a_key);
+        if (it != m_nodes.end() && it->second.root == root) {
+            return it->second.node;
+        }
+
+        // Not looked up yet, or the 3D was replaced without an event reaching us
+        RE::NiPointer<RE::NiAVObject> node(FindNode(reference, root, a_key, a_name));
+        if (it != m_nodes.end()) {
+            m_nodes.erase(it);
+        } else if (node) {
+            m_nodeKeys.emplace(a_key.formID, a_key);
+        }
+        if (node) {
+            m_nodes.emplace(a_key, NodeEntry{ node, root });
+        }
+        return node;
+    }
+
+    RE::NiAVObject* ReferenceResolver::FindNode(RE::TESObjectREFR* a_reference, RE::NiAVObject* a_root, const NodeKey& a_key, const RE::BSFixedString* a_name) {
+        if (a_key.part == kNoPart) {
+            return a_name ? NiAVObject_LookupBoneNodeByName(a_root, *a_name, true) : nullptr;
+        }
+
+        auto* actor = a_reference->As<RE::Actor>();
+        auto* race = actor ? actor->GetRace() : nullptr;
+        RE::BGSBodyPartData* bodyPartData = race ? race->bodyPartData : nullptr;
+        if (!bodyPartData || a_key.part >= RE::BGSBodyPartDefs::LIMB_ENUM::kTotal) {
+            return nullptr;
+        }
+
+        RE::BGSBodyPart* bodyPart = bodyPartData->parts[a_key.part];
+        if (!bodyPart) {
+            bodyPart = bodyPartData->parts[RE::BGSBodyPartDefs::LIMB_ENUM::kTotal];
+        }
+        return bodyPart ? NiAVObject_LookupBoneNodeByName(a_root, bodyPart->targetName, true) : nullptr;
+    }
+
+    void ReferenceResolver::Invalidate(RE::FormID a_formID) {
+        std::scoped_lock lock(m_mutex);
+        m_references.erase(a_formID);
+        auto [first, last] = m_nodeKeys.equal_range(a_formID);
+        for (auto it = first; it != last; ++it) {
+            m_nodes.erase(it->second);
+        }
+        m_nodeKeys.erase(first, last);
+    }
+
+    void ReferenceResolver::Clear() {
+        std::scoped_lock lock(m_mutex);
+        m_references.clear();
+        m_nodes.clear();
+        m_nodeKeys.clear();
+    }
+
+    RE::BSEventNotifyControl ReferenceResolver::ProcessEvent(const RE::TESCellAttachDetachEvent* a_event, RE::BSTEventSource<RE::TESCellAttachDetachEvent>*) {
+        if (a_event && a_event->reference) {
+            Invalidate(a_event->reference->GetFormID());
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    RE::BSEventNotifyControl ReferenceResolver::ProcessEvent(const RE::TESObjectLoadedEvent* a_event, RE::BSTEventSource<RE::TESObjectLoadedEvent>*) {
+        if (a_event) {
+            Invalidate(a_event->formID);
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
+} // namespace FCSE
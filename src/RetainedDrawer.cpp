@@ -0,0 +1,33 @@
+#include "RetainedDrawer.h"
+
+namespace FCSE {
+
+    void RetainedDrawer::BeginFrame() {
+        using namespace std::chrono;
+        m_now = duration<double>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool RetainedDrawer::NeedsSubmit(uint64_t a_key, uint64_t a_version) const {
+        auto it = m_entries.find(a_key);
+        if (it == m_entries.end()) {
+            return true;
+        }
+        return it->second.version != a_version || it->second.expiry - m_now < kRenewMargin;
+    }
+
+    float RetainedDrawer::GetLifetime(uint64_t a_key, uint64_t a_version) const {
+        // Groups drawn immediately are recorded with their version, so the frame after a change finds it unchanged
+        auto it = m_entries.find(a_key);
+        return it != m_entries.end() && it->second.version == a_version ? kLifetime : kImmediate;
+    }
+
+    void RetainedDrawer::Clear() {
+        m_entries.clear();
+    }
+
+    void RetainedDrawer::Prune() {
+        std::erase_if(m_entries, [this](const auto& a_entry) {
+            return a_entry.second.expiry < m_now;
+        });
+    }
+} // namespace FCSE
@@ -0,0 +1,61 @@
+#include "RotationGizmos.h"
+#include "SplineEvaluator.h"
+#include "APIManager.h"
+
+namespace FCSE {
+
+    void RotationGizmos::Rebuild(size_t a_timelineID, int a_rotationCount, std::span<const RE::NiPoint3> a_translationPoints, const TimelineScrubber& a_scrubber,
+                                 std::span<const float> a_rotationTimes, uint32_t a_pathVersion) {
+        m_instances.clear();
+        m_rotationCount = a_rotationCount;
+        m_pathVersion = a_pathVersion;
+        m_isValid = true;
+        ++m_version;
+
+        if (!APIs::FCFW || a_rotationCount <= 0 || a_translationPoints.empty()) {
+            return;
+        }
+
+        // FCFW does not expose keyframe times, so unless the model knows them rotation keyframes are spread over the path
+        // by their index
+        auto handle = SKSE::GetPluginHandle();
+        const size_t count = static_cast<size_t>(a_rotationCount);
+        const bool hasTimes = a_rotationTimes.size() == count && !a_scrubber.IsEmpty();
+        const float lastSegment = static_cast<float>(a_translationPoints.size() - 1);
+        m_instances.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            const RE::BSTPoint2<float> rotation = APIs::FCFW->GetRotationPoint(handle, a_timelineID, i);
+
+            Instance instance;
+            TimelineScrubber::Sample sample;
+            if (hasTimes && a_scrubber.Evaluate(a_rotationTimes[i], sample)) {
+                instance.position = sample.position;
+            } else {
+                const float u = count > 1 ? lastSegment * static_cast<float>(i) / static_cast<float>(count - 1) : 0.f;
+                const size_t segment = static_cast<size_t>(u);
+                instance.position = EvaluatePath(a_translationPoints, {}, segment, u - static_cast<float>(segment), false, false);
+            }
+            instance.direction = ViewFrustum::GetDirection(rotation.x, rotation.y);
+            m_instances.push_back(instance);
+        }
+
+        log::debug("{}: Cached {} rotation gizmos for timeline {}", __FUNCTION__, m_instances.size(), a_timelineID);
+    }
+
+    void RotationGizmos::GetVisible(const ViewFrustum& a_frustum, size_t a_maxCount, std::vector<uint32_t>& a_out) const {
+        a_out.clear();
+        for (uint32_t i = 0; i < m_instances.size(); ++i) {
+            if (a_frustum.IsSphereVisible(m_instances[i].position, kArrowLength)) {
+                a_out.push_back(i);
+            }
+        }
+
+        if (a_out.size() > a_maxCount) {
+            const RE::NiPoint3& cameraPosition = a_frustum.GetPosition();
+            std::nth_element(a_out.begin(), a_out.begin() + a_maxCount, a_out.end(), [&](uint32_t a_lhs, uint32_t a_rhs) {
+                return m_instances[a_lhs].position.GetSquaredDistance(cameraPosition) < m_instances[a_rhs].position.GetSquaredDistance(cameraPosition);
+            });
+            a_out.resize(a_maxCount);
+        }
+    }
+} // namespace FCSE
@@ -0,0 +1,365 @@
+#include "TakeLibrary.h"
+#include "_ts_SKSEFunctions.h"
+
+namespace FCSE {
+
+    namespace {
+        template <class T>
+        void Append(std::vector<std::byte>& a_buffer, const T& a_value) {
+            const auto bytes = std::as_bytes(std::span(&a_value, 1));
+            a_buffer.insert(a_buffer.end(), bytes.begin(), bytes.end());
+        }
+
+        void AppendPoint(std::vector<std::byte>& a_buffer, const RE::NiPoint3& a_point) {
+            Append(a_buffer, a_point.x);
+            Append(a_buffer, a_point.y);
+            Append(a_buffer, a_point.z);
+        }
+
+        // Bounds-checked reads from the index file
+        class IndexReader {
+        public:
+            explicit IndexReader(std::span<const std::byte> a_bytes) : m_bytes(a_bytes) {}
+
+            template <class T>
+            bool Read(T& a_out) {
+                if (m_bytes.size() - m_offset < sizeof(T)) {
+                    return false;
+                }
+                std::memcpy(&a_out, m_bytes.data() + m_offset, sizeof(T));
+                m_offset += sizeof(T);
+                return true;
+            }
+
+            bool ReadPoint(RE::NiPoint3& a_out) { return Read(a_out.x) && Read(a_out.y) && Read(a_out.z); }
+
+            bool ReadString(size_t a_length, std::string& a_out) {
+                if (m_bytes.size() - m_offset < a_length) {
+                    return false;
+                }
+                a_out.assign(reinterpret_cast<const char*>(m_bytes.data() + m_offset), a_length);
+                m_offset += a_length;
+                return true;
+            }
+
+        private:
+            std::span<const std::byte> m_bytes;
+            size_t m_offset = 0;
+        };
+
+        // Polyline points are stored as 16-bit fractions of the bounds
+        uint16_t QuantizeCoordinate(float a_value, float a_low, float a_high) {
+            if (!(a_high > a_low)) {
+                return 0;
+            }
+            const float fraction = std::clamp((a_value - a_low) / (a_high - a_low), 0.f, 1.f);
+            return static_cast<uint16_t>(std::lround(fraction * 65535.f));
+        }
+
+        float DequantizeCoordinate(uint16_t a_value, float a_low, float a_high) {
+            return a_low + (a_high - a_low) * (static_cast<float>(a_value) / 65535.f);
+        }
+    }
+
+    std::string_view TakeSummary::GetName() const {
+        const size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string_view(path) : std::string_view(path).substr(slash + 1);
+    }
+
+    TimelinePreview TakeSummary::GetPreview() const {
+        TimelinePreview preview;
+        preview.points = polyline;
+        preview.times = polylineTimes;
+        preview.boundsMin = boundsMin;
+        preview.boundsMax = boundsMax;
+        return preview;
+    }
+
+    void TakeLibrary::LoadSettings(const char* a_iniPath) {
+        std::string folder = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, "Folder:TakeLibrary", a_iniPath, m_folder);
+        while (!folder.empty() && (folder.back() == '/' || folder.back() == '\\')) {
+            folder.pop_back();
+        }
+        if (folder.empty()) {
+            log::warn("{}: Take library folder in INI file is empty. Using {}.", __FUNCTION__, m_folder);
+            return;
+        }
+
+        m_folder = std::move(folder);
+        log::info("{}: Take library folder: Data/{}", __FUNCTION__, m_folder);
+    }
+
+    std::string TakeLibrary::GetIndexPath() const {
+        return m_folder + "/" + std::string(kIndexFileName);
+    }
+
+    void TakeLibrary::StartScan() {
+        m_isRescanRequested.store(true, std::memory_order_release);
+        if (m_isScanning.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+
+        std::thread([this, folder = m_folder, indexPath = GetIndexPath()]() {
+            // Requests that arrive while a scan runs are served by one more scan
+            for (;;) {
+                m_isRescanRequested.store(false, std::memory_order_release);
+                const auto start = std::chrono::steady_clock::now();
+
+                // The first scan of a session takes the known summaries from the index file
+                std::shared_ptr<const Entries> known = GetEntries();
+                if (known->empty()) {
+                    auto loaded = std::make_shared<Entries>();
+                    if (ReadIndex(indexPath, *loaded)) {
+                        known = std::move(loaded);
+                    }
+                }
+
+                Entries entries = Scan(folder, *known);
+                const bool isUnchanged = std::ranges::equal(entries, *known, [](const TakeSummary& a_lhs, const TakeSummary& a_rhs) {
+                    return a_lhs.path == a_rhs.path && a_lhs.fileSize == a_rhs.fileSize && a_lhs.writeTime == a_rhs.writeTime;
+                });
+                if (!isUnchanged && !WriteIndex(indexPath, entries)) {
+                    log::warn("StartScan: Could not write the take index {}", indexPath);
+                }
+
+                const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+                log::info("StartScan: Indexed {} files in Data/{} in {} ms{}", entries.size(), folder, elapsed.count(), isUnchanged ? " (unchanged)" : "");
+                m_entries.store(std::make_shared<const Entries>(std::move(entries)), std::memory_order_release);
+
+                m_isScanning.store(false, std::memory_order_release);
+                if (!m_isRescanRequested.load(std::memory_order_acquire) || m_isScanning.exchange(true, std::memory_order_acq_rel)) {
+                    break;
+                }
+            }
+        }).detach();
+    }
+
+    TakeLibrary::Entries TakeLibrary::Scan(const std::string& a_folder, const Entries& a_known) {
+        std::unordered_map<std::string_view, const TakeSummary*> known;
+        known.reserve(a_known.size());
+        for (const auto& summary : a_known) {
+            known.emplace(summary.path, &summary);
+        }
+
+        Entries entries;
+        std::error_code error;
+        const auto root = TimelineFile::GetFullPath(a_folder);
+        size_t summarized = 0;
+        for (auto it = std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied, error);
+             !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+            std::error_code statError;
+            if (!it->is_regular_file(statError)) {
+                continue;
+            }
+
+            const auto& fullPath = it->path();
+            const auto extension = fullPath.extension();
+            const bool isBinary = extension == TimelineFile::kBinaryExtension;
+            if (!isBinary && extension != ".yaml") {
+                continue;
+            }
+            // A binary file next to a YAML file is a copy of it, see Summarize
+            if (isBinary && std::filesystem::exists(std::filesystem::path(fullPath).replace_extension(".yaml"), statError)) {
+                continue;
+            }
+
+            const uint64_t size = it->file_size(statError);
+            const int64_t writeTime = it->last_write_time(statError).time_since_epoch().count();
+            if (statError) {
+                continue;
+            }
+
+            std::string path = a_folder + "/" + fullPath.lexically_relative(root).generic_string();
+            if (auto knownIt = known.find(path); knownIt != known.end() && knownIt->second->fileSize == size && knownIt->second->writeTime == writeTime) {
+                entries.push_back(*knownIt->second);
+                continue;
+            }
+
+            // Files without keyframes, such as other plugins' settings, stay in the index so they are not read again
+            TakeSummary summary;
+            summary.path = std::move(path);
+            summary.fileSize = size;
+            summary.writeTime = writeTime;
+            Summarize(summary.path, summary);
+            entries.push_back(std::move(summary));
+            ++summarized;
+        }
+        if (error) {
+            log::warn("{}: Could not list Data/{}: {}", __FUNCTION__, a_folder, error.message());
+        }
+
+        std::ranges::sort(entries, {}, &TakeSummary::path);
+        log::debug("{}: Read {} of {} files", __FUNCTION__, summarized, entries.size());
+        return entries;
+    }
+
+    bool TakeLibrary::Summarize(std::string_view a_path, TakeSummary& a_out) {
+        // The binary copy needs no parsing, so it is read instead of the YAML file while it is up to date
+        TimelineData data;
+        const std::string binaryPath = TimelineFile::GetBinaryPath(a_path);
+        const bool useBinary = !TimelineFile::IsBinaryPath(a_path) && TimelineFile::IsUpToDate(binaryPath, a_path);
+        if (!(useBinary ? TimelineFile::ReadBinary(binaryPath, data) : TimelineFile::Read(a_path, data))) {
+            return false;
+        }
+
+        a_out.translationCount = static_cast<uint32_t>(data.translations.size());
+        a_out.rotationCount = static_cast<uint32_t>(data.rotations.size());
+        a_out.duration = std::max(data.translations.empty() ? 0.f : data.translations.back().time, data.rotations.empty() ? 0.f : data.rotations.back().time);
+        if (!data.rotations.empty()) {
+            a_out.startRotation = data.rotations.front().value;
+            a_out.endRotation = data.rotations.back().value;
+        }
+
+        std::vector<RE::NiPoint3> points;
+        std::vector<float> times;
+        points.reserve(data.translations.size());
+        times.reserve(data.translations.size());
+        for (const auto& keyframe : data.translations) {
+            if (keyframe.reference == 0 && !(keyframe.flags & kKeyframeAtCamera)) {
+                points.emplace_back(keyframe.value[0], keyframe.value[1], keyframe.value[2]);
+                times.push_back(keyframe.time);
+            }
+        }
+        if (points.empty()) {
+            return true;
+        }
+
+        a_out.startPosition = points.front();
+        a_out.endPosition = points.back();
+        a_out.boundsMin = a_out.boundsMax = points.front();
+        for (const auto& point : points) {
+            a_out.boundsMin = { std::min(a_out.boundsMin.x, point.x), std::min(a_out.boundsMin.y, point.y), std::min(a_out.boundsMin.z, point.z) };
+            a_out.boundsMax = { std::max(a_out.boundsMax.x, point.x), std::max(a_out.boundsMax.y, point.y), std::max(a_out.boundsMax.z, point.z) };
+        }
+
+        const size_t count = std::min(points.size(), TakeSummary::kPolylinePoints);
+        a_out.polyline.reserve(count);
+        a_out.polylineTimes.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            const size_t index = count == 1 ? 0 : i * (points.size() - 1) / (count - 1);
+            a_out.polyline.push_back(points[index]);
+            a_out.polylineTimes.push_back(times[index]);
+        }
+        return true;
+    }
+
+    bool TakeLibrary::ReadIndex(std::string_view a_path, Entries& a_out) {
+        a_out.clear();
+        MappedFile file;
+        if (!file.Open(TimelineFile::GetFullPath(a_path))) {
+            return false;
+        }
+
+        const auto bytes = file.GetBytes();
+        IndexHeader header;
+        IndexReader headerReader(bytes);
+        if (!headerReader.Read(header) || header.magic != kIndexMagic || header.version != kIndexVersion ||
+            TimelineFile::ComputeChecksum(bytes.subspan(sizeof(IndexHeader))) != header.checksum) {
+            log::info("{}: Ignoring outdated or damaged take index {}", __FUNCTION__, a_path);
+            return false;
+        }
+
+        IndexReader reader(bytes.subspan(sizeof(IndexHeader)));
+        a_out.reserve(header.entryCount);
+        for (uint32_t i = 0; i < header.entryCount; ++i) {
+            TakeSummary summary;
+            uint16_t pathLength = 0;
+            uint16_t polylineCount = 0;
+            if (!reader.Read(pathLength) || !reader.ReadString(pathLength, summary.path) || !reader.Read(summary.fileSize) ||
+                !reader.Read(summary.writeTime) || !reader.Read(summary.translationCount) || !reader.Read(summary.rotationCount) ||
+                !reader.Read(summary.duration) || !reader.ReadPoint(summary.boundsMin) || !reader.ReadPoint(summary.boundsMax) ||
+                !reader.ReadPoint(summary.startPosition) || !reader.ReadPoint(summary.endPosition) || !reader.Read(summary.startRotation) ||
+                !reader.Read(summary.endRotation) || !reader.Read(polylineCount) || polylineCount > TakeSummary::kPolylinePoints) {
+                a_out.clear();
+                return false;
+            }
+
+            summary.polyline.reserve(polylineCount);
+            summary.polylineTimes.resize(polylineCount);
+            for (uint16_t point = 0; point < polylineCount; ++point) {
+                std::array<uint16_t, 3> quantized;
+                if (!reader.Read(summary.polylineTimes[point]) || !reader.Read(quantized)) {
+                    a_out.clear();
+                    return false;
+                }
+                summary.polyline.emplace_back(DequantizeCoordinate(quantized[0], summary.boundsMin.x, summary.boundsMax.x),
+                                              DequantizeCoordinate(quantized[1], summary.boundsMin.y, summary.boundsMax.y),
+                                              DequantizeCoordinate(quantized[2], summary.boundsMin.z, summary.boundsMax.z));
+            }
+            a_out.push_back(std::move(summary));
+        }
+        return true;
+    }
+
+    bool TakeLibrary::WriteIndex(std::string_view a_path, const Entries& a_entries) {
+        std::vector<std::byte> buffer(sizeof(IndexHeader));
+        for (const auto& summary : a_entries) {
+            const auto pathLength = static_cast<uint16_t>(std::min<size_t>(summary.path.size(), std::numeric_limits<uint16_t>::max()));
+            Append(buffer, pathLength);
+            const auto path = std::as_bytes(std::span(summary.path.data(), pathLength));
+            buffer.insert(buffer.end(), path.begin(), path.end());
+            Append(buffer, summary.fileSize);
+            Append(buffer, summary.writeTime);
+            Append(buffer, summary.translationCount);
+            Append(buffer, summary.rotationCount);
+            Append(buffer, summary.duration);
+            AppendPoint(buffer, summary.boundsMin);
+            AppendPoint(buffer, summary.boundsMax);
+            AppendPoint(buffer, summary.startPosition);
+            AppendPoint(buffer, summary.endPosition);
+            Append(buffer, summary.startRotation);
+            Append(buffer, summary.endRotation);
+            Append(buffer, static_cast<uint16_t>(summary.polyline.size()));
+            for (size_t point = 0; point < summary.polyline.size(); ++point) {
+                Append(buffer, summary.polylineTimes[point]);
+                Append(buffer, std::array<uint16_t, 3>{ QuantizeCoordinate(summary.polyline[point].x, summary.boundsMin.x, summary.boundsMax.x),
+                                                        QuantizeCoordinate(summary.polyline[point].y, summary.boundsMin.y, summary.boundsMax.y),
+                                                        QuantizeCoordinate(summary.polyline[point].z, summary.boundsMin.z, summary.boundsMax.z) });
+            }
+        }
+
+        IndexHeader header;
+        header.entryCount = static_cast<uint32_t>(a_entries.size());
+        header.checksum = TimelineFile::ComputeChecksum(std::span(buffer).subspan(sizeof(IndexHeader)));
+        std::memcpy(buffer.data(), &header, sizeof(header));
+        return TimelineFile::ReplaceFile(a_path, buffer);
+    }
+
+    std::shared_ptr<const TakeSummary> TakeLibrary::Select(int a_step) {
+        const auto entries = GetEntries();
+        const size_t count = entries->size();
+        if (count == 0 || a_step == 0) {
+            return GetSelected();
+        }
+
+        // Without a selection the first step lands on the first or last take
+        auto it = std::ranges::lower_bound(*entries, m_selectedPath, {}, &TakeSummary::path);
+        size_t index = it != entries->end() && it->path == m_selectedPath ? static_cast<size_t>(it - entries->begin()) : (a_step > 0 ? count - 1 : 0);
+        const auto hasKeyframes = [](const TakeSummary& a_summary) { return a_summary.translationCount + a_summary.rotationCount > 0; };
+        const size_t takeCount = static_cast<size_t>(std::ranges::count_if(*entries, hasKeyframes));
+        if (takeCount == 0) {
+            return nullptr;
+        }
+
+        // Whole laps over the takes are skipped, but at least one step is taken
+        const size_t step = a_step > 0 ? 1 : count - 1;
+        size_t remaining = (static_cast<size_t>(std::abs(static_cast<int64_t>(a_step))) - 1) % takeCount + 1;
+        while (true) {
+            index = (index + step) % count;
+            if (hasKeyframes((*entries)[index]) && --remaining == 0) {
+                break;
+            }
+        }
+        m_selectedPath = (*entries)[index].path;
+        return std::shared_ptr<const TakeSummary>(entries, &(*entries)[index]);
+    }
+
+    std::shared_ptr<const TakeSummary> TakeLibrary::GetSelected() const {
+        const auto entries = GetEntries();
+        auto it = std::ranges::lower_bound(*entries, m_selectedPath, {}, &TakeSummary::path);
+        if (m_selectedPath.empty() || it == entries->end() || it->path != m_selectedPath) {
+            return nullptr;
+        }
+        return std::shared_ptr<const TakeSummary>(entries, &*it);
+    }
+} // namespace FCSE
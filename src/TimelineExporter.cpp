@@ -0,0 +1,66 @@
+#include "TimelineExporter.h"
+
+namespace FCSE {
+
+    void TimelineExporter::Export(TimelineModel::Snapshot a_snapshot, std::string a_binaryPath, Callback a_onDone) {
+        Queue({ std::move(a_snapshot), {}, std::move(a_binaryPath), std::move(a_onDone) });
+    }
+
+    void TimelineExporter::Convert(std::string a_yamlPath, std::string a_binaryPath, Callback a_onDone) {
+        Queue({ {}, std::move(a_yamlPath), std::move(a_binaryPath), std::move(a_onDone) });
+    }
+
+    void TimelineExporter::Queue(Job a_job) {
+        {
+            std::scoped_lock lock(m_mutex);
+            m_jobs.push_back(std::move(a_job));
+            m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+
+            // The worker lives as long as the game; it only waits on the condition variable while there is nothing to write
+            if (!m_isWorkerStarted) {
+                std::thread([this]() { Run(); }).detach();
+                m_isWorkerStarted = true;
+            }
+        }
+        m_condition.notify_one();
+    }
+
+    void TimelineExporter::Run() {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock lock(m_mutex);
+                m_condition.wait(lock, [this]() { return !m_jobs.empty(); });
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            const bool succeeded = Write(job);
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            if (job.yamlPath.empty()) {
+                log::info("{}: Wrote {} translation and {} rotation keyframes to {} in {} ms{}", __FUNCTION__, job.snapshot.translations.size(),
+                          job.snapshot.rotations.size(), job.binaryPath, elapsed.count(), succeeded ? "" : " (failed)");
+            } else {
+                log::info("{}: Converted {} to {} in {} ms{}", __FUNCTION__, job.yamlPath, job.binaryPath, elapsed.count(), succeeded ? "" : " (failed)");
+            }
+
+            // Drop the chunk references here, so the model does not copy chunks it edits while the callback is queued
+            job.snapshot = {};
+            m_pendingCount.fetch_sub(1, std::memory_order_relaxed);
+
+            if (job.onDone) {
+                if (auto* tasks = SKSE::GetTaskInterface()) {
+                    tasks->AddTask([onDone = std::move(job.onDone), succeeded]() { onDone(succeeded); });
+                }
+            }
+        }
+    }
+
+    bool TimelineExporter::Write(const Job& a_job) {
+        if (!a_job.yamlPath.empty()) {
+            return TimelineFile::ConvertYamlToBinary(a_job.yamlPath, a_job.binaryPath);
+        }
+        return TimelineFile::WriteBinary(a_job.binaryPath, TimelineData::FromSnapshot(a_job.snapshot));
+    }
+} // namespace FCSE
@@ -0,0 +1,748 @@
+#include "TimelineFile.h"
+
+#include <charconv>
+#include <fstream>
+
+#ifndef _WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace FCSE {
+
+    static_assert(std::endian::native == std::endian::little, "the binary timeline format is little-endian");
+    static_assert(sizeof(TimelineFile::Header) == 24 && sizeof(TimelineFile::ChunkEntry) == 24);
+
+    namespace {
+        // CRC-32 tables for slicing-by-8, which processes eight bytes per step
+        constexpr std::array<std::array<uint32_t, 256>, 8> MakeCrcTables() {
+            std::array<std::array<uint32_t, 256>, 8> tables{};
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320u : 0u);
+                }
+                tables[0][i] = crc;
+            }
+            for (size_t slice = 1; slice < 8; ++slice) {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    const uint32_t previous = tables[slice - 1][i];
+                    tables[slice][i] = (previous >> 8) ^ tables[0][previous & 0xFF];
+                }
+            }
+            return tables;
+        }
+
+        constexpr std::array<std::array<uint32_t, 256>, 8> kCrcTables = MakeCrcTables();
+
+        std::string_view Trim(std::string_view a_text) {
+            const size_t first = a_text.find_first_not_of(" \t\r");
+            if (first == std::string_view::npos) {
+                return {};
+            }
+            const size_t last = a_text.find_last_not_of(" \t\r");
+            return a_text.substr(first, last - first + 1);
+        }
+
+        // Cuts the comment off a line. As in YAML, '#' only starts one at the line start or after a space or tab, and
+        // not inside a quoted value; a quote only opens a value at the line start or after a space, tab, '{', '[' or ','.
+        std::string_view StripComment(std::string_view a_line) {
+            if (a_line.find('#') == std::string_view::npos) {
+                return a_line;
+            }
+
+            char quote = 0;
+            for (size_t i = 0; i < a_line.size(); ++i) {
+                const char c = a_line[i];
+                const char previous = i > 0 ? a_line[i - 1] : ' ';
+                if (quote != 0) {
+                    if (quote == '"' && c == '\\') {
+                        ++i;  // escaped character, including \"
+                    } else if (c == quote) {
+                        quote = 0;
+                    }
+                } else if ((c == '"' || c == '\'') && (previous == ' ' || previous == '\t' || previous == '{' || previous == '[' || previous == ',')) {
+                    quote = c;
+                } else if (c == '#' && (previous == ' ' || previous == '\t')) {
+                    return a_line.substr(0, i);
+                }
+            }
+            return a_line;
+        }
+
+        bool ParseFloat(std::string_view a_text, float& a_out) {
+            a_text = Trim(a_text);
+            if (!a_text.empty() && a_text.front() == '+') {
+                a_text.remove_prefix(1);
+            }
+            const auto result = std::from_chars(a_text.data(), a_text.data() + a_text.size(), a_out);
+            return result.ec == std::errc();
+        }
+
+        bool ParseBool(std::string_view a_text) {
+            a_text = Trim(a_text);
+            return a_text == "true" || a_text == "True" || a_text == "1";
+        }
+
+        RE::FormID ParseFormID(std::string_view a_text) {
+            a_text = Trim(a_text);
+            int base = 10;
+            if (a_text.starts_with("0x") || a_text.starts_with("0X")) {
+                a_text.remove_prefix(2);
+                base = 16;
+            }
+            RE::FormID formID = 0;
+            std::from_chars(a_text.data(), a_text.data() + a_text.size(), formID, base);
+            return formID;
+        }
+
+        InterpolationMode ParseMode(std::string_view a_text) {
+            a_text = Trim(a_text);
+            if (a_text == "none" || a_text == "0") {
+                return InterpolationMode::kNone;
+            }
+            if (a_text == "linear" || a_text == "1") {
+                return InterpolationMode::kLinear;
+            }
+            return InterpolationMode::kCubicHermite;
+        }
+
+        // A list item of the YAML file while its keys are read
+        struct YamlPoint {
+            float time = 0.f;
+            std::array<float, 3> value{};
+            uint8_t flags = 0;
+            InterpolationMode mode = InterpolationMode::kCubicHermite;
+            RE::FormID reference = 0;
+            bool isReference = false;
+            bool isOffsetRelative = false;
+            bool hasTime = false;
+            uint8_t valueMask = 0;  // bit per component of value that was read
+
+            void Set(std::string_view a_key, std::string_view a_value) {
+                if (a_key == "time") {
+                    hasTime = ParseFloat(a_value, time);
+                } else if (a_key == "type") {
+                    const std::string_view type = Trim(a_value);
+                    isReference = type == "reference";
+                    flags = static_cast<uint8_t>(type == "camera" ? flags | kKeyframeAtCamera : flags & ~kKeyframeAtCamera);
+                } else if (a_key == "x" || a_key == "pitch") {
+                    SetComponent(0, a_value);
+                } else if (a_key == "y" || a_key == "yaw") {
+                    SetComponent(1, a_value);
+                } else if (a_key == "z") {
+                    SetComponent(2, a_value);
+                } else if (a_key == "reference") {
+                    reference = ParseFormID(a_value);
+                } else if (a_key == "isOffsetRelative") {
+                    isOffsetRelative = ParseBool(a_value);
+                } else if (a_key == "easeIn") {
+                    flags = static_cast<uint8_t>(ParseBool(a_value) ? flags | kKeyframeEaseIn : flags & ~kKeyframeEaseIn);
+                } else if (a_key == "easeOut") {
+                    flags = static_cast<uint8_t>(ParseBool(a_value) ? flags | kKeyframeEaseOut : flags & ~kKeyframeEaseOut);
+                } else if (a_key == "interpolationMode") {
+                    mode = ParseMode(a_value);
+                }
+            }
+
+            void SetComponent(size_t a_index, std::string_view a_value) {
+                if (ParseFloat(a_value, value[a_index])) {
+                    valueMask = static_cast<uint8_t>(valueMask | (1u << a_index));
+                }
+            }
+
+            // False if the point lacks its time or, unless it follows the camera, one of its N value components. Points
+            // like that come from files whose keys differ from the assumed layout.
+            template <size_t N>
+            bool IsComplete() const {
+                constexpr uint8_t kFullMask = (1u << N) - 1;
+                return hasTime && ((flags & kKeyframeAtCamera) || (valueMask & kFullMask) == kFullMask);
+            }
+
+            // Flow mappings such as {x: 1.0, y: 2.0, z: 3.0}
+            void SetFlow(std::string_view a_text) {
+                a_text = Trim(a_text);
+                if (a_text.size() < 2 || a_text.front() != '{' || a_text.back() != '}') {
+                    return;
+                }
+                a_text = a_text.substr(1, a_text.size() - 2);
+                while (!a_text.empty()) {
+                    const size_t comma = a_text.find(',');
+                    const std::string_view pair = a_text.substr(0, comma);
+                    if (const size_t colon = pair.find(':'); colon != std::string_view::npos) {
+                        Set(Trim(pair.substr(0, colon)), pair.substr(colon + 1));
+                    }
+                    a_text = comma == std::string_view::npos ? std::string_view() : a_text.substr(comma + 1);
+                }
+            }
+
+            template <size_t N>
+            Keyframe<N> ToKeyframe() const {
+                Keyframe<N> keyframe;
+                keyframe.time = time;
+                std::copy_n(value.begin(), N, keyframe.value.begin());
+                keyframe.flags = static_cast<uint8_t>(isOffsetRelative && isReference ? flags | kKeyframeOffsetRelative : flags);
+                keyframe.mode = mode;
+                keyframe.reference = isReference ? reference : 0;
+                return keyframe;
+            }
+        };
+
+        enum class YamlSection { kNone, kTranslations, kRotations };
+
+        // Calls a_func(YamlSection, const YamlPoint&) for every list item of the points sections, in file order. Lines
+        // are views into a_text and nothing is allocated. With a_translationsOnly other sections are skipped unparsed.
+        template <class Func>
+        void ScanYaml(std::string_view a_text, bool a_translationsOnly, Func&& a_func) {
+            YamlSection section = YamlSection::kNone;
+            YamlPoint point;
+            bool hasPoint = false;
+            const auto flush = [&]() {
+                if (hasPoint) {
+                    a_func(section, static_cast<const YamlPoint&>(point));
+                    hasPoint = false;
+                }
+            };
+
+            std::string_view rest = a_text;
+            while (!rest.empty()) {
+                const size_t newline = rest.find('\n');
+                std::string_view line = rest.substr(0, newline);
+                rest = newline == std::string_view::npos ? std::string_view() : rest.substr(newline + 1);
+
+                line = StripComment(line);
+                const size_t indent = line.find_first_not_of(' ');
+                line = Trim(line);
+                if (line.empty() || line == "---") {
+                    continue;
+                }
+
+                if (indent == 0) {
+                    // Top-level key, starts a new list of points or is a setting this reader does not use
+                    flush();
+                    section = line.starts_with("translationPoints") ? YamlSection::kTranslations :
+                              line.starts_with("rotationPoints")    ? YamlSection::kRotations :
+                                                                      YamlSection::kNone;
+                    continue;
+                }
+                if (section == YamlSection::kNone || (a_translationsOnly && section != YamlSection::kTranslations)) {
+                    continue;
+                }
+                if (line.front() == '-') {
+                    flush();
+                    point = {};
+                    hasPoint = true;
+                    line = Trim(line.substr(1));
+                    if (line.empty()) {
+                        continue;
+                    }
+                }
+                if (!hasPoint) {
+                    continue;
+                }
+
+                const size_t colon = line.find(':');
+                if (colon == std::string_view::npos) {
+                    continue;
+                }
+                const std::string_view key = Trim(line.substr(0, colon));
+                const std::string_view value = Trim(line.substr(colon + 1));
+                if (!value.empty() && value.front() == '{') {
+                    point.SetFlow(value);
+                } else {
+                    // Nested block mappings (position: followed by indented x:, y:, z:) land here key by key
+                    point.Set(key, value);
+                }
+            }
+            flush();
+        }
+
+        // Appends a chunk to a_buffer and its entry to a_table
+        template <class T>
+        void AppendChunk(std::vector<std::byte>& a_buffer, std::vector<TimelineFile::ChunkEntry>& a_table, uint32_t a_id, uint32_t a_count,
+                         std::span<const std::byte> a_prefix, std::span<const T> a_elements) {
+            a_buffer.resize((a_buffer.size() + TimelineFile::kChunkAlignment - 1) / TimelineFile::kChunkAlignment * TimelineFile::kChunkAlignment);
+            const size_t offset = a_buffer.size();
+            const auto elements = std::as_bytes(a_elements);
+            a_buffer.insert(a_buffer.end(), a_prefix.begin(), a_prefix.end());
+            a_buffer.insert(a_buffer.end(), elements.begin(), elements.end());
+            a_table.push_back({ a_id, a_count, offset, a_buffer.size() - offset });
+        }
+
+        template <size_t N, class Func>
+        auto Gather(std::span<const Keyframe<N>> a_keyframes, Func&& a_field) {
+            std::vector<std::remove_cvref_t<decltype(a_field(a_keyframes[0]))>> values;
+            values.reserve(a_keyframes.size());
+            for (const auto& keyframe : a_keyframes) {
+                values.push_back(a_field(keyframe));
+            }
+            return values;
+        }
+    }
+
+    TimelineData TimelineData::FromSnapshot(const TimelineModel::Snapshot& a_snapshot) {
+        TimelineData data;
+        data.translations.reserve(a_snapshot.translations.size());
+        data.rotations.reserve(a_snapshot.rotations.size());
+        a_snapshot.translations.ForEach([&](const TranslationKeyframe& a_keyframe) { data.translations.push_back(a_keyframe); });
+        a_snapshot.rotations.ForEach([&](const RotationKeyframe& a_keyframe) { data.rotations.push_back(a_keyframe); });
+        return data;
+    }
+
+    std::filesystem::path TimelineFile::GetFullPath(std::string_view a_path) {
+        return std::filesystem::path("Data") / std::filesystem::path(a_path);
+    }
+
+    std::string TimelineFile::GetBinaryPath(std::string_view a_yamlPath) {
+        const size_t dot = a_yamlPath.rfind('.');
+        const size_t slash = a_yamlPath.find_last_of("/\\");
+        const bool hasExtension = dot != std::string_view::npos && (slash == std::string_view::npos || dot > slash);
+        std::string path(hasExtension ? a_yamlPath.substr(0, dot) : a_yamlPath);
+        path += kBinaryExtension;
+        return path;
+    }
+
+    bool TimelineFile::ReplaceFile(std::string_view a_path, std::span<const std::byte> a_bytes) {
+        const auto path = GetFullPath(a_path);
+        auto tempPath = path;
+        tempPath += ".tmp";
+
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                log::warn("{}: Could not open {} for writing", __FUNCTION__, tempPath.string());
+                return false;
+            }
+            file.write(reinterpret_cast<const char*>(a_bytes.data()), static_cast<std::streamsize>(a_bytes.size()));
+            file.close();
+            if (!file) {
+                log::warn("{}: Could not write {}", __FUNCTION__, tempPath.string());
+                std::filesystem::remove(tempPath, error);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(tempPath, path, error);
+        if (error) {
+            log::warn("{}: Could not replace {}: {}", __FUNCTION__, path.string(), error.message());
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        return true;
+    }
+
+    bool TimelineFile::IsUpToDate(std::string_view a_path, std::string_view a_source) {
+        std::error_code error;
+        const auto time = std::filesystem::last_write_time(GetFullPath(a_path), error);
+        if (error) {
+            return false;
+        }
+        const auto sourceTime = std::filesystem::last_write_time(GetFullPath(a_source), error);
+        return error || time >= sourceTime;
+    }
+
+    uint32_t TimelineFile::ComputeChecksum(std::span<const std::byte> a_bytes) {
+        uint32_t crc = 0xFFFFFFFFu;
+        const std::byte* data = a_bytes.data();
+        size_t size = a_bytes.size();
+        for (; size >= 8; data += 8, size -= 8) {
+            uint32_t low, high;
+            std::memcpy(&low, data, 4);
+            std::memcpy(&high, data + 4, 4);
+            low ^= crc;
+            crc = kCrcTables[7][low & 0xFF] ^ kCrcTables[6][(low >> 8) & 0xFF] ^ kCrcTables[5][(low >> 16) & 0xFF] ^ kCrcTables[4][low >> 24] ^
+                  kCrcTables[3][high & 0xFF] ^ kCrcTables[2][(high >> 8) & 0xFF] ^ kCrcTables[1][(high >> 16) & 0xFF] ^ kCrcTables[0][high >> 24];
+        }
+        for (; size > 0; ++data, --size) {
+            crc = kCrcTables[0][(crc ^ static_cast<uint32_t>(*data)) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    bool TimelineFile::ReadYaml(std::string_view a_path, TimelineData& a_out) {
+        a_out = {};
+
+        MappedFile file;
+        if (!file.Open(GetFullPath(a_path))) {
+            log::warn("{}: Could not open {}", __FUNCTION__, a_path);
+            return false;
+        }
+        size_t incompleteCount = 0;
+        ScanYaml(file.GetText(), false, [&a_out, &incompleteCount](YamlSection a_section, const YamlPoint& a_point) {
+            if (a_section == YamlSection::kTranslations) {
+                incompleteCount += !a_point.IsComplete<3>();
+                a_out.translations.push_back(a_point.ToKeyframe<3>());
+            } else {
+                incompleteCount += !a_point.IsComplete<2>();
+                a_out.rotations.push_back(a_point.ToKeyframe<2>());
+            }
+        });
+
+        // A file in another layout would otherwise read as an empty timeline or as keyframes at the origin. Failing
+        // lets the caller hand it to FCFW's own reader instead.
+        if (a_out.translations.empty() && a_out.rotations.empty()) {
+            log::info("{}: No translationPoints or rotationPoints entries in {}", __FUNCTION__, a_path);
+            return false;
+        }
+        if (incompleteCount > 0) {
+            log::info("{}: {} points in {} lack a time or value this reader knows", __FUNCTION__, incompleteCount, a_path);
+            a_out = {};
+            return false;
+        }
+
+        const auto byTime = [](const auto& a_a, const auto& a_b) { return a_a.time < a_b.time; };
+        std::stable_sort(a_out.translations.begin(), a_out.translations.end(), byTime);
+        std::stable_sort(a_out.rotations.begin(), a_out.rotations.end(), byTime);
+        return true;
+    }
+
+    bool TimelineFile::WriteBinary(std::string_view a_path, const TimelineData& a_data) {
+        const std::span<const TranslationKeyframe> translations = a_data.translations;
+        const std::span<const RotationKeyframe> rotations = a_data.rotations;
+        const auto translationCount = static_cast<uint32_t>(translations.size());
+        const auto rotationCount = static_cast<uint32_t>(rotations.size());
+
+        // Quantise around the centre of the bounds; the step only grows for paths too large for 1/256 unit
+        Quantization quantization;
+        if (!translations.empty()) {
+            std::array<float, 3> low = translations[0].value;
+            std::array<float, 3> high = low;
+            for (const auto& keyframe : translations) {
+                for (size_t axis = 0; axis < 3; ++axis) {
+                    low[axis] = std::min(low[axis], keyframe.value[axis]);
+                    high[axis] = std::max(high[axis], keyframe.value[axis]);
+                }
+            }
+            float halfExtent = 0.f;
+            for (size_t axis = 0; axis < 3; ++axis) {
+                quantization.origin[axis] = 0.5f * (low[axis] + high[axis]);
+                halfExtent = std::max(halfExtent, 0.5f * (high[axis] - low[axis]));
+            }
+            quantization.step = std::max(kPositionStep, halfExtent / 2.0e9f);
+        }
+        std::vector<int32_t> positions;
+        positions.reserve(translations.size() * 3);
+        for (const auto& keyframe : translations) {
+            for (size_t axis = 0; axis < 3; ++axis) {
+                positions.push_back(static_cast<int32_t>(std::lround((keyframe.value[axis] - quantization.origin[axis]) / quantization.step)));
+            }
+        }
+        std::vector<float> rotationValues;
+        rotationValues.reserve(rotations.size() * 2);
+        for (const auto& keyframe : rotations) {
+            rotationValues.insert(rotationValues.end(), keyframe.value.begin(), keyframe.value.end());
+        }
+
+        const auto time = [](const auto& a_keyframe) { return a_keyframe.time; };
+        const auto flags = [](const auto& a_keyframe) { return a_keyframe.flags; };
+        const auto mode = [](const auto& a_keyframe) { return static_cast<uint8_t>(a_keyframe.mode); };
+        const auto reference = [](const auto& a_keyframe) { return a_keyframe.reference; };
+        constexpr uint32_t kChunkCount = 10;
+
+        std::vector<std::byte> buffer(sizeof(Header) + kChunkCount * sizeof(ChunkEntry));
+        std::vector<ChunkEntry> table;
+        table.reserve(kChunkCount);
+        AppendChunk<float>(buffer, table, kTranslationTimes, translationCount, {}, Gather(translations, time));
+        AppendChunk<int32_t>(buffer, table, kTranslationPositions, translationCount, std::as_bytes(std::span(&quantization, 1)), positions);
+        AppendChunk<uint8_t>(buffer, table, kTranslationFlags, translationCount, {}, Gather(translations, flags));
+        AppendChunk<uint8_t>(buffer, table, kTranslationModes, translationCount, {}, Gather(translations, mode));
+        AppendChunk<RE::FormID>(buffer, table, kTranslationReferences, translationCount, {}, Gather(translations, reference));
+        AppendChunk<float>(buffer, table, kRotationTimes, rotationCount, {}, Gather(rotations, time));
+        AppendChunk<float>(buffer, table, kRotationValues, rotationCount, {}, rotationValues);
+        AppendChunk<uint8_t>(buffer, table, kRotationFlags, rotationCount, {}, Gather(rotations, flags));
+        AppendChunk<uint8_t>(buffer, table, kRotationModes, rotationCount, {}, Gather(rotations, mode));
+        AppendChunk<RE::FormID>(buffer, table, kRotationReferences, rotationCount, {}, Gather(rotations, reference));
+
+        std::memcpy(buffer.data() + sizeof(Header), table.data(), table.size() * sizeof(ChunkEntry));
+        Header header;
+        header.chunkCount = static_cast<uint32_t>(table.size());
+        header.fileSize = buffer.size();
+        header.checksum = ComputeChecksum(std::span(buffer).subspan(sizeof(Header)));
+        std::memcpy(buffer.data(), &header, sizeof(Header));
+
+        return ReplaceFile(a_path, buffer);
+    }
+
+    bool TimelineFile::ReadBinary(std::string_view a_path, TimelineData& a_out) {
+        MappedTimeline timeline;
+        if (!timeline.Open(a_path)) {
+            a_out = {};
+            return false;
+        }
+        timeline.ReadAll(a_out);
+        return true;
+    }
+
+    bool TimelineFile::Read(std::string_view a_path, TimelineData& a_out) {
+        return IsBinaryPath(a_path) ? ReadBinary(a_path, a_out) : ReadYaml(a_path, a_out);
+    }
+
+    void TimelinePreview::Clear() {
+        points.clear();
+        times.clear();
+        boundsMin = {};
+        boundsMax = {};
+        skippedCount = 0;
+    }
+
+    bool TimelineFile::ReadPreview(std::string_view a_path, TimelinePreview& a_out) {
+        a_out.Clear();
+        const auto add = [&a_out](float a_time, const std::array<float, 3>& a_value, bool a_isFixed) {
+            if (!a_isFixed || !std::isfinite(a_time) || !std::ranges::all_of(a_value, [](float a_component) { return std::isfinite(a_component); })) {
+                ++a_out.skippedCount;
+                return;
+            }
+            a_out.times.push_back(a_time);
+            a_out.points.emplace_back(a_value[0], a_value[1], a_value[2]);
+        };
+
+        if (IsBinaryPath(a_path)) {
+            MappedTimeline timeline;
+            if (!timeline.Open(a_path)) {
+                return false;
+            }
+            a_out.points.reserve(timeline.GetTranslationCount());
+            a_out.times.reserve(timeline.GetTranslationCount());
+            for (size_t i = 0; i < timeline.GetTranslationCount(); ++i) {
+                const TranslationKeyframe keyframe = timeline.GetTranslation(i);
+                add(keyframe.time, keyframe.value, keyframe.reference == 0 && !(keyframe.flags & kKeyframeAtCamera));
+            }
+        } else {
+            MappedFile file;
+            if (!file.Open(GetFullPath(a_path))) {
+                log::warn("{}: Could not open {}", __FUNCTION__, a_path);
+                return false;
+            }
+            ScanYaml(file.GetText(), true, [&add](YamlSection, const YamlPoint& a_point) {
+                add(a_point.time, a_point.value, a_point.IsComplete<3>() && !a_point.isReference && !(a_point.flags & kKeyframeAtCamera));
+            });
+        }
+
+        // Files written by FCFW are sorted already; anything else is put in time order like ReadYaml does
+        if (!std::ranges::is_sorted(a_out.times)) {
+            std::vector<uint32_t> order(a_out.times.size());
+            std::iota(order.begin(), order.end(), 0u);
+            std::ranges::stable_sort(order, [&a_out](uint32_t a_a, uint32_t a_b) { return a_out.times[a_a] < a_out.times[a_b]; });
+            std::vector<RE::NiPoint3> points(order.size());
+            std::vector<float> times(order.size());
+            for (size_t i = 0; i < order.size(); ++i) {
+                points[i] = a_out.points[order[i]];
+                times[i] = a_out.times[order[i]];
+            }
+            a_out.points = std::move(points);
+            a_out.times = std::move(times);
+        }
+
+        if (!a_out.points.empty()) {
+            a_out.boundsMin = a_out.boundsMax = a_out.points.front();
+            for (const auto& point : a_out.points) {
+                a_out.boundsMin = { std::min(a_out.boundsMin.x, point.x), std::min(a_out.boundsMin.y, point.y), std::min(a_out.boundsMin.z, point.z) };
+                a_out.boundsMax = { std::max(a_out.boundsMax.x, point.x), std::max(a_out.boundsMax.y, point.y), std::max(a_out.boundsMax.z, point.z) };
+            }
+        }
+        return true;
+    }
+
+    bool TimelineFile::ConvertYamlToBinary(std::string_view a_yamlPath, std::string_view a_binaryPath) {
+        TimelineData data;
+        return ReadYaml(a_yamlPath, data) && WriteBinary(a_binaryPath, data);
+    }
+
+    bool MappedFile::Open(const std::filesystem::path& a_path) {
+        Close();
+#ifdef _WIN32
+        HANDLE file = CreateFileW(a_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            CloseHandle(file);
+            return false;
+        }
+        if (size.QuadPart == 0) {
+            CloseHandle(file);
+            m_isOpen = true;
+            return true;
+        }
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view) {
+            if (mapping) {
+                CloseHandle(mapping);
+            }
+            CloseHandle(file);
+            return false;
+        }
+        m_file = file;
+        m_mapping = mapping;
+        m_size = static_cast<size_t>(size.QuadPart);
+#else
+        const int file = open(a_path.c_str(), O_RDONLY);
+        if (file < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(file, &info) != 0) {
+            close(file);
+            return false;
+        }
+        if (info.st_size == 0) {
+            close(file);
+            m_isOpen = true;
+            return true;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+        m_size = static_cast<size_t>(info.st_size);
+#endif
+        m_data = static_cast<const std::byte*>(view);
+        m_isOpen = true;
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (m_data) {
+#ifdef _WIN32
+            UnmapViewOfFile(m_data);
+            CloseHandle(static_cast<HANDLE>(m_mapping));
+            CloseHandle(static_cast<HANDLE>(m_file));
+#else
+            munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+        }
+        m_data = nullptr;
+        m_size = 0;
+        m_file = nullptr;
+        m_mapping = nullptr;
+        m_isOpen = false;
+    }
+
+    void MappedTimeline::Close() {
+        m_file.Close();
+        m_data = nullptr;
+        m_size = 0;
+        m_chunks = {};
+        m_translationTimes = {};
+        m_rotationTimes = {};
+    }
+
+    bool MappedTimeline::Open(std::string_view a_path, bool a_verifyChecksum) {
+        Close();
+        if (!m_file.Open(TimelineFile::GetFullPath(a_path))) {
+            log::warn("{}: Could not map {}", __FUNCTION__, a_path);
+            return false;
+        }
+        m_data = m_file.GetBytes().data();
+        m_size = m_file.GetBytes().size();
+
+        const auto fail = [&](const char* a_reason) {
+            log::warn("{}: {} is not a valid timeline file: {}", __FUNCTION__, a_path, a_reason);
+            Close();
+            return false;
+        };
+
+        TimelineFile::Header header;
+        if (m_size < sizeof(header)) {
+            return fail("truncated header");
+        }
+        std::memcpy(&header, m_data, sizeof(header));
+        if (header.magic != TimelineFile::kMagic) {
+            return fail("wrong magic");
+        }
+        if (header.version != TimelineFile::kVersion || header.headerSize != sizeof(header)) {
+            return fail("unsupported version");
+        }
+        if (header.fileSize != m_size || sizeof(header) + static_cast<uint64_t>(header.chunkCount) * sizeof(TimelineFile::ChunkEntry) > m_size) {
+            return fail("size mismatch");
+        }
+        if (a_verifyChecksum && TimelineFile::ComputeChecksum({ m_data + sizeof(header), m_size - sizeof(header) }) != header.checksum) {
+            return fail("checksum mismatch");
+        }
+        m_chunks = { reinterpret_cast<const TimelineFile::ChunkEntry*>(m_data + sizeof(header)), header.chunkCount };
+
+        const std::byte* quantization = nullptr;
+        if (!GetChunk(TimelineFile::kTranslationTimes, 0, 1, m_translationTimes) ||
+            !GetChunk(TimelineFile::kTranslationPositions, sizeof(TimelineFile::Quantization), 3, m_positions, &quantization) ||
+            !GetChunk(TimelineFile::kTranslationFlags, 0, 1, m_translationFlags) || !GetChunk(TimelineFile::kTranslationModes, 0, 1, m_translationModes) ||
+            !GetChunk(TimelineFile::kTranslationReferences, 0, 1, m_translationReferences) || !GetChunk(TimelineFile::kRotationTimes, 0, 1, m_rotationTimes) ||
+            !GetChunk(TimelineFile::kRotationValues, 0, 2, m_rotationValues) || !GetChunk(TimelineFile::kRotationFlags, 0, 1, m_rotationFlags) ||
+            !GetChunk(TimelineFile::kRotationModes, 0, 1, m_rotationModes) || !GetChunk(TimelineFile::kRotationReferences, 0, 1, m_rotationReferences)) {
+            return fail("missing or malformed chunk");
+        }
+        std::memcpy(&m_quantization, quantization, sizeof(m_quantization));
+
+        const size_t translationCount = m_translationTimes.size();
+        const size_t rotationCount = m_rotationTimes.size();
+        if (m_positions.size() != translationCount * 3 || m_translationFlags.size() != translationCount || m_translationModes.size() != translationCount ||
+            m_translationReferences.size() != translationCount || m_rotationValues.size() != rotationCount * 2 || m_rotationFlags.size() != rotationCount ||
+            m_rotationModes.size() != rotationCount || m_rotationReferences.size() != rotationCount) {
+            return fail("inconsistent keyframe counts");
+        }
+        // Keyframes are handed out in file order, and the model needs them in time order
+        if (!std::ranges::is_sorted(m_translationTimes) || !std::ranges::is_sorted(m_rotationTimes)) {
+            return fail("keyframes not sorted by time");
+        }
+        return true;
+    }
+
+    template <class T>
+    bool MappedTimeline::GetChunk(uint32_t a_id, size_t a_prefixSize, size_t a_elementsPerKeyframe, std::span<const T>& a_out, const std::byte** a_prefix) const {
+        for (const auto& chunk : m_chunks) {
+            if (chunk.id != a_id) {
+                continue;
+            }
+            const size_t elementCount = static_cast<size_t>(chunk.count) * a_elementsPerKeyframe;
+            if (chunk.offset % alignof(T) != 0 || chunk.offset > m_size || chunk.size > m_size - chunk.offset ||
+                chunk.size != a_prefixSize + elementCount * sizeof(T)) {
+                return false;
+            }
+            if (a_prefix) {
+                *a_prefix = m_data + chunk.offset;
+            }
+            a_out = { reinterpret_cast<const T*>(m_data + chunk.offset + a_prefixSize), elementCount };
+            return true;
+        }
+        return false;
+    }
+
+    TranslationKeyframe MappedTimeline::GetTranslation(size_t a_index) const {
+        TranslationKeyframe keyframe;
+        keyframe.time = m_translationTimes[a_index];
+        for (size_t axis = 0; axis < 3; ++axis) {
+            keyframe.value[axis] = m_quantization.origin[axis] + static_cast<float>(m_positions[a_index * 3 + axis]) * m_quantization.step;
+        }
+        keyframe.flags = m_translationFlags[a_index];
+        keyframe.mode = static_cast<InterpolationMode>(m_translationModes[a_index]);
+        keyframe.reference = m_translationReferences[a_index];
+        return keyframe;
+    }
+
+    RotationKeyframe MappedTimeline::GetRotation(size_t a_index) const {
+        RotationKeyframe keyframe;
+        keyframe.time = m_rotationTimes[a_index];
+        keyframe.value = { m_rotationValues[a_index * 2], m_rotationValues[a_index * 2 + 1] };
+        keyframe.flags = m_rotationFlags[a_index];
+        keyframe.mode = static_cast<InterpolationMode>(m_rotationModes[a_index]);
+        keyframe.reference = m_rotationReferences[a_index];
+        return keyframe;
+    }
+
+    void MappedTimeline::ReadAll(TimelineData& a_out) const {
+        a_out.translations.resize(GetTranslationCount());
+        for (size_t i = 0; i < a_out.translations.size(); ++i) {
+            a_out.translations[i] = GetTranslation(i);
+        }
+        a_out.rotations.resize(GetRotationCount());
+        for (size_t i = 0; i < a_out.rotations.size(); ++i) {
+            a_out.rotations[i] = GetRotation(i);
+        }
+    }
+} // namespace FCSE
@@ -0,0 +1,69 @@
+#include "TimelineHistory.h"
+
+namespace FCSE {
+
+    void TimelineHistory::Record(const TimelineModel::Snapshot& a_before, const TimelineModel::Snapshot& a_after) {
+        if (m_versions.empty()) {
+            Push(a_before);
+            m_current = 0;
+        }
+
+        // A new edit discards everything that could have been redone
+        while (m_versions.size() > m_current + 1) {
+            PopBack();
+        }
+        Push(a_after);
+        m_current = m_versions.size() - 1;
+
+        log::debug("{}: {} versions, {:.1f} KiB", __FUNCTION__, m_versions.size(), static_cast<double>(GetMemoryUsage()) / 1024.0);
+    }
+
+    const TimelineModel::Snapshot* TimelineHistory::Undo() {
+        if (m_versions.empty() || m_current == 0) {
+            return nullptr;
+        }
+        return &m_versions[--m_current];
+    }
+
+    const TimelineModel::Snapshot* TimelineHistory::Redo() {
+        if (m_current + 1 >= m_versions.size()) {
+            return nullptr;
+        }
+        return &m_versions[++m_current];
+    }
+
+    void TimelineHistory::Clear() {
+        m_versions.clear();
+        m_current = 0;
+        m_chunkRefs.clear();
+        m_chunkBytes = 0;
+    }
+
+    void TimelineHistory::Push(const TimelineModel::Snapshot& a_snapshot) {
+        // Only the chunk list is copied, the chunks themselves stay shared
+        m_versions.push_back(a_snapshot);
+        a_snapshot.translations.ForEachChunk([this](const auto* a_chunk) { AddChunk(a_chunk, sizeof(*a_chunk)); });
+        a_snapshot.rotations.ForEachChunk([this](const auto* a_chunk) { AddChunk(a_chunk, sizeof(*a_chunk)); });
+    }
+
+    void TimelineHistory::PopBack() {
+        const auto& snapshot = m_versions.back();
+        snapshot.translations.ForEachChunk([this](const auto* a_chunk) { ReleaseChunk(a_chunk, sizeof(*a_chunk)); });
+        snapshot.rotations.ForEachChunk([this](const auto* a_chunk) { ReleaseChunk(a_chunk, sizeof(*a_chunk)); });
+        m_versions.pop_back();
+    }
+
+    void TimelineHistory::AddChunk(const void* a_chunk, size_t a_bytes) {
+        if (m_chunkRefs[a_chunk]++ == 0) {
+            m_chunkBytes += a_bytes;
+        }
+    }
+
+    void TimelineHistory::ReleaseChunk(const void* a_chunk, size_t a_bytes) {
+        auto it = m_chunkRefs.find(a_chunk);
+        if (it != m_chunkRefs.end() && --it->second == 0) {
+            m_chunkRefs.erase(it);
+            m_chunkBytes -= a_bytes;
+        }
+    }
+} // namespace FCSE
@@ -1,5 +1,9 @@
 #include "TimelineManager.h"
 #include "APIManager.h"
+#include "CameraRecorder.h"
+#include "DrawScheduler.h"
+#include "TakeLibrary.h"
+#include "TimelineExporter.h"
 
 namespace FCSE {
 
@@ -8,13 +12,15 @@ namespace FCSE {
             return;
         }
 
+        log::info("{}: Path evaluation uses {} instructions", __FUNCTION__, GetSimdLevelName(GetSimdLevel()));
+
         if (!APIs::FCFW->RegisterPlugin(SKSE::GetPluginHandle())) {
             log::error("TTE - {}: Could not register TTE plugin with FCFW!", __func__);
         }
 
-        if (m_currentTimelineID == 0) {
-            m_currentTimelineID = APIs::FCFW->RegisterTimeline(SKSE::GetPluginHandle());
-log::info("{}: Registered timeline with ID {}", __FUNCTION__, m_currentTimelineID);
+        if (GetTimelineID() == 0) {
+            RegisterTimeline();
+log::info("{}: Registered timeline with ID {}", __FUNCTION__, GetTimelineID());
         }
     }
 
@@ -23,24 +29,36 @@ log::info("{}: Registered timeline with ID {}", __FUNCTION__, m_currentTimelineI
             return;
         }
 
-        if (m_currentTimelineID == 0) {
+        UpdateRecording();
+        UpdateImport();
+        UpdatePreview();
+        DrawFilePreview();
+
+        auto state = GetState();
+        if (state->timelineID == 0) {
             return;
         }
     
-        DrawTimeline();
+        DrawTimeline(*state);
     }
 
-    size_t TimelineManager::GetTimelineID() {
-        return m_currentTimelineID;
+    size_t TimelineManager::GetTimelineID() const {
+        return GetState()->timelineID;
     }
 
     size_t TimelineManager::RegisterTimeline() {
         if (!APIs::FCFW) {
             return 0;
         }
-        m_currentTimelineID = APIs::FCFW->RegisterTimeline(SKSE::GetPluginHandle());
+        size_t timelineID = APIs::FCFW->RegisterTimeline(SKSE::GetPluginHandle());
+        if (timelineID == 0) {
+            return 0;
+        }
+
+        m_registry.Add(timelineID);
+        SetCurrentTimeline(timelineID);
 
-        return m_currentTimelineID;
+        return timelineID;
     }
 
     bool TimelineManager::UnregisterTimeline() {
@@ -48,10 +66,30 @@ log::info("{}: Registered timeline with ID {}", __FUNCTION__, m_currentTimelineI
             return false;
         }
 
-        bool result = APIs::FCFW->UnregisterTimeline(SKSE::GetPluginHandle(), m_currentTimelineID);
+        size_t timelineID = GetTimelineID();
+        if (!m_registry.Contains(timelineID)) {
+            return false;
+        }
+
+        bool result = APIs::FCFW->UnregisterTimeline(SKSE::GetPluginHandle(), timelineID);
 
         if (result){
-            CycleDown();
+            if (IsImporting(timelineID)) {
+                m_import = {};
+            }
+            if (IsRecording(timelineID)) {
+                CameraRecorder::GetSingleton().Stop();
+                m_recording = {};
+            }
+            size_t previousID = m_registry.GetPrevious(timelineID);
+            m_registry.Remove(timelineID);
+            m_pathCaches.erase(timelineID);
+            ModifyState([&](EditorState& a_state) {
+                a_state.cacheVersions.erase(timelineID);
+            });
+            m_models.erase(timelineID);
+            m_histories.erase(timelineID);
+            SetCurrentTimeline(previousID != timelineID ? previousID : 0);
         }
         
         return result;
@@ -62,8 +100,9 @@ log::info("{}: Registered timeline with ID {}", __FUNCTION__, m_currentTimelineI
             return 0;
         }
 
-        m_currentTimelineID += 1;
-        return m_currentTimelineID;
+        size_t timelineID = m_registry.GetNext(GetTimelineID());
+        SetCurrentTimeline(timelineID);
+        return timelineID;
     } 
 
     size_t TimelineManager::CycleDown() {
@@ -71,56 +110,1053 @@ log::info("{}: Registered timeline with ID {}", __FUNCTION__, m_currentTimelineI
             return 0;
         }
 
-        m_currentTimelineID -= 1;
-        if (m_currentTimelineID < 0) {
-            m_currentTimelineID = 0;
+        size_t timelineID = m_registry.GetPrevious(GetTimelineID());
+        SetCurrentTimeline(timelineID);
+        return timelineID;
+    }
+
+    void TimelineManager::SetCurrentTimeline(size_t a_timelineID) {
+        ModifyState([&](EditorState& a_state) {
+            a_state.timelineID = a_timelineID;
+            a_state.selectedTranslationPoint = -1;
+        });
+    }
+
+    void TimelineManager::InvalidateCache(size_t a_timelineID) {
+        ModifyState([&](EditorState& a_state) {
+            ++a_state.cacheVersions[a_timelineID];
+        });
+    }
+
+    std::shared_ptr<const TimelineManager::EditorState> TimelineManager::GetState() const {
+        return m_state.Load();
+    }
+
+    template <class Func>
+    void TimelineManager::ModifyState(Func&& a_modify) {
+        m_state.Modify(std::forward<Func>(a_modify));
+    }
+
+    void TimelineManager::OnFCFWMessage(SKSE::MessagingInterface::Message* a_msg) {
+        if (!a_msg || !a_msg->data || a_msg->dataLen < sizeof(FCFW_API::FCFWTimelineEventData)) {
+            return;
         }
-        return m_currentTimelineID;
+
+        // SKSE delivers messages on the sender's thread, and the registry belongs to the main thread. The message only
+        // lives for this call, so the task takes copies.
+        const size_t timelineID = static_cast<const FCFW_API::FCFWTimelineEventData*>(a_msg->data)->timelineID;
+        const auto message = static_cast<FCFW_API::FCFWMessage>(a_msg->type);
+        SKSE::GetTaskInterface()->AddTask([this, timelineID, message]() {
+            if (m_registry.ApplyPlaybackMessage(timelineID, message)) {
+                InvalidateCache(timelineID);
+            }
+        });
     }
 
-    void TimelineManager::DrawTimeline() {
-        if (!APIs::FCFW) {
+    bool TimelineManager::StartRecording(size_t a_timelineID) {
+        if (!APIs::FCFW || m_recording.isActive) {
+            return false;
+        }
+        const TimelineInfo* info = m_registry.Find(a_timelineID);
+        if (!info || info->playbackState != PlaybackState::kIdle) {
+            return false;
+        }
+        auto* playerCamera = RE::PlayerCamera::GetSingleton();
+        if (!playerCamera || !playerCamera->currentState || playerCamera->currentState->id != RE::CameraState::kFree) {
+            RE::DebugNotification("Recording needs the free camera");
+            return false;
+        }
+        if (m_drag.isActive) {
+            EndDrag();
+        }
+
+        // The model only replaces what it knows, so keyframes added outside the editor are cleared now
+        auto& model = GetModel(a_timelineID);
+        if (model.IsExternallyModified()) {
+            if (!APIs::FCFW->ClearTimeline(SKSE::GetPluginHandle(), a_timelineID)) {
+                return false;
+            }
+            ResetModel(a_timelineID);
+        } else if (!CommitModel(a_timelineID)) {
+            return false;
+        }
+
+        CameraRecorder::GetSingleton().Start();
+        m_recording = {
+            .isActive = true,
+            .timelineID = a_timelineID,
+            .lastSample = std::chrono::steady_clock::now()
+        };
+        m_registry.SetPlaybackState(a_timelineID, PlaybackState::kRecording);
+        InvalidateCache(a_timelineID);
+        return true;
+    }
+
+    bool TimelineManager::StopRecording() {
+        if (!m_recording.isActive) {
+            return false;
+        }
+        const size_t timelineID = m_recording.timelineID;
+        auto& recorder = CameraRecorder::GetSingleton();
+        const uint64_t sampleCount = recorder.GetSampleCount();
+        const TimelineData data = recorder.Stop();
+        m_recording = {};
+        m_registry.SetPlaybackState(timelineID, PlaybackState::kIdle);
+
+        auto& model = GetModel(timelineID);
+        model.Clear();
+        for (const auto& keyframe : data.translations) {
+            model.AddTranslation(keyframe);
+        }
+        for (const auto& keyframe : data.rotations) {
+            model.AddRotation(keyframe);
+        }
+        const bool committed = CommitModel(timelineID);
+        log::info("{}: Recorded {} frames into {} translation and {} rotation keyframes on timeline {}{}", __FUNCTION__, sampleCount,
+                  data.translations.size(), data.rotations.size(), timelineID, committed ? "" : " (FCFW rejected some)");
+
+        const std::string message = "Recorded camera path: " + std::to_string(data.translations.size() + data.rotations.size()) +
+                                    " keyframes from " + std::to_string(sampleCount) + " frames";
+        RE::DebugNotification(message.c_str());
+        return committed;
+    }
+
+    bool TimelineManager::CommitModel(size_t a_timelineID) {
+        if (!APIs::FCFW || !m_registry.Contains(a_timelineID)) {
+            return false;
+        }
+
+        auto& model = GetModel(a_timelineID);
+        if (!model.IsDirty()) {
+            return true;
+        }
+
+        const auto before = model.GetSyncedSnapshot();
+        const auto stats = model.Sync(*APIs::FCFW, SKSE::GetPluginHandle(), a_timelineID);
+        m_histories[a_timelineID].Record(before, model.GetSnapshot());
+        m_registry.SetDuration(a_timelineID, model.GetDuration());
+        InvalidateCache(a_timelineID);
+
+        return stats.failed == 0;
+    }
+
+    bool TimelineManager::ExportTimeline(size_t a_timelineID, std::string_view a_yamlPath, std::string_view a_binaryPath) {
+        if (!APIs::FCFW || !m_registry.Contains(a_timelineID)) {
+            return false;
+        }
+
+        // FCFW writes the YAML file, so it is always in the layout FCFW reads back, references included
+        const std::string yamlPath(a_yamlPath);
+        if (!APIs::FCFW->ExportTimeline(SKSE::GetPluginHandle(), a_timelineID, yamlPath.c_str())) {
+            RE::DebugNotification("Exporting camera path failed");
+            return false;
+        }
+        m_registry.SetSourceFile(a_timelineID, a_yamlPath);
+        if (a_binaryPath.empty()) {
+            TakeLibrary::GetSingleton().StartScan();
+            RE::DebugNotification("Camera path exported");
+            return true;
+        }
+
+        // The binary copy is only a faster way to load the file, so failing to write it does not fail the export
+        auto onDone = [yamlPath, binaryPath = std::string(a_binaryPath)](bool a_succeeded) {
+            if (!a_succeeded) {
+                log::warn("ExportTimeline: Could not write {} next to {}", binaryPath, yamlPath);
+            }
+            TakeLibrary::GetSingleton().StartScan();
+            RE::DebugNotification("Camera path exported");
+        };
+
+        // FCFW holds keyframes the model has not seen (recordings, FCFW imports), so the copy is converted from FCFW's file
+        const auto& model = GetModel(a_timelineID);
+        if (model.IsExternallyModified()) {
+            TimelineExporter::GetSingleton().Convert(yamlPath, std::string(a_binaryPath), std::move(onDone));
+            return true;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        auto snapshot = model.GetSnapshot();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        log::debug("{}: Snapshot of {} keyframes took {} us", __FUNCTION__, snapshot.translations.size() + snapshot.rotations.size(), elapsed.count());
+        TimelineExporter::GetSingleton().Export(std::move(snapshot), std::string(a_binaryPath), std::move(onDone));
+        return true;
+    }
+
+    bool TimelineManager::BeginImport(size_t a_timelineID, std::string_view a_path) {
+        if (!APIs::FCFW || m_import.isActive) {
+            return false;
+        }
+        const TimelineInfo* info = m_registry.Find(a_timelineID);
+        if (!info || info->playbackState != PlaybackState::kIdle) {
+            return false;
+        }
+        if (m_drag.isActive) {
+            EndDrag();
+        }
+        if (!CommitModel(a_timelineID)) {
+            return false;
+        }
+
+        auto result = std::make_shared<ImportState::Result>();
+        m_import = {
+            .isActive = true,
+            .timelineID = a_timelineID,
+            .path = std::string(a_path),
+            .result = result,
+            .before = GetModel(a_timelineID).GetSyncedSnapshot(),
+            .nextProgress = std::chrono::steady_clock::now() + kImportProgressInterval
+        };
+        m_registry.SetPlaybackState(a_timelineID, PlaybackState::kImporting);
+
+        // The worker keeps its own reference, so a cancelled import can finish reading into a result nobody waits for
+        std::thread([result, path = m_import.path]() {
+            const auto start = std::chrono::steady_clock::now();
+            result->succeeded = TimelineFile::Read(path, result->data);
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            log::info("BeginImport: Read {} translation and {} rotation keyframes from {} in {} ms", result->data.translations.size(),
+                      result->data.rotations.size(), path, elapsed.count());
+            result->isDone.store(true, std::memory_order_release);
+        }).detach();
+        return true;
+    }
+
+    bool TimelineManager::CancelImport() {
+        if (!m_import.isActive) {
+            return false;
+        }
+        log::info("{}: Cancelled import of {} into timeline {}", __FUNCTION__, m_import.path, m_import.timelineID);
+        FinishImport(false);
+        RE::DebugNotification("Camera path import cancelled");
+        return true;
+    }
+
+    void TimelineManager::UpdateImport() {
+        if (!m_import.isActive || !m_import.result->isDone.load(std::memory_order_acquire)) {
             return;
         }
 
-        if (m_currentTimelineID == 0 || !APIs::TrueHUD) {
+        const auto& data = m_import.result->data;
+        if (!m_import.result->succeeded) {
+            const size_t timelineID = m_import.timelineID;
+            const std::string path = std::move(m_import.path);
+            FinishImport(false);
+
+            // FCSE only reads the keys FCFW is known to write; FCFW's own reader may still understand the file
+            bool imported = false;
+            if (!TimelineFile::IsBinaryPath(path)) {
+                imported = APIs::FCFW->AddTimelineFromFile(SKSE::GetPluginHandle(), timelineID, path.c_str());
+                if (imported) {
+                    m_registry.SetSourceFile(timelineID, path);
+                    GetModel(timelineID).MarkExternallyModified();
+                    InvalidateCache(timelineID);
+                }
+            }
+            RE::DebugNotification(imported ? "Camera path imported" : "Importing camera path failed");
             return;
         }
 
-        auto handle = SKSE::GetPluginHandle();
-        int translationCount = APIs::FCFW->GetTranslationPointCount(handle, m_currentTimelineID);
-        int rotationCount = APIs::FCFW->GetRotationPointCount(handle, m_currentTimelineID);
-        if (translationCount == 0 && rotationCount == 0) {
+        // One batch per frame and one Sync for it, as every Sync diffs the whole track. The batch size follows the
+        // time the last frame took, so adding and sending stay within the frame budget.
+        const auto start = std::chrono::steady_clock::now();
+        auto& model = GetModel(m_import.timelineID);
+        for (size_t i = 0; i < m_import.batchSize; ++i) {
+            if (m_import.nextTranslation < data.translations.size()) {
+                model.AddTranslation(data.translations[m_import.nextTranslation++]);
+            } else if (m_import.nextRotation < data.rotations.size()) {
+                model.AddRotation(data.rotations[m_import.nextRotation++]);
+            } else {
+                break;
+            }
+        }
+        m_import.failed += model.Sync(*APIs::FCFW, SKSE::GetPluginHandle(), m_import.timelineID).failed;
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed < kImportFrameBudget / 2) {
+            m_import.batchSize *= 2;
+        } else if (elapsed > kImportFrameBudget) {
+            m_import.batchSize = std::max(m_import.batchSize / 2, kImportBatchSize);
+        }
+
+        const size_t applied = m_import.nextTranslation + m_import.nextRotation;
+        const size_t total = data.translations.size() + data.rotations.size();
+        if (applied < total) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= m_import.nextProgress) {
+                m_import.nextProgress = now + kImportProgressInterval;
+                const std::string progress = "Importing camera path: " + std::to_string(applied * 100 / total) + "%";
+                RE::DebugNotification(progress.c_str());
+            }
             return;
         }
-        
-        if (APIs::FCFW->IsPlaybackRunning(handle, m_currentTimelineID) || APIs::FCFW->IsRecording(handle, m_currentTimelineID)) {
+
+        const bool succeeded = m_import.failed == 0;
+        if (!succeeded) {
+            log::warn("{}: FCFW rejected {} keyframes of {}, rolling back", __FUNCTION__, m_import.failed, m_import.path);
+        }
+        FinishImport(succeeded);
+        RE::DebugNotification(succeeded ? "Camera path imported" : "Importing camera path failed");
+    }
+
+    void TimelineManager::FinishImport(bool a_succeeded) {
+        const size_t timelineID = m_import.timelineID;
+        auto& model = GetModel(timelineID);
+        if (a_succeeded) {
+            // The whole import is one undo step
+            m_histories[timelineID].Record(m_import.before, model.GetSnapshot());
+            m_registry.SetSourceFile(timelineID, m_import.path);
+        } else if (m_import.nextTranslation + m_import.nextRotation > 0) {
+            // Removes exactly the keyframes the import added
+            model.Restore(m_import.before);
+            model.Sync(*APIs::FCFW, SKSE::GetPluginHandle(), timelineID);
+        }
+
+        m_registry.SetPlaybackState(timelineID, PlaybackState::kIdle);
+        m_registry.SetDuration(timelineID, model.GetDuration());
+        InvalidateCache(timelineID);
+        m_import = {};
+    }
+
+    bool TimelineManager::BeginPreview(std::string_view a_path) {
+        EndPreview();
+
+        auto result = std::make_shared<PreviewState::Result>();
+        m_preview.isActive = true;
+        m_preview.path = a_path;
+        m_preview.result = result;
+
+        // Like an import, the worker keeps its own reference in case the preview is ended before the file is read
+        std::thread([result, path = m_preview.path]() {
+            const auto start = std::chrono::steady_clock::now();
+            result->succeeded = TimelineFile::ReadPreview(path, result->preview);
+            const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+            log::info("BeginPreview: Read {} translation keyframes from {} in {} ms", result->preview.points.size(), path, elapsed.count());
+            result->isDone.store(true, std::memory_order_release);
+        }).detach();
+        return true;
+    }
+
+    void TimelineManager::ShowPreview(std::string_view a_path, TimelinePreview a_preview) {
+        EndPreview();
+
+        auto result = std::make_shared<PreviewState::Result>();
+        result->preview = std::move(a_preview);
+        result->succeeded = true;
+        result->isDone.store(true, std::memory_order_release);
+        m_preview.isActive = true;
+        m_preview.isSummary = true;
+        m_preview.path = a_path;
+        m_preview.result = std::move(result);
+        UpdatePreview();
+    }
+
+    void TimelineManager::EndPreview() {
+        // Submitted lines expire within RetainedDrawer::kLifetime
+        const uint32_t version = m_preview.version;
+        m_preview = {};
+        m_preview.version = version;
+        m_previewDrawer.Clear();
+    }
+
+    void TimelineManager::UpdatePreview() {
+        if (!m_preview.isActive || m_preview.isLoaded || !m_preview.result->isDone.load(std::memory_order_acquire)) {
             return;
         }
-        
-        auto* playerCamera = RE::PlayerCamera::GetSingleton();
-        if (!playerCamera) {
+
+        const auto& preview = m_preview.result->preview;
+        if (!m_preview.result->succeeded || preview.points.empty()) {
+            RE::DebugNotification(m_preview.result->succeeded ? "Camera path has no keyframes to preview" : "Previewing camera path failed");
+            EndPreview();
             return;
         }
-        
-        if (!(playerCamera->currentState && (playerCamera->currentState->id == RE::CameraState::kFree))) {
+
+        m_preview.lod.Build(preview.points);
+        m_preview.isLoaded = true;
+        ++m_preview.version;
+        if (preview.skippedCount > 0) {
+            log::info("{}: {} keyframes of {} are bound to the camera or a reference and not previewed", __FUNCTION__, preview.skippedCount, m_preview.path);
+        }
+        if (!m_preview.isSummary) {
+            const std::string message = "Previewing camera path: " + std::to_string(preview.points.size()) + " keyframes";
+            RE::DebugNotification(message.c_str());
+        }
+    }
+
+    void TimelineManager::DrawFilePreview() {
+        if (!m_preview.isLoaded || !APIs::TrueHUD) {
             return;
         }
 
-// TEMP FIX to ensure TrueHUD menu is visible during timeline drawing
+        ViewFrustum frustum;
+        if (!frustum.FromPlayerCamera(RE::PlayerCamera::GetSingleton())) {
+            return;
+        }
+        ShowTrueHUDMenu();
+
+        // Same run culling, level of detail and retained submission as the timeline path, in its own key range
+        auto& scheduler = DrawScheduler::GetSingleton();
+        scheduler.BeginFrame(frustum);
+        m_previewDrawer.BeginFrame();
+        const auto& preview = m_preview.result->preview;
+        m_preview.lod.ForEachVisibleRun(preview.points, frustum, kTessellationTolerancePixels, [&](const PathLOD::RunView& a_run) {
+            const uint64_t key = kPreviewKeyBase | a_run.index;
+            const uint64_t version = (static_cast<uint64_t>(m_preview.version) << 40) | (static_cast<uint64_t>(a_run.generation & 0xFFFFFFFF) << 8) | a_run.level;
+            if (!m_previewDrawer.NeedsSubmit(key, version)) {
+                return;
+            }
+
+            const RE::NiPoint3 runCenter = (a_run.keyframes.front() + a_run.keyframes.back()) * 0.5f;
+            const float runRadius = a_run.keyframes.front().GetDistance(a_run.keyframes.back()) * 0.5f;
+            const float lifetime = m_previewDrawer.GetLifetime(key, version);
+            scheduler.Enqueue(DrawScheduler::Producer::kPath, key, runCenter, runRadius, static_cast<uint32_t>(a_run.polyline.size()), [this, a_run, key, version, lifetime]() {
+                for (size_t i = 1; i < a_run.polyline.size(); ++i) {
+                    APIs::TrueHUD->DrawLine(a_run.polyline[i - 1], a_run.polyline[i], lifetime, kPreviewColor);
+                }
+                m_previewDrawer.MarkSubmitted(key, version, lifetime);
+            });
+        });
+
+        const uint64_t boundsVersion = m_preview.version;
+        if (m_previewDrawer.NeedsSubmit(kPreviewBoundsKey, boundsVersion)) {
+            const RE::NiPoint3 low = preview.boundsMin;
+            const RE::NiPoint3 high = preview.boundsMax;
+            const RE::NiPoint3 center = (low + high) * 0.5f;
+            const float lifetime = m_previewDrawer.GetLifetime(kPreviewBoundsKey, boundsVersion);
+            scheduler.Enqueue(DrawScheduler::Producer::kOverlay, kPreviewBoundsKey, center, low.GetDistance(high) * 0.5f, 12, [this, low, high, boundsVersion, lifetime]() {
+                // The corner index bits pick low or high per axis; edges join corners that differ in one bit
+                const auto corner = [&](uint32_t a_bits) {
+                    return RE::NiPoint3((a_bits & 1) ? high.x : low.x, (a_bits & 2) ? high.y : low.y, (a_bits & 4) ? high.z : low.z);
+                };
+                for (uint32_t bits = 0; bits < 8; ++bits) {
+                    for (uint32_t axis = 1; axis < 8; axis <<= 1) {
+                        if (!(bits & axis)) {
+                            APIs::TrueHUD->DrawLine(corner(bits), corner(bits | axis), lifetime, kPreviewBoundsColor);
+                        }
+                    }
+                }
+                m_previewDrawer.MarkSubmitted(kPreviewBoundsKey, boundsVersion, lifetime);
+            });
+        }
+    }
+
+    void TimelineManager::ShowTrueHUDMenu() {
+        // TEMP FIX to ensure TrueHUD menu is visible during timeline drawing
         auto* ui = RE::UI::GetSingleton();
         if (ui) {
             auto trueHUDMenu = ui->GetMenu<RE::IMenu>("TrueHUD");
             if (trueHUDMenu && trueHUDMenu->uiMovie) {
                 trueHUDMenu->uiMovie->SetVisible(true);
             }
-        }        
+        }
+    }
+
+    void TimelineManager::ResetModel(size_t a_timelineID) {
+        if (m_drag.timelineID == a_timelineID) {
+            m_drag = {};
+        }
+
+        auto& model = GetModel(a_timelineID);
+        const auto before = model.GetSnapshot();
+        model.ResetToEmpty();
+        m_histories[a_timelineID].Record(before, model.GetSnapshot());
+        m_registry.ResetMetadata(a_timelineID);
+        InvalidateCache(a_timelineID);
+    }
+
+    bool TimelineManager::Undo() {
+        if (m_drag.isActive) {
+            EndDrag();
+        }
+
+        size_t timelineID = GetTimelineID();
+        auto it = m_histories.find(timelineID);
+        if (it == m_histories.end()) {
+            return false;
+        }
+
+        const auto* snapshot = it->second.Undo();
+        return snapshot && RestoreModel(timelineID, *snapshot);
+    }
+
+    bool TimelineManager::Redo() {
+        if (m_drag.isActive) {
+            EndDrag();
+        }
+
+        size_t timelineID = GetTimelineID();
+        auto it = m_histories.find(timelineID);
+        if (it == m_histories.end()) {
+            return false;
+        }
+
+        const auto* snapshot = it->second.Redo();
+        return snapshot && RestoreModel(timelineID, *snapshot);
+    }
+
+    bool TimelineManager::RestoreModel(size_t a_timelineID, const TimelineModel::Snapshot& a_snapshot) {
+        if (!APIs::FCFW || !m_registry.Contains(a_timelineID)) {
+            return false;
+        }
+
+        // Only the keyframes that differ from what FCFW currently has are sent
+        auto& model = GetModel(a_timelineID);
+        model.Restore(a_snapshot);
+        const auto stats = model.Sync(*APIs::FCFW, SKSE::GetPluginHandle(), a_timelineID);
+        m_registry.SetDuration(a_timelineID, model.GetDuration());
+        InvalidateCache(a_timelineID);
+
+        return stats.failed == 0;
+    }
+
+    void TimelineManager::UpdateRecording() {
+        if (!m_recording.isActive) {
+            return;
+        }
+
+        auto* playerCamera = RE::PlayerCamera::GetSingleton();
+        if (!playerCamera || !playerCamera->currentState || playerCamera->currentState->id != RE::CameraState::kFree) {
+            log::info("{}: Camera left free camera mode, stopping the recording on timeline {}", __FUNCTION__, m_recording.timelineID);
+            StopRecording();
+            return;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        const float deltaTime = std::chrono::duration<float>(now - m_recording.lastSample).count();
+        m_recording.lastSample = now;
+
+        const auto* freeCameraState = static_cast<RE::FreeCameraState*>(playerCamera->currentState.get());
+        CameraRecorder::GetSingleton().AddSample(deltaTime, freeCameraState->translation, freeCameraState->rotation.x,
+                                                 freeCameraState->rotation.y);
+    }
+
+    bool TimelineManager::ToggleRotationGizmos() {
+        bool showRotationGizmos = false;
+        ModifyState([&](EditorState& a_state) {
+            showRotationGizmos = a_state.showRotationGizmos = !a_state.showRotationGizmos;
+        });
+        return showRotationGizmos;
+    }
+
+    TimelineManager::PathCache& TimelineManager::GetPathCache(const EditorState& a_state) {
+        const size_t timelineID = a_state.timelineID;
+        const uint32_t editVersion = a_state.GetCacheVersion(timelineID);
+        auto& cache = m_pathCaches[timelineID];
+
+        if (cache.isValid && cache.editVersion == editVersion) {
+            return cache;
+        }
+
+        auto handle = SKSE::GetPluginHandle();
+        int translationCount = APIs::FCFW->GetTranslationPointCount(handle, timelineID);
+        int rotationCount = APIs::FCFW->GetRotationPointCount(handle, timelineID);
+        size_t count = translationCount > 0 ? static_cast<size_t>(translationCount) : 0;
+
+        cache.translationPoints.clear();
+        cache.translationPoints.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            cache.translationPoints.push_back(APIs::FCFW->GetTranslationPoint(handle, timelineID, i));
+        }
+        cache.lod.Build(cache.translationPoints);
+        cache.bvh.Build(cache.translationPoints);
+        ReadKeyframeTiming(timelineID, cache);
+        cache.arcLength.Build(cache.translationPoints, cache.keyframeModes);
+        BuildDistanceOverlay(cache, true);
+        cache.isValid = true;
+        cache.editVersion = editVersion;
+        ++cache.version;
+        m_pathDrawer.Prune();
+        m_registry.Refresh(timelineID, translationCount, rotationCount, cache.translationPoints);
+
+        log::debug("{}: Cached {} translation points for timeline {}", __FUNCTION__, count, timelineID);
+        return cache;
+    }
+
+    void TimelineManager::DrawTimeline(const EditorState& a_state) {
+        if (!APIs::FCFW) {
+            return;
+        }
+
+        if (a_state.timelineID == 0 || !APIs::TrueHUD) {
+            return;
+        }
+
+        // The timeline may have been switched from another thread since the last frame;
+        // geometry submitted for the previous one is left to expire
+        if (a_state.timelineID != m_drawnTimelineID) {
+            m_pathDrawer.Clear();
+            m_drawnTimelineID = a_state.timelineID;
+        }
+
+        // Never query FCFW for timelines FCSE does not own
+        const TimelineInfo* info = m_registry.Find(a_state.timelineID);
+        if (!info) {
+            return;
+        }
+
+        if (info->playbackState != PlaybackState::kIdle) {
+            m_pathDrawer.Clear();
+            return;
+        }
+
+        auto& cache = GetPathCache(a_state);
+        if (info->translationCount == 0 && info->rotationCount == 0) {
+            return;
+        }
         
-        // Draw lines between translation points
-        for (size_t i = 0; i < translationCount - 1; ++i) {
-            RE::NiPoint3 point1 = APIs::FCFW->GetTranslationPoint(handle, m_currentTimelineID, i);
-            RE::NiPoint3 point2 = APIs::FCFW->GetTranslationPoint(handle, m_currentTimelineID, i + 1);
-            APIs::TrueHUD->DrawLine(point1, point2);
+        ViewFrustum frustum;
+        if (!frustum.FromPlayerCamera(RE::PlayerCamera::GetSingleton())) {
+            return;
+        }
+
+        ShowTrueHUDMenu();
+
+        // Draw the visible parts of the interpolated path between translation points.
+        // Runs are only resubmitted when their polyline changed or their previous submission is about to expire,
+        // and the draw scheduler decides how many of them fit into this frame.
+        m_lastFrustum = frustum;
+        UpdateDrag(a_state, cache, frustum);
+
+        auto& scheduler = DrawScheduler::GetSingleton();
+        scheduler.BeginFrame(frustum);
+        m_pathDrawer.BeginFrame();
+        cache.lod.ForEachVisibleRun(cache.translationPoints, frustum, kTessellationTolerancePixels, [&](const PathLOD::RunView& a_run) {
+            const RE::NiPoint3 runCenter = (a_run.keyframes.front() + a_run.keyframes.back()) * 0.5f;
+            const float runRadius = a_run.keyframes.front().GetDistance(a_run.keyframes.back()) * 0.5f;
+
+            // Runs whose curve a drag moves change every frame and are never retained. Segment i depends on
+            // keyframes i - 1 to i + 2, and the run covers segments first to first + keyframe count - 2.
+            const bool isDragged = m_drag.isActive && m_drag.index + 1 >= a_run.first && m_drag.index <= a_run.first + a_run.keyframes.size();
+
+            const uint64_t pathKey = a_run.index * 2;
+            const uint64_t pathVersion = (static_cast<uint64_t>(cache.version) << 40) | (static_cast<uint64_t>(a_run.revision & 0xFFFF) << 24) |
+                                         (static_cast<uint64_t>(a_run.generation & 0xFFFF) << 8) | a_run.level;
+            if (m_pathDrawer.NeedsSubmit(pathKey, pathVersion)) {
+                const std::span<const uint32_t> colors = cache.segmentColors.empty() ?
+                    std::span<const uint32_t>() : std::span<const uint32_t>(cache.segmentColors).subspan(a_run.first, a_run.keyframes.size() - 1);
+                const float lifetime = isDragged ? RetainedDrawer::kImmediate : m_pathDrawer.GetLifetime(pathKey, pathVersion);
+                scheduler.Enqueue(DrawScheduler::Producer::kPath, pathKey, runCenter, runRadius, static_cast<uint32_t>(a_run.polyline.size()), [this, a_run, colors, pathKey, pathVersion, lifetime]() {
+                    // Each line takes the speed colour of the segment it starts in. Tessellated polylines pass through
+                    // every keyframe, coarser levels keep every stride-th one.
+                    const size_t stride = a_run.level == 0 ? 0 : size_t(1) << (a_run.level - 1);
+                    size_t segment = 0;
+                    for (size_t i = 1; i < a_run.polyline.size(); ++i) {
+                        const uint32_t color = colors.empty() ? kPathColor : colors[std::min(segment, colors.size() - 1)];
+                        APIs::TrueHUD->DrawLine(a_run.polyline[i - 1], a_run.polyline[i], lifetime, color);
+                        if (stride > 0) {
+                            segment += stride;
+                        } else if (segment + 1 < a_run.keyframes.size() && a_run.polyline[i] == a_run.keyframes[segment + 1]) {
+                            ++segment;
+                        }
+                    }
+                    m_pathDrawer.MarkSubmitted(pathKey, pathVersion, lifetime);
+                });
+            }
+
+            // Keyframe markers only on runs close enough to be drawn at keyframe resolution
+            const uint64_t markerKey = a_run.index * 2 + 1;
+            const uint64_t markerVersion = (static_cast<uint64_t>(cache.version) << 32) | a_run.revision;
+            if (a_run.level <= 1 && m_pathDrawer.NeedsSubmit(markerKey, markerVersion)) {
+                const float lifetime = isDragged ? RetainedDrawer::kImmediate : m_pathDrawer.GetLifetime(markerKey, markerVersion);
+                scheduler.Enqueue(DrawScheduler::Producer::kKeyframes, markerKey, runCenter, runRadius, static_cast<uint32_t>(a_run.keyframes.size()), [this, a_run, markerKey, version = markerVersion, lifetime]() {
+                    // Neighbouring runs share their end keyframe, so each run skips its first one
+                    for (size_t i = a_run.index == 0 ? 0 : 1; i < a_run.keyframes.size(); ++i) {
+                        APIs::TrueHUD->DrawPoint(a_run.keyframes[i], kKeyframeMarkerSize, lifetime, kKeyframeColor);
+                    }
+                    m_pathDrawer.MarkSubmitted(markerKey, version, lifetime);
+                });
+            }
+        });
+
+        DrawDistanceTicks(cache, frustum);
+        DrawPickHighlight(cache, frustum);
+        DrawScrubPreview(a_state, cache, info->rotationCount);
+
+        if (a_state.showRotationGizmos) {
+            DrawRotationGizmos(a_state, cache, info->rotationCount, frustum);
+        }
+    }
+
+    bool TimelineManager::ToggleDrag() {
+        if (m_drag.isActive) {
+            EndDrag();
+            return false;
+        }
+
+        const size_t timelineID = GetTimelineID();
+        auto cacheIt = m_pathCaches.find(timelineID);
+        if (!APIs::FCFW || cacheIt == m_pathCaches.end() || m_hoveredTranslationPoint == KeyframeBVH::kInvalidIndex) {
+            return false;
+        }
+
+        // The model has to know the keyframe's time and flags to send it again
+        auto& model = GetModel(timelineID);
+        if (model.IsExternallyModified() || model.GetTranslations().size() != cacheIt->second.translationPoints.size()) {
+            RE::DebugNotification("Only keyframes created in the editor can be moved");
+            return false;
+        }
+
+        const RE::NiPoint3& position = cacheIt->second.translationPoints[m_hoveredTranslationPoint];
+        m_drag.isActive = true;
+        m_drag.hasMoved = false;
+        m_drag.timelineID = timelineID;
+        m_drag.index = m_hoveredTranslationPoint;
+        m_drag.distance = position.GetDistance(m_lastFrustum.GetPosition());
+        m_drag.before = model.GetSyncedSnapshot();
+        m_drag.nextCommit = std::chrono::steady_clock::now() + kDragCommitInterval;
+        return true;
+    }
+
+    void TimelineManager::UpdateDrag(const EditorState& a_state, PathCache& a_cache, const ViewFrustum& a_frustum) {
+        if (!m_drag.isActive) {
+            return;
+        }
+        if (a_state.timelineID != m_drag.timelineID || m_drag.index >= a_cache.translationPoints.size()) {
+            EndDrag();
+            return;
+        }
+
+        const RE::NiPoint3 position = a_frustum.GetPosition() + a_frustum.GetForward() * m_drag.distance;
+        auto& model = GetModel(m_drag.timelineID);
+        if (position != a_cache.translationPoints[m_drag.index]) {
+            // Only the runs around the keyframe are rebuilt, the rest of the path keeps its geometry
+            a_cache.translationPoints[m_drag.index] = position;
+            a_cache.lod.UpdateKeyframe(a_cache.translationPoints, m_drag.index);
+            a_cache.bvh.Refit(m_drag.index, position);
+            a_cache.scrubber.Clear();
+            a_cache.arcLength.UpdateKeyframe(a_cache.translationPoints, a_cache.keyframeModes, m_drag.index);
+            BuildDistanceOverlay(a_cache, false);
+
+            // A dragged keyframe becomes a plain world position
+            auto keyframe = model.GetTranslations().Get(m_drag.index);
+            keyframe.value = { position.x, position.y, position.z };
+            keyframe.reference = 0;
+            keyframe.flags &= ~(kKeyframeAtCamera | kKeyframeOffsetRelative);
+            model.SetTranslation(m_drag.index, keyframe);
+            m_drag.hasMoved = true;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= m_drag.nextCommit && model.IsDirty()) {
+            model.Sync(*APIs::FCFW, SKSE::GetPluginHandle(), m_drag.timelineID);
+            m_drag.nextCommit = now + kDragCommitInterval;
+        }
+    }
+
+    void TimelineManager::EndDrag() {
+        m_drag.isActive = false;
+        if (!m_drag.hasMoved || !APIs::FCFW || !m_registry.Contains(m_drag.timelineID)) {
+            return;
+        }
+
+        // The cache already holds the moved keyframe, so it is patched instead of re-read from FCFW
+        auto& model = GetModel(m_drag.timelineID);
+        model.Sync(*APIs::FCFW, SKSE::GetPluginHandle(), m_drag.timelineID);
+        m_histories[m_drag.timelineID].Record(m_drag.before, model.GetSnapshot());
+        m_drag.before = {};
+
+        auto& cache = m_pathCaches[m_drag.timelineID];
+        cache.gizmos.Invalidate();
+        const TimelineInfo* info = m_registry.Find(m_drag.timelineID);
+        m_registry.Refresh(m_drag.timelineID, info->translationCount, info->rotationCount, cache.translationPoints);
+    }
+
+    void TimelineManager::DrawPickHighlight(const PathCache& a_cache, const ViewFrustum& a_frustum) {
+        if (m_drag.isActive) {
+            m_hoveredTranslationPoint = m_drag.index;
+        } else {
+            const float maxAngle = kPickRadiusPixels / a_frustum.GetPixelsPerRadian();
+            m_hoveredTranslationPoint = a_cache.bvh.PickRay(a_frustum.GetPosition(), a_frustum.GetForward(), maxAngle);
+        }
+        if (m_hoveredTranslationPoint == KeyframeBVH::kInvalidIndex) {
+            return;
+        }
+
+        // Follows the crosshair, so it is drawn for a single frame instead of being retained
+        const RE::NiPoint3 position = a_cache.bvh.GetPoint(m_hoveredTranslationPoint);
+        DrawScheduler::GetSingleton().Enqueue(DrawScheduler::Producer::kOverlay, kHighlightKey, position, kHighlightMarkerSize, 1, [position]() {
+            APIs::TrueHUD->DrawPoint(position, kHighlightMarkerSize, RetainedDrawer::kImmediate, kHighlightColor);
+        });
+    }
+
+    bool TimelineManager::BeginScrub() {
+        const size_t timelineID = GetTimelineID();
+        const TimelineInfo* info = m_registry.Find(timelineID);
+        if (!info || info->playbackState != PlaybackState::kIdle || info->translationCount == 0) {
+            return false;
+        }
+
+        if (m_drag.isActive) {
+            EndDrag();
+        }
+        m_scrub.isActive = true;
+        m_scrub.timelineID = timelineID;
+        m_scrub.time = 0.f;
+        return true;
+    }
+
+    void TimelineManager::Scrub(float a_deltaSeconds) {
+        if (m_scrub.isActive) {
+            m_scrub.time += a_deltaSeconds;
+        }
+    }
+
+    void TimelineManager::EndScrub() {
+        m_scrub.isActive = false;
+    }
+
+    bool TimelineManager::HasRotationTimes(size_t a_timelineID, const PathCache& a_cache, int a_rotationCount) {
+        // Translation times are only cached for timelines whose keyframes were all created through the model
+        return !a_cache.keyframeTimes.empty() && a_rotationCount >= 0 &&
+               GetModel(a_timelineID).GetRotations().size() == static_cast<size_t>(a_rotationCount);
+    }
+
+    void TimelineManager::BuildScrubber(size_t a_timelineID, PathCache& a_cache, int a_rotationCount) {
+        // Positions come from the cache so they match the drawn path. Times, flags and modes are only known for
+        // timelines whose keyframes were all created through the model; other timelines are previewed with evenly
+        // spaced cubic keyframes.
+        const auto& model = GetModel(a_timelineID);
+        const size_t translationCount = a_cache.translationPoints.size();
+        const bool hasModelTimes = !a_cache.keyframeTimes.empty();
+
+        std::vector<float> translationTimes;
+        std::vector<std::array<float, 3>> translationValues;
+        translationValues.reserve(translationCount);
+        for (const auto& point : a_cache.translationPoints) {
+            translationValues.push_back({ point.x, point.y, point.z });
+        }
+        if (hasModelTimes) {
+            translationTimes = a_cache.keyframeTimes;
+        } else {
+            for (size_t i = 0; i < translationCount; ++i) {
+                translationTimes.push_back(static_cast<float>(i) * kScrubKeyframeSpacing);
+            }
+        }
+
+        const size_t rotationCount = a_rotationCount > 0 ? static_cast<size_t>(a_rotationCount) : 0;
+        const bool hasRotationTimes = HasRotationTimes(a_timelineID, a_cache, a_rotationCount);
+        std::vector<float> rotationTimes;
+        std::vector<std::array<float, 2>> rotationValues;
+        std::vector<uint8_t> rotationFlags;
+        std::vector<InterpolationMode> rotationModes;
+        auto handle = SKSE::GetPluginHandle();
+        rotationValues.reserve(rotationCount);
+        for (size_t i = 0; i < rotationCount; ++i) {
+            const RE::BSTPoint2<float> rotation = APIs::FCFW->GetRotationPoint(handle, a_timelineID, i);
+            rotationValues.push_back({ rotation.x, rotation.y });
+        }
+        if (hasRotationTimes) {
+            model.GetRotations().ForEach([&](const RotationKeyframe& a_keyframe) {
+                rotationTimes.push_back(a_keyframe.time);
+                rotationFlags.push_back(a_keyframe.flags);
+                rotationModes.push_back(a_keyframe.mode);
+            });
+        } else if (!translationTimes.empty()) {
+            // Spread over the translation track, like the rotation gizmos
+            const float start = translationTimes.front();
+            const float length = translationTimes.back() - start;
+            for (size_t i = 0; i < rotationCount; ++i) {
+                const float fraction = rotationCount > 1 ? static_cast<float>(i) / static_cast<float>(rotationCount - 1) : 0.f;
+                rotationTimes.push_back(start + length * fraction);
+            }
+        } else {
+            rotationValues.clear();
+        }
+
+        a_cache.scrubber.Build({ translationTimes, translationValues, a_cache.keyframeFlags, a_cache.keyframeModes },
+                               { rotationTimes, rotationValues, rotationFlags, rotationModes }, a_cache.version);
+
+        log::debug("{}: Built scrub spans for timeline {} ({}), {:.2f} s", __FUNCTION__, a_timelineID,
+                   hasModelTimes ? "keyframe times" : "even spacing", a_cache.scrubber.GetEndTime() - a_cache.scrubber.GetStartTime());
+    }
+
+    void TimelineManager::DrawScrubPreview(const EditorState& a_state, PathCache& a_cache, int a_rotationCount) {
+        if (!m_scrub.isActive || m_scrub.timelineID != a_state.timelineID) {
+            return;
+        }
+
+        if (!a_cache.scrubber.IsCurrent(a_cache.version)) {
+            BuildScrubber(a_state.timelineID, a_cache, a_rotationCount);
+        }
+
+        m_scrub.time = std::clamp(m_scrub.time, a_cache.scrubber.GetStartTime(), a_cache.scrubber.GetEndTime());
+        TimelineScrubber::Sample sample;
+        if (!a_cache.scrubber.Evaluate(m_scrub.time, sample)) {
+            return;
+        }
+
+        // Camera ghost at the scrubbed time, redrawn every frame while scrubbing
+        DrawScheduler::GetSingleton().Enqueue(DrawScheduler::Producer::kOverlay, kScrubPreviewKey, sample.position, kScrubPreviewLength, 2, [sample]() {
+            APIs::TrueHUD->DrawPoint(sample.position, kHighlightMarkerSize, RetainedDrawer::kImmediate, kScrubPreviewColor);
+            if (sample.hasRotation) {
+                const RE::NiPoint3 direction = ViewFrustum::GetDirection(sample.pitch, sample.yaw);
+                APIs::TrueHUD->DrawCone(sample.position, direction, kScrubPreviewLength, 0.5f, 0.3f, 12, RetainedDrawer::kImmediate, kScrubPreviewColor, 1.f);
+            }
+        });
+    }
+
+    bool TimelineManager::RetimeConstantSpeed() {
+        if (m_drag.isActive) {
+            EndDrag();
+        }
+
+        const auto state = GetState();
+        const size_t timelineID = state->timelineID;
+        if (!APIs::FCFW || !m_registry.Contains(timelineID)) {
+            return false;
+        }
+
+        const auto& cache = GetPathCache(*state);
+        if (cache.keyframeTimes.size() < 2) {
+            RE::DebugNotification("Only timelines created in the editor can be retimed");
+            return false;
+        }
+
+        const auto& table = cache.arcLength;
+        const float totalLength = table.GetTotalLength();
+        if (totalLength <= 0.f) {
+            return false;
+        }
+
+        // Keyframe times proportional to the distance travelled; rotation keyframes move along with their neighbours
+        const std::vector<float>& from = cache.keyframeTimes;
+        const float start = from.front();
+        const float duration = from.back() - start;
+        std::vector<float> to(from.size());
+        for (size_t i = 0; i < from.size(); ++i) {
+            to[i] = start + duration * table.GetKeyframeDistance(i) / totalLength;
+        }
+
+        GetModel(timelineID).RemapTimes(from, to);
+        return CommitModel(timelineID);
+    }
+
+    void TimelineManager::ReadKeyframeTiming(size_t a_timelineID, PathCache& a_cache) {
+        a_cache.keyframeTimes.clear();
+        a_cache.keyframeFlags.clear();
+        a_cache.keyframeModes.clear();
+
+        // Only known for timelines whose keyframes were all created through the model
+        const auto& model = GetModel(a_timelineID);
+        if (model.IsExternallyModified() || model.GetTranslations().size() != a_cache.translationPoints.size()) {
+            return;
+        }
+
+        model.GetTranslations().ForEach([&](const TranslationKeyframe& a_keyframe) {
+            a_cache.keyframeTimes.push_back(a_keyframe.time);
+            a_cache.keyframeFlags.push_back(a_keyframe.flags);
+            a_cache.keyframeModes.push_back(a_keyframe.mode);
+        });
+    }
+
+    void TimelineManager::BuildDistanceOverlay(PathCache& a_cache, bool a_updateReferenceSpeed) {
+        const auto& table = a_cache.arcLength;
+        const size_t segmentCount = table.GetSegmentCount();
+        const auto& times = a_cache.keyframeTimes;
+
+        // While dragging the reference speed is kept, so the colours of runs that are not redrawn stay valid
+        a_cache.segmentColors.clear();
+        if (times.size() == segmentCount + 1 && segmentCount > 0) {
+            if (a_updateReferenceSpeed) {
+                const float duration = times.back() - times.front();
+                a_cache.referenceSpeed = duration > 0.f ? table.GetTotalLength() / duration : 0.f;
+            }
+            a_cache.segmentColors.resize(segmentCount);
+            for (size_t i = 0; i < segmentCount; ++i) {
+                a_cache.segmentColors[i] = GetSpeedColor(table.GetSegmentLength(i), times[i + 1] - times[i], a_cache.referenceSpeed);
+            }
+        }
+
+        a_cache.distanceTicks.clear();
+        const float totalLength = table.GetTotalLength();
+        float spacing = kTickSpacing;
+        while (totalLength / spacing > static_cast<float>(kMaxTicks)) {
+            spacing *= 2.f;
+        }
+        for (size_t i = 1; static_cast<float>(i) * spacing < totalLength; ++i) {
+            size_t segment = 0;
+            float t = 0.f;
+            table.Locate(static_cast<float>(i) * spacing, segment, t);
+            a_cache.distanceTicks.push_back(EvaluatePath(a_cache.translationPoints, a_cache.keyframeModes, segment, t, false, false));
+        }
+        ++a_cache.overlayRevision;
+    }
+
+    void TimelineManager::DrawDistanceTicks(const PathCache& a_cache, const ViewFrustum& a_frustum) {
+        auto& scheduler = DrawScheduler::GetSingleton();
+        const uint64_t version = (static_cast<uint64_t>(a_cache.version) << 32) | a_cache.overlayRevision;
+        const std::span<const RE::NiPoint3> ticks = a_cache.distanceTicks;
+        for (size_t first = 0; first < ticks.size(); first += kTicksPerBatch) {
+            const uint64_t key = kTickKeyBase | (first / kTicksPerBatch);
+            if (!m_pathDrawer.NeedsSubmit(key, version)) {
+                continue;
+            }
+
+            const auto batch = ticks.subspan(first, std::min(kTicksPerBatch, ticks.size() - first));
+            const RE::NiPoint3 center = (batch.front() + batch.back()) * 0.5f;
+            float radius = 0.f;
+            for (const auto& tick : batch) {
+                radius = std::max(radius, tick.GetDistance(center));
+            }
+            if (!a_frustum.IsSphereVisible(center, radius)) {
+                continue;
+            }
+
+            // A drag moves every tick after the dragged keyframe along the path
+            const float lifetime = m_drag.isActive ? RetainedDrawer::kImmediate : m_pathDrawer.GetLifetime(key, version);
+            scheduler.Enqueue(DrawScheduler::Producer::kKeyframes, key, center, radius, static_cast<uint32_t>(batch.size()), [this, batch, key, version, lifetime]() {
+                for (const auto& tick : batch) {
+                    APIs::TrueHUD->DrawPoint(tick, kTickMarkerSize, lifetime, kTickColor);
+                }
+                m_pathDrawer.MarkSubmitted(key, version, lifetime);
+            });
+        }
+    }
+
+    uint32_t TimelineManager::GetSpeedColor(float a_length, float a_duration, float a_referenceSpeed) {
+        if (a_referenceSpeed <= 0.f) {
+            return kPathColor;
+        }
+
+        // Blue below the reference speed, green at it, red above; saturates at half and twice the reference
+        const float speed = a_duration > 0.f ? a_length / a_duration : (a_length > 0.f ? std::numeric_limits<float>::infinity() : a_referenceSpeed);
+        const float x = std::clamp(std::log2(speed / a_referenceSpeed), -1.f, 1.f);
+        const auto channel = [](float a_value) { return static_cast<uint32_t>(std::clamp(a_value, 0.f, 1.f) * 255.f + 0.5f); };
+        const uint32_t red = channel(x);
+        const uint32_t green = channel(1.f - std::abs(x));
+        const uint32_t blue = channel(-x);
+        return (red << 24) | (green << 16) | (blue << 8) | 0xFF;
+    }
+
+    void TimelineManager::DrawRotationGizmos(const EditorState& a_state, PathCache& a_cache, int a_rotationCount, const ViewFrustum& a_frustum) {
+        if (!a_cache.gizmos.IsCurrent(a_rotationCount, a_cache.version)) {
+            // With their times known, gizmos sit where the camera is at the rotation keyframes, as scrubbing shows it
+            std::vector<float> rotationTimes;
+            if (HasRotationTimes(a_state.timelineID, a_cache, a_rotationCount)) {
+                if (!a_cache.scrubber.IsCurrent(a_cache.version)) {
+                    BuildScrubber(a_state.timelineID, a_cache, a_rotationCount);
+                }
+                rotationTimes.reserve(static_cast<size_t>(a_rotationCount));
+                GetModel(a_state.timelineID).GetRotations().ForEach([&rotationTimes](const RotationKeyframe& a_keyframe) {
+                    rotationTimes.push_back(a_keyframe.time);
+                });
+            }
+            a_cache.gizmos.Rebuild(a_state.timelineID, a_rotationCount, a_cache.translationPoints, a_cache.scrubber, rotationTimes, a_cache.version);
+        }
+
+        auto& scheduler = DrawScheduler::GetSingleton();
+        const uint64_t version = a_cache.gizmos.GetVersion();
+        a_cache.gizmos.GetVisible(a_frustum, kMaxGizmosPerFrame, m_visibleGizmos);
+        for (uint32_t index : m_visibleGizmos) {
+            const uint64_t key = kGizmoKeyBase | index;
+            if (!m_pathDrawer.NeedsSubmit(key, version)) {
+                continue;
+            }
+
+            const auto& instance = a_cache.gizmos.GetInstance(index);
+            const float lifetime = m_pathDrawer.GetLifetime(key, version);
+            scheduler.Enqueue(DrawScheduler::Producer::kGizmos, key, instance.position, RotationGizmos::kArrowLength, 1, [this, instance, key, version, lifetime]() {
+                APIs::TrueHUD->DrawArrow(instance.position, instance.position + instance.direction * RotationGizmos::kArrowLength, 10.f, lifetime, kGizmoColor);
+                m_pathDrawer.MarkSubmitted(key, version, lifetime);
+            });
         }
     }
 } // namespace FCSE
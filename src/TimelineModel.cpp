@@ -0,0 +1,553 @@
+#include "TimelineModel.h"
+#include "ReferenceResolver.h"
+
+namespace FCSE {
+
+    template <size_t N>
+    Keyframe<N> KeyframeTrack<N>::Chunk::Get(size_t a_index) const {
+        Keyframe<N> keyframe;
+        keyframe.time = times[a_index];
+        for (size_t c = 0; c < N; ++c) {
+            keyframe.value[c] = values[c][a_index];
+        }
+        keyframe.flags = flags[a_index];
+        keyframe.mode = modes[a_index];
+        keyframe.reference = references[a_index];
+        return keyframe;
+    }
+
+    template <size_t N>
+    void KeyframeTrack<N>::Chunk::Set(size_t a_index, const Keyframe<N>& a_keyframe) {
+        times[a_index] = a_keyframe.time;
+        for (size_t c = 0; c < N; ++c) {
+            values[c][a_index] = a_keyframe.value[c];
+        }
+        flags[a_index] = a_keyframe.flags;
+        modes[a_index] = a_keyframe.mode;
+        references[a_index] = a_keyframe.reference;
+    }
+
+    template <size_t N>
+    std::pair<size_t, size_t> KeyframeTrack<N>::Locate(size_t a_index) const {
+        size_t chunk = 0;
+        while (a_index >= m_chunks[chunk]->count) {
+            a_index -= m_chunks[chunk]->count;
+            ++chunk;
+        }
+        return { chunk, a_index };
+    }
+
+    template <size_t N>
+    Keyframe<N> KeyframeTrack<N>::Get(size_t a_index) const {
+        const auto [chunk, offset] = Locate(a_index);
+        return m_chunks[chunk]->Get(offset);
+    }
+
+    template <size_t N>
+    void KeyframeTrack<N>::Set(size_t a_index, const Keyframe<N>& a_keyframe) {
+        const auto [chunk, offset] = Locate(a_index);
+        GetMutableChunk(chunk).Set(offset, a_keyframe);
+    }
+
+    template <size_t N>
+    typename KeyframeTrack<N>::Chunk& KeyframeTrack<N>::GetMutableChunk(size_t a_index) {
+        auto& chunk = m_chunks[a_index];
+        if (chunk.use_count() > 1) {
+            chunk = std::make_shared<Chunk>(*chunk);
+        } else {
+            // use_count is a relaxed load. The last other owner may have been a snapshot released on the exporter's
+            // thread; the fence orders its reads of the chunk before the edits made here.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *chunk;
+    }
+
+    template <size_t N>
+    size_t KeyframeTrack<N>::Insert(const Keyframe<N>& a_keyframe) {
+        if (m_chunks.empty() || a_keyframe.time >= GetLastTime()) {
+            Append(a_keyframe);
+            return m_size - 1;
+        }
+
+        // After existing keyframes with the same time, like FCFW does
+        size_t chunkIndex = 0;
+        size_t index = 0;
+        while (m_chunks[chunkIndex]->times[m_chunks[chunkIndex]->count - 1] <= a_keyframe.time) {
+            index += m_chunks[chunkIndex]->count;
+            ++chunkIndex;
+        }
+
+        if (m_chunks[chunkIndex]->count == kChunkSize) {
+            // Split the full chunk in halves, the keyframe goes into whichever half covers its time
+            const Chunk& full = *m_chunks[chunkIndex];
+            auto lower = std::make_shared<Chunk>();
+            auto upper = std::make_shared<Chunk>();
+            for (uint32_t i = 0; i < kChunkSize / 2; ++i) {
+                lower->Set(i, full.Get(i));
+                upper->Set(i, full.Get(i + kChunkSize / 2));
+            }
+            lower->count = upper->count = kChunkSize / 2;
+            m_chunks[chunkIndex] = std::move(lower);
+            m_chunks.insert(m_chunks.begin() + chunkIndex + 1, std::move(upper));
+
+            if (m_chunks[chunkIndex]->times[kChunkSize / 2 - 1] <= a_keyframe.time) {
+                index += kChunkSize / 2;
+                ++chunkIndex;
+            }
+        }
+
+        Chunk& chunk = GetMutableChunk(chunkIndex);
+        const size_t offset = static_cast<size_t>(std::upper_bound(chunk.times.begin(), chunk.times.begin() + chunk.count, a_keyframe.time) - chunk.times.begin());
+        for (size_t i = chunk.count; i > offset; --i) {
+            chunk.Set(i, chunk.Get(i - 1));
+        }
+        chunk.Set(offset, a_keyframe);
+        ++chunk.count;
+        ++m_size;
+        return index + offset;
+    }
+
+    template <size_t N>
+    void KeyframeTrack<N>::Append(const Keyframe<N>& a_keyframe) {
+        if (m_chunks.empty() || m_chunks.back()->count == kChunkSize) {
+            m_chunks.push_back(std::make_shared<Chunk>());
+        }
+
+        Chunk& chunk = GetMutableChunk(m_chunks.size() - 1);
+        chunk.Set(chunk.count, a_keyframe);
+        ++chunk.count;
+        ++m_size;
+    }
+
+    template <size_t N>
+    void KeyframeTrack<N>::Erase(size_t a_index) {
+        const auto [chunkIndex, offset] = Locate(a_index);
+        if (m_chunks[chunkIndex]->count == 1) {
+            m_chunks.erase(m_chunks.begin() + chunkIndex);
+        } else {
+            Chunk& chunk = GetMutableChunk(chunkIndex);
+            for (size_t i = offset + 1; i < chunk.count; ++i) {
+                chunk.Set(i - 1, chunk.Get(i));
+            }
+            --chunk.count;
+        }
+        --m_size;
+    }
+
+    template <size_t N>
+    void KeyframeTrack<N>::Clear() {
+        m_chunks.clear();
+        m_size = 0;
+    }
+
+    template <size_t N>
+    void KeyframeTrack<N>::SortByTime() {
+        bool isSorted = true;
+        float previousTime = -std::numeric_limits<float>::infinity();
+        for (const auto& chunk : m_chunks) {
+            if (!std::is_sorted(chunk->times.begin(), chunk->times.begin() + chunk->count) || chunk->times[0] < previousTime) {
+                isSorted = false;
+                break;
+            }
+            previousTime = chunk->times[chunk->count - 1];
+        }
+        if (isSorted) {
+            return;
+        }
+
+        std::vector<Keyframe<N>> keyframes;
+        keyframes.reserve(m_size);
+        ForEach([&keyframes](const Keyframe<N>& a_keyframe) {
+            keyframes.push_back(a_keyframe);
+        });
+        std::stable_sort(keyframes.begin(), keyframes.end(), [](const Keyframe<N>& a_lhs, const Keyframe<N>& a_rhs) {
+            return a_lhs.time < a_rhs.time;
+        });
+
+        Clear();
+        for (const auto& keyframe : keyframes) {
+            Append(keyframe);
+        }
+    }
+
+    template class KeyframeTrack<2>;
+    template class KeyframeTrack<3>;
+
+    size_t TimelineModel::AddTranslation(const TranslationKeyframe& a_keyframe) {
+        ++m_version;
+        return m_translations.Insert(a_keyframe);
+    }
+
+    size_t TimelineModel::AddRotation(const RotationKeyframe& a_keyframe) {
+        ++m_version;
+        return m_rotations.Insert(a_keyframe);
+    }
+
+    size_t TimelineModel::SetTranslation(size_t a_index, const TranslationKeyframe& a_keyframe) {
+        ++m_version;
+        if (m_translations.Get(a_index).time == a_keyframe.time) {
+            m_translations.Set(a_index, a_keyframe);
+            return a_index;
+        }
+        m_translations.Erase(a_index);
+        return m_translations.Insert(a_keyframe);
+    }
+
+    bool TimelineModel::RemoveTranslation(size_t a_index) {
+        if (a_index >= m_translations.size()) {
+            return false;
+        }
+        m_translations.Erase(a_index);
+        ++m_version;
+        return true;
+    }
+
+    bool TimelineModel::RemoveRotation(size_t a_index) {
+        if (a_index >= m_rotations.size()) {
+            return false;
+        }
+        m_rotations.Erase(a_index);
+        ++m_version;
+        return true;
+    }
+
+    void TimelineModel::Clear() {
+        m_translations.Clear();
+        m_rotations.Clear();
+        ++m_version;
+    }
+
+    float TimelineModel::GetDuration() const {
+        float duration = 0.f;
+        if (!m_translations.empty()) {
+            duration = m_translations.GetLastTime();
+        }
+        if (!m_rotations.empty()) {
+            duration = std::max(duration, m_rotations.GetLastTime());
+        }
+        return duration;
+    }
+
+    void TimelineModel::Retime(float a_scale, float a_offset) {
+        auto retime = [a_scale, a_offset](auto& a_track) {
+            for (size_t c = 0; c < a_track.GetChunkCount(); ++c) {
+                auto& chunk = a_track.GetMutableChunk(c);
+                for (uint32_t i = 0; i < chunk.count; ++i) {
+                    chunk.times[i] = chunk.times[i] * a_scale + a_offset;
+                }
+            }
+        };
+        retime(m_translations);
+        retime(m_rotations);
+
+        // A negative scale reverses the order
+        m_translations.SortByTime();
+        m_rotations.SortByTime();
+        ++m_version;
+    }
+
+    void TimelineModel::RemapTimes(std::span<const float> a_from, std::span<const float> a_to) {
+        if (a_from.empty() || a_from.size() != a_to.size()) {
+            return;
+        }
+
+        auto remap = [a_from, a_to](float a_time) {
+            if (a_time <= a_from.front()) {
+                return a_time - a_from.front() + a_to.front();
+            }
+            if (a_time >= a_from.back()) {
+                return a_time - a_from.back() + a_to.back();
+            }
+            const size_t i = static_cast<size_t>(std::upper_bound(a_from.begin(), a_from.end(), a_time) - a_from.begin());
+            const float span = a_from[i] - a_from[i - 1];
+            const float fraction = span > 0.f ? (a_time - a_from[i - 1]) / span : 0.f;
+            return a_to[i - 1] + (a_to[i] - a_to[i - 1]) * fraction;
+        };
+        auto retime = [&remap](auto& a_track) {
+            for (size_t c = 0; c < a_track.GetChunkCount(); ++c) {
+                auto& chunk = a_track.GetMutableChunk(c);
+                for (uint32_t i = 0; i < chunk.count; ++i) {
+                    chunk.times[i] = remap(chunk.times[i]);
+                }
+            }
+        };
+        retime(m_translations);
+        retime(m_rotations);
+        ++m_version;
+    }
+
+    void TimelineModel::Translate(const RE::NiPoint3& a_delta) {
+        const std::array<float, 3> delta = { a_delta.x, a_delta.y, a_delta.z };
+        for (size_t k = 0; k < m_translations.GetChunkCount(); ++k) {
+            auto& chunk = m_translations.GetMutableChunk(k);
+            for (size_t c = 0; c < 3; ++c) {
+                for (uint32_t i = 0; i < chunk.count; ++i) {
+                    if (!(chunk.flags[i] & (kKeyframeAtCamera | kKeyframeOffsetRelative))) {
+                        chunk.values[c][i] += delta[c];
+                    }
+                }
+            }
+        }
+        ++m_version;
+    }
+
+    void TimelineModel::Splice(const TimelineModel& a_other, float a_timeOffset) {
+        a_other.m_translations.ForEach([&](TranslationKeyframe a_keyframe) {
+            a_keyframe.time += a_timeOffset;
+            m_translations.Append(a_keyframe);
+        });
+        a_other.m_rotations.ForEach([&](RotationKeyframe a_keyframe) {
+            a_keyframe.time += a_timeOffset;
+            m_rotations.Append(a_keyframe);
+        });
+
+        m_translations.SortByTime();
+        m_rotations.SortByTime();
+        ++m_version;
+    }
+
+    void TimelineModel::Duplicate(float a_begin, float a_end, float a_timeOffset) {
+        // Copy the range first, the appends below would invalidate iteration over the same track
+        TimelineModel range;
+        m_translations.ForEach([&](const TranslationKeyframe& a_keyframe) {
+            if (a_keyframe.time >= a_begin && a_keyframe.time <= a_end) {
+                range.m_translations.Append(a_keyframe);
+            }
+        });
+        m_rotations.ForEach([&](const RotationKeyframe& a_keyframe) {
+            if (a_keyframe.time >= a_begin && a_keyframe.time <= a_end) {
+                range.m_rotations.Append(a_keyframe);
+            }
+        });
+        Splice(range, a_timeOffset);
+    }
+
+    void TimelineModel::Restore(const Snapshot& a_snapshot) {
+        m_translations = a_snapshot.translations;
+        m_rotations = a_snapshot.rotations;
+        ++m_version;
+    }
+
+    void TimelineModel::ResetToEmpty() {
+        m_translations.Clear();
+        m_rotations.Clear();
+        m_syncedTranslations.Clear();
+        m_syncedRotations.Clear();
+        ++m_version;
+        m_syncedVersion = m_version;
+        m_externallyModified = false;
+    }
+
+    template <size_t N>
+    void TimelineModel::Diff(const KeyframeTrack<N>& a_synced, const KeyframeTrack<N>& a_current, std::vector<size_t>& a_removed, std::vector<Keyframe<N>>& a_added) {
+        // Both tracks are sorted by time, so a single merge pass pairs up unchanged keyframes.
+        // A changed keyframe shows up as one removal plus one addition, FCFW has no call to modify a point.
+        typename KeyframeTrack<N>::Cursor synced(a_synced);
+        typename KeyframeTrack<N>::Cursor current(a_current);
+        while (!synced.AtEnd() && !current.AtEnd()) {
+            // Chunks still shared with the synced copy were not touched since
+            if (synced.AtChunkStart() && current.AtChunkStart() && synced.GetChunk() == current.GetChunk()) {
+                synced.SkipChunk();
+                current.SkipChunk();
+                continue;
+            }
+
+            const auto syncedKeyframe = synced.Get();
+            const auto currentKeyframe = current.Get();
+            if (syncedKeyframe == currentKeyframe) {
+                synced.Next();
+                current.Next();
+            } else if (syncedKeyframe.time < currentKeyframe.time) {
+                a_removed.push_back(synced.GetIndex());
+                synced.Next();
+            } else if (currentKeyframe.time < syncedKeyframe.time) {
+                a_added.push_back(currentKeyframe);
+                current.Next();
+            } else {
+                a_removed.push_back(synced.GetIndex());
+                a_added.push_back(currentKeyframe);
+                synced.Next();
+                current.Next();
+            }
+        }
+        for (; !synced.AtEnd(); synced.Next()) {
+            a_removed.push_back(synced.GetIndex());
+        }
+        for (; !current.AtEnd(); current.Next()) {
+            a_added.push_back(current.Get());
+        }
+    }
+
+    template <size_t N>
+    void TimelineModel::ExpandEqualTimes(const KeyframeTrack<N>& a_synced, const KeyframeTrack<N>& a_current, std::vector<size_t>& a_removed, std::vector<Keyframe<N>>& a_added) {
+        // FCFW keeps its points sorted by time, but which of several points with the same time comes first is not part of
+        // its API. A removal index is only trusted if no other synced keyframe shares its time; otherwise every keyframe
+        // at that time is removed and the current ones are added again. a_removed is sorted, so each group comes up once.
+        std::vector<float> tiedTimes;
+        std::vector<size_t> tiedIndices;
+        for (const size_t index : a_removed) {
+            const float time = a_synced.Get(index).time;
+            if (!tiedTimes.empty() && tiedTimes.back() == time) {
+                continue;
+            }
+            size_t first = index;
+            while (first > 0 && a_synced.Get(first - 1).time == time) {
+                --first;
+            }
+            size_t last = index;
+            while (last + 1 < a_synced.size() && a_synced.Get(last + 1).time == time) {
+                ++last;
+            }
+            if (first == last) {
+                continue;
+            }
+            tiedTimes.push_back(time);
+            for (size_t i = first; i <= last; ++i) {
+                tiedIndices.push_back(i);
+            }
+        }
+        if (tiedTimes.empty()) {
+            return;
+        }
+
+        a_removed.insert(a_removed.end(), tiedIndices.begin(), tiedIndices.end());
+        std::sort(a_removed.begin(), a_removed.end());
+        a_removed.erase(std::unique(a_removed.begin(), a_removed.end()), a_removed.end());
+
+        const auto isTied = [&tiedTimes](float a_time) { return std::binary_search(tiedTimes.begin(), tiedTimes.end(), a_time); };
+        std::erase_if(a_added, [&isTied](const Keyframe<N>& a_keyframe) { return isTied(a_keyframe.time); });
+        typename KeyframeTrack<N>::Cursor current(a_current);
+        while (!current.AtEnd()) {
+            // Chunks between the tied times have nothing to add
+            if (current.AtChunkStart()) {
+                const auto* chunk = current.GetChunk();
+                const auto next = std::lower_bound(tiedTimes.begin(), tiedTimes.end(), chunk->times[0]);
+                if (next == tiedTimes.end() || *next > chunk->times[chunk->count - 1]) {
+                    current.SkipChunk();
+                    continue;
+                }
+            }
+            if (isTied(current.GetTime())) {
+                a_added.push_back(current.Get());
+            }
+            current.Next();
+        }
+        std::stable_sort(a_added.begin(), a_added.end(), [](const Keyframe<N>& a_lhs, const Keyframe<N>& a_rhs) { return a_lhs.time < a_rhs.time; });
+    }
+
+    bool TimelineModel::SendTranslation(const FCFW_API::IVFCFW1& a_api, SKSE::PluginHandle a_handle, size_t a_timelineID, const TranslationKeyframe& a_keyframe) {
+        const bool easeIn = a_keyframe.flags & kKeyframeEaseIn;
+        const bool easeOut = a_keyframe.flags & kKeyframeEaseOut;
+        const int mode = static_cast<int>(a_keyframe.mode);
+        const RE::NiPoint3 value = { a_keyframe.value[0], a_keyframe.value[1], a_keyframe.value[2] };
+
+        if (a_keyframe.flags & kKeyframeAtCamera) {
+            return a_api.AddTranslationPointAtCamera(a_handle, a_timelineID, a_keyframe.time, easeIn, easeOut, mode) >= 0;
+        }
+        if (a_keyframe.reference != 0) {
+            auto* reference = ReferenceResolver::GetSingleton().GetReference(a_keyframe.reference);
+            if (!reference) {
+                return false;
+            }
+            return a_api.AddTranslationPointAtRef(a_handle, a_timelineID, a_keyframe.time, reference, value, a_keyframe.flags & kKeyframeOffsetRelative, easeIn, easeOut, mode) >= 0;
+        }
+        return a_api.AddTranslationPoint(a_handle, a_timelineID, a_keyframe.time, value, easeIn, easeOut, mode) >= 0;
+    }
+
+    bool TimelineModel::SendRotation(const FCFW_API::IVFCFW1& a_api, SKSE::PluginHandle a_handle, size_t a_timelineID, const RotationKeyframe& a_keyframe) {
+        const bool easeIn = a_keyframe.flags & kKeyframeEaseIn;
+        const bool easeOut = a_keyframe.flags & kKeyframeEaseOut;
+        const int mode = static_cast<int>(a_keyframe.mode);
+        const RE::BSTPoint2<float> value = { a_keyframe.value[0], a_keyframe.value[1] };
+
+        if (a_keyframe.flags & kKeyframeAtCamera) {
+            return a_api.AddRotationPointAtCamera(a_handle, a_timelineID, a_keyframe.time, easeIn, easeOut, mode) >= 0;
+        }
+        if (a_keyframe.reference != 0) {
+            auto* reference = ReferenceResolver::GetSingleton().GetReference(a_keyframe.reference);
+            if (!reference) {
+                return false;
+            }
+            return a_api.AddRotationPointAtRef(a_handle, a_timelineID, a_keyframe.time, reference, value, a_keyframe.flags & kKeyframeOffsetRelative, easeIn, easeOut, mode) >= 0;
+        }
+        return a_api.AddRotationPoint(a_handle, a_timelineID, a_keyframe.time, value, easeIn, easeOut, mode) >= 0;
+    }
+
+    TimelineModel::SyncStats TimelineModel::Sync(const FCFW_API::IVFCFW1& a_api, SKSE::PluginHandle a_handle, size_t a_timelineID) {
+        SyncStats stats;
+        if (!IsDirty()) {
+            return stats;
+        }
+
+        std::vector<size_t> removedTranslations, removedRotations;
+        std::vector<TranslationKeyframe> addedTranslations;
+        std::vector<RotationKeyframe> addedRotations;
+        Diff(m_syncedTranslations, m_translations, removedTranslations, addedTranslations);
+        Diff(m_syncedRotations, m_rotations, removedRotations, addedRotations);
+        ExpandEqualTimes(m_syncedTranslations, m_translations, removedTranslations, addedTranslations);
+        ExpandEqualTimes(m_syncedRotations, m_rotations, removedRotations, addedRotations);
+
+        // Clearing is a single call when everything goes, and the only safe option when
+        // the synced indices are stale
+        const size_t syncedCount = m_syncedTranslations.size() + m_syncedRotations.size();
+        const bool removesAll = removedTranslations.size() + removedRotations.size() == syncedCount && syncedCount > 1;
+        const bool indicesStale = m_externallyModified && !(removedTranslations.empty() && removedRotations.empty());
+        if (removesAll || indicesStale) {
+            if (indicesStale) {
+                log::warn("{}: Timeline {} was changed outside the editor, rewriting it from the local model", __FUNCTION__, a_timelineID);
+            }
+
+            stats.rewritten = true;
+            stats.removed = static_cast<uint32_t>(syncedCount);
+            if (!a_api.ClearTimeline(a_handle, a_timelineID)) {
+                ++stats.failed;
+            }
+            m_externallyModified = false;
+
+            addedTranslations.clear();
+            m_translations.ForEach([&addedTranslations](const TranslationKeyframe& a_keyframe) {
+                addedTranslations.push_back(a_keyframe);
+            });
+            addedRotations.clear();
+            m_rotations.ForEach([&addedRotations](const RotationKeyframe& a_keyframe) {
+                addedRotations.push_back(a_keyframe);
+            });
+        } else {
+            // Back to front so the remaining synced indices stay valid
+            for (auto it = removedTranslations.rbegin(); it != removedTranslations.rend(); ++it) {
+                if (!a_api.RemoveTranslationPoint(a_handle, a_timelineID, *it)) {
+                    ++stats.failed;
+                }
+            }
+            for (auto it = removedRotations.rbegin(); it != removedRotations.rend(); ++it) {
+                if (!a_api.RemoveRotationPoint(a_handle, a_timelineID, *it)) {
+                    ++stats.failed;
+                }
+            }
+            stats.removed = static_cast<uint32_t>(removedTranslations.size() + removedRotations.size());
+        }
+
+        for (const auto& keyframe : addedTranslations) {
+            if (!SendTranslation(a_api, a_handle, a_timelineID, keyframe)) {
+                ++stats.failed;
+            }
+        }
+        for (const auto& keyframe : addedRotations) {
+            if (!SendRotation(a_api, a_handle, a_timelineID, keyframe)) {
+                ++stats.failed;
+            }
+        }
+        stats.added = static_cast<uint32_t>(addedTranslations.size() + addedRotations.size());
+
+        m_syncedTranslations = m_translations;
+        m_syncedRotations = m_rotations;
+        m_syncedVersion = m_version;
+        if (stats.failed > 0) {
+            // FCFW no longer matches the synced copy
+            m_externallyModified = true;
+        }
+
+        log::debug("{}: Synced timeline {}: {} removed, {} added, {} failed{}", __FUNCTION__, a_timelineID, stats.removed, stats.added, stats.failed, stats.rewritten ? " (rewritten)" : "");
+        return stats;
+    }
+} // namespace FCSE
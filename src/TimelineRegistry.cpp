@@ -0,0 +1,136 @@
+#include "TimelineRegistry.h"
+
+namespace FCSE {
+
+    TimelineInfo& TimelineRegistry::Add(size_t a_timelineID) {
+        if (auto* info = Find(a_timelineID)) {
+            return *info;
+        }
+
+        m_indices.emplace(a_timelineID, m_entries.size());
+        auto& info = m_entries.emplace_back();
+        info.timelineID = a_timelineID;
+        return info;
+    }
+
+    bool TimelineRegistry::Remove(size_t a_timelineID) {
+        auto it = m_indices.find(a_timelineID);
+        if (it == m_indices.end()) {
+            return false;
+        }
+
+        // Keep registration order for cycling; the registry only holds a handful of entries
+        const size_t index = it->second;
+        m_indices.erase(it);
+        m_entries.erase(m_entries.begin() + index);
+        for (size_t i = index; i < m_entries.size(); ++i) {
+            m_indices[m_entries[i].timelineID] = i;
+        }
+        return true;
+    }
+
+    TimelineInfo* TimelineRegistry::Find(size_t a_timelineID) {
+        auto it = m_indices.find(a_timelineID);
+        return it != m_indices.end() ? &m_entries[it->second] : nullptr;
+    }
+
+    const TimelineInfo* TimelineRegistry::Find(size_t a_timelineID) const {
+        auto it = m_indices.find(a_timelineID);
+        return it != m_indices.end() ? &m_entries[it->second] : nullptr;
+    }
+
+    size_t TimelineRegistry::GetNext(size_t a_timelineID) const {
+        if (m_entries.empty()) {
+            return 0;
+        }
+
+        auto it = m_indices.find(a_timelineID);
+        if (it == m_indices.end()) {
+            return m_entries.front().timelineID;
+        }
+        return m_entries[(it->second + 1) % m_entries.size()].timelineID;
+    }
+
+    size_t TimelineRegistry::GetPrevious(size_t a_timelineID) const {
+        if (m_entries.empty()) {
+            return 0;
+        }
+
+        auto it = m_indices.find(a_timelineID);
+        if (it == m_indices.end()) {
+            return m_entries.front().timelineID;
+        }
+        return m_entries[(it->second + m_entries.size() - 1) % m_entries.size()].timelineID;
+    }
+
+    void TimelineRegistry::Refresh(size_t a_timelineID, int a_translationCount, int a_rotationCount, std::span<const RE::NiPoint3> a_translationPoints) {
+        auto* info = Find(a_timelineID);
+        if (!info) {
+            return;
+        }
+
+        info->translationCount = a_translationCount;
+        info->rotationCount = a_rotationCount;
+        info->boundsMin = {};
+        info->boundsMax = {};
+        if (!a_translationPoints.empty()) {
+            info->boundsMin = info->boundsMax = a_translationPoints.front();
+            for (const auto& point : a_translationPoints) {
+                info->boundsMin = { std::min(info->boundsMin.x, point.x), std::min(info->boundsMin.y, point.y), std::min(info->boundsMin.z, point.z) };
+                info->boundsMax = { std::max(info->boundsMax.x, point.x), std::max(info->boundsMax.y, point.y), std::max(info->boundsMax.z, point.z) };
+            }
+        }
+        ++info->version;
+    }
+
+    void TimelineRegistry::SetDuration(size_t a_timelineID, float a_duration) {
+        if (auto* info = Find(a_timelineID); info && a_duration != info->duration) {
+            info->duration = a_duration;
+            ++info->version;
+        }
+    }
+
+    void TimelineRegistry::SetSourceFile(size_t a_timelineID, std::string_view a_path) {
+        if (auto* info = Find(a_timelineID)) {
+            info->sourceFile = a_path;
+            ++info->version;
+        }
+    }
+
+    void TimelineRegistry::ResetMetadata(size_t a_timelineID) {
+        if (auto* info = Find(a_timelineID)) {
+            const uint32_t version = info->version;
+            const PlaybackState playbackState = info->playbackState;
+            *info = TimelineInfo{};
+            info->timelineID = a_timelineID;
+            info->version = version + 1;
+            info->playbackState = playbackState;
+        }
+    }
+
+    void TimelineRegistry::SetPlaybackState(size_t a_timelineID, PlaybackState a_state) {
+        if (auto* info = Find(a_timelineID)) {
+            info->playbackState = a_state;
+        }
+    }
+
+    bool TimelineRegistry::ApplyPlaybackMessage(size_t a_timelineID, FCFW_API::FCFWMessage a_message) {
+        auto* info = Find(a_timelineID);
+        if (!info) {
+            return false;
+        }
+
+        switch (a_message) {
+        case FCFW_API::FCFWMessage::kPlaybackStart:
+            info->playbackState = PlaybackState::kPlaying;
+            return false;
+        case FCFW_API::FCFWMessage::kPlaybackStop:
+            info->playbackState = PlaybackState::kIdle;
+            return true;
+        case FCFW_API::FCFWMessage::kPlaybackWait:
+            info->playbackState = PlaybackState::kWaiting;
+            return true;
+        }
+        return false;
+    }
+} // namespace FCSE
@@ -0,0 +1,136 @@
+#include "TimelineScrubber.h"
+
+namespace FCSE {
+
+    template <size_t N>
+    void TimelineScrubber::CubicTrack<N>::Build(const TrackInput<N>& a_input) {
+        Clear();
+
+        const size_t count = a_input.times.size();
+        if (count == 0) {
+            return;
+        }
+
+        m_endTime = a_input.times.back();
+        if (count == 1) {
+            Span span{};
+            span.coefficients[0] = a_input.values[0];
+            m_startTimes.push_back(a_input.times[0]);
+            m_spans.push_back(span);
+            return;
+        }
+
+        m_startTimes.reserve(count - 1);
+        m_spans.reserve(count - 1);
+        for (size_t i = 0; i + 1 < count; ++i) {
+            const auto& p0 = a_input.values[i > 0 ? i - 1 : i];
+            const auto& p1 = a_input.values[i];
+            const auto& p2 = a_input.values[i + 1];
+            const auto& p3 = a_input.values[i + 2 < count ? i + 2 : i + 1];
+
+            // Like FCFW, the mode and ease flags of the end keyframe apply to the incoming segment
+            const InterpolationMode mode = a_input.modes.empty() ? InterpolationMode::kCubicHermite : a_input.modes[i + 1];
+            const uint8_t flags = a_input.flags.empty() ? 0 : a_input.flags[i + 1];
+
+            Span span{};
+            for (size_t c = 0; c < N; ++c) {
+                span.coefficients[0][c] = p1[c];
+                switch (mode) {
+                case InterpolationMode::kNone:
+                    break;
+                case InterpolationMode::kLinear:
+                    span.coefficients[1][c] = p2[c] - p1[c];
+                    break;
+                default: {
+                    // Hermite basis with Catmull-Rom tangents, expanded into powers of u
+                    const float m1 = (p2[c] - p0[c]) * 0.5f;
+                    const float m2 = (p3[c] - p1[c]) * 0.5f;
+                    span.coefficients[1][c] = m1;
+                    span.coefficients[2][c] = 3.f * (p2[c] - p1[c]) - 2.f * m1 - m2;
+                    span.coefficients[3][c] = 2.f * (p1[c] - p2[c]) + m1 + m2;
+                    break;
+                }
+                }
+            }
+
+            const float duration = a_input.times[i + 1] - a_input.times[i];
+            span.inverseDuration = duration > 0.f ? 1.f / duration : 0.f;
+            span.easeIn = flags & kKeyframeEaseIn;
+            span.easeOut = flags & kKeyframeEaseOut;
+
+            m_startTimes.push_back(a_input.times[i]);
+            m_spans.push_back(span);
+        }
+    }
+
+    template <size_t N>
+    void TimelineScrubber::CubicTrack<N>::Clear() {
+        m_startTimes.clear();
+        m_spans.clear();
+        m_endTime = 0.f;
+    }
+
+    template <size_t N>
+    void TimelineScrubber::CubicTrack<N>::Evaluate(float a_time, std::array<float, N>& a_out) const {
+        const auto it = std::upper_bound(m_startTimes.begin(), m_startTimes.end(), a_time);
+        const size_t index = it == m_startTimes.begin() ? 0 : static_cast<size_t>(it - m_startTimes.begin()) - 1;
+        const Span& span = m_spans[index];
+
+        float u = span.inverseDuration > 0.f ? (a_time - m_startTimes[index]) * span.inverseDuration : (a_time >= m_startTimes[index] ? 1.f : 0.f);
+        u = ApplyEasing(std::clamp(u, 0.f, 1.f), span.easeIn, span.easeOut);
+
+        for (size_t c = 0; c < N; ++c) {
+            a_out[c] = span.coefficients[0][c] + u * (span.coefficients[1][c] + u * (span.coefficients[2][c] + u * span.coefficients[3][c]));
+        }
+    }
+
+    void TimelineScrubber::Build(const TrackInput<3>& a_translations, const TrackInput<2>& a_rotations, uint32_t a_version) {
+        m_translations.Build(a_translations);
+
+        // Unwrap yaw so interpolation takes the short way around
+        std::vector<std::array<float, 2>> rotations(a_rotations.values.begin(), a_rotations.values.end());
+        constexpr float twoPi = 2.f * std::numbers::pi_v<float>;
+        for (size_t i = 1; i < rotations.size(); ++i) {
+            const float delta = rotations[i][1] - rotations[i - 1][1];
+            rotations[i][1] -= twoPi * std::round(delta / twoPi);
+        }
+        TrackInput<2> rotationInput = a_rotations;
+        rotationInput.values = rotations;
+        m_rotations.Build(rotationInput);
+
+        m_startTime = m_translations.IsEmpty() ? 0.f : m_translations.GetFirstTime();
+        m_endTime = m_translations.IsEmpty() ? 0.f : m_translations.GetLastTime();
+        if (!m_rotations.IsEmpty()) {
+            m_startTime = std::min(m_startTime, m_rotations.GetFirstTime());
+            m_endTime = std::max(m_endTime, m_rotations.GetLastTime());
+        }
+        m_version = a_version;
+        m_isValid = true;
+    }
+
+    void TimelineScrubber::Clear() {
+        m_translations.Clear();
+        m_rotations.Clear();
+        m_startTime = m_endTime = 0.f;
+        m_isValid = false;
+    }
+
+    bool TimelineScrubber::Evaluate(float a_time, Sample& a_out) const {
+        if (m_translations.IsEmpty()) {
+            return false;
+        }
+
+        std::array<float, 3> position;
+        m_translations.Evaluate(a_time, position);
+        a_out.position = { position[0], position[1], position[2] };
+
+        a_out.hasRotation = !m_rotations.IsEmpty();
+        if (a_out.hasRotation) {
+            std::array<float, 2> rotation;
+            m_rotations.Evaluate(a_time, rotation);
+            a_out.pitch = rotation[0];
+            a_out.yaw = rotation[1];
+        }
+        return true;
+    }
+} // namespace FCSE
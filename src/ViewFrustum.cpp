@@ -0,0 +1,60 @@
+#include "ViewFrustum.h"
+
+namespace FCSE {
+
+    bool ViewFrustum::FromPlayerCamera(const RE::PlayerCamera* a_playerCamera) {
+        if (!a_playerCamera || !a_playerCamera->currentState || a_playerCamera->currentState->id != RE::CameraState::kFree) {
+            return false;
+        }
+
+        auto* freeCameraState = static_cast<RE::FreeCameraState*>(a_playerCamera->currentState.get());
+        const float pitch = freeCameraState->rotation.x;
+        const float yaw = freeCameraState->rotation.y;
+
+        m_position = freeCameraState->translation;
+        m_forward = GetDirection(pitch, yaw);
+        const RE::NiPoint3 right(std::cos(yaw), -std::sin(yaw), 0.f);
+        const RE::NiPoint3 up = right.Cross(m_forward);
+
+        // worldFOV is the horizontal field of view in degrees; assume a 1920 pixel wide viewport.
+        // The vertical extent is never larger than the horizontal one, so the horizontal angle is used for both.
+        const float fov = std::clamp(a_playerCamera->worldFOV, 10.f, 150.f);
+        const float halfFOV = fov * 0.5f * std::numbers::pi_v<float> / 180.f;
+        const float halfAngle = std::min(fov * 0.5f + kFOVMarginDegrees, 89.f) * std::numbers::pi_v<float> / 180.f;
+        m_pixelsPerRadian = 960.f / std::tan(halfFOV);
+
+        const float sinA = std::sin(halfAngle);
+        const float cosA = std::cos(halfAngle);
+        const RE::NiPoint3 normals[5] = {
+            m_forward,
+            m_forward * sinA + right * cosA,
+            m_forward * sinA - right * cosA,
+            m_forward * sinA - up * cosA,
+            m_forward * sinA + up * cosA
+        };
+        for (size_t i = 0; i < m_planes.size(); ++i) {
+            m_planes[i].normal = normals[i];
+            m_planes[i].distance = normals[i].Dot(m_position);
+        }
+
+        return true;
+    }
+
+    bool ViewFrustum::IsSphereVisible(const RE::NiPoint3& a_center, float a_radius) const {
+        for (const auto& plane : m_planes) {
+            if (plane.SignedDistance(a_center) < -a_radius) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ViewFrustum::IsSegmentVisible(const RE::NiPoint3& a_start, const RE::NiPoint3& a_end) const {
+        for (const auto& plane : m_planes) {
+            if (plane.SignedDistance(a_start) < 0.f && plane.SignedDistance(a_end) < 0.f) {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace FCSE
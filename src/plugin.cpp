@@ -1,7 +1,11 @@
 #include "ControlsManager.h"
 #include "APIManager.h"
+#include "CameraRecorder.h"
 #include "TimelineManager.h"
 #include "Hooks.h"
+#include "DrawScheduler.h"
+#include "ReferenceResolver.h"
+#include "TakeLibrary.h"
 #include "_ts_SKSEFunctions.h"
 
 /******************************************************************************************/
@@ -11,6 +15,8 @@ void MessageHandler(SKSE::MessagingInterface::Message* a_msg)
 	switch (a_msg->type) {
 	case SKSE::MessagingInterface::kDataLoaded:
 		APIs::RequestAPIs();
+		FCSE::ReferenceResolver::GetSingleton().Register();
+		FCSE::TakeLibrary::GetSingleton().StartScan();
 		break;
 	case SKSE::MessagingInterface::kPostLoad:
 		APIs::RequestAPIs();
@@ -19,6 +25,7 @@ void MessageHandler(SKSE::MessagingInterface::Message* a_msg)
 		APIs::RequestAPIs();
 		break;
 	case SKSE::MessagingInterface::kPreLoadGame:
+		FCSE::ReferenceResolver::GetSingleton().Clear();
 		break;
 	case SKSE::MessagingInterface::kPostLoadGame:
 	case SKSE::MessagingInterface::kNewGame:
@@ -33,6 +40,11 @@ void MessageHandler(SKSE::MessagingInterface::Message* a_msg)
 		break;
 	}
 }
+
+void FCFWMessageHandler(SKSE::MessagingInterface::Message* a_msg)
+{
+	FCSE::TimelineManager::GetSingleton().OnFCFWMessage(a_msg);
+}
 /******************************************************************************************/
 SKSEPluginInfo(
     .Version = Plugin::VERSION,
@@ -43,7 +55,8 @@ SKSEPluginInfo(
 )
 
 extern "C" DLLEXPORT bool SKSEAPI SKSEPlugin_Load(const SKSE::LoadInterface* skse) {
-    long logLevel = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, "LogLevel:Log", "SKSE/Plugins/FreeCameraSceneEditor.ini", 3L);
+    const char* iniPath = "SKSE/Plugins/FreeCameraSceneEditor.ini";
+    long logLevel = _ts_SKSEFunctions::GetValueFromINI(nullptr, 0, "LogLevel:Log", iniPath, 3L);
     bool isLogLevelValid = true;
     if (logLevel < 0 || logLevel > 6) {
         logLevel = 2L; // info
@@ -57,10 +70,18 @@ extern "C" DLLEXPORT bool SKSEAPI SKSEPlugin_Load(const SKSE::LoadInterface* sks
 	if (!messaging->RegisterListener("SKSE", MessageHandler)) {
 		return false;
 	}
+	if (!messaging->RegisterListener(FCFW_API::FCFWPluginName, FCFWMessageHandler)) {
+		log::warn("{}: Could not register listener for FCFW messages", __FUNCTION__);
+	}
 
     if (!isLogLevelValid) {
         log::warn("{}: LogLevel in INI file is invalid. Defaulting to info level.", __FUNCTION__);
     }
+
+    FCSE::DrawScheduler::GetSingleton().LoadSettings(iniPath);
+    FCSE::ControlsManager::GetSingleton().LoadSettings(iniPath);
+    FCSE::TakeLibrary::GetSingleton().LoadSettings(iniPath);
+    FCSE::CameraRecorder::GetSingleton().LoadSettings(iniPath);
 //    log::info("{}: LogLevel: {}, FCSE Plugin version: {}", __FUNCTION__, logLevel, FCSE::Interface::GetFCSEPluginVersion(nullptr));
 
 
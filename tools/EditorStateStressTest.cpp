@@ -0,0 +1,193 @@
+#include "AtomicSnapshot.h"
+#include "MockFCFW.h"
+#include "TimelineRegistry.h"
+#include "ToolCheck.h"
+
+#include <random>
+#include <thread>
+
+// Hammers the threading model of TimelineManager's editor state. FCFW threads start and stop playback on a MockFCFW,
+// whose messages are handled like TimelineManager::OnFCFWMessage does: the handler only copies the event and queues a
+// task, and the task applies it to the registry on the main thread. Input threads switch timelines and selections
+// through an AtomicSnapshot while reader threads load snapshots and check that each one is consistent and that cache
+// versions never go back.
+
+using namespace FCSE;
+
+namespace {
+    constexpr SKSE::PluginHandle kHandle = 1;
+    constexpr size_t kTimelineCount = 4;
+    constexpr int kPlaybackThreads = 2;
+    constexpr int kInputThreads = 2;
+    constexpr int kReaderThreads = 3;
+    constexpr int kIterations = 20000;
+    constexpr int32_t kPointsPerTimeline = 1000;
+
+    // Mirrors TimelineManager::EditorState. The selected point encodes the timeline it was selected on.
+    struct EditorState {
+        size_t timelineID = 0;
+        int32_t selectedTranslationPoint = -1;
+        std::unordered_map<size_t, uint32_t> cacheVersions;
+
+        uint32_t GetCacheVersion(size_t a_timelineID) const {
+            const auto it = cacheVersions.find(a_timelineID);
+            return it != cacheVersions.end() ? it->second : 0;
+        }
+    };
+
+    struct Harness {
+        Tools::MockFCFW fcfw;
+        TimelineRegistry registry;  // main thread only
+        AtomicSnapshot<EditorState> state;
+        std::vector<size_t> timelineIDs;
+        std::thread::id mainThread = std::this_thread::get_id();
+        std::atomic<uint32_t> invalidations = 0;  // playback messages that end playback, counted when sent
+        std::atomic<int> wrongThreadCount = 0;
+
+        void OnFCFWMessage(SKSE::MessagingInterface::Message* a_msg) {
+            if (!a_msg || !a_msg->data || a_msg->dataLen < sizeof(FCFW_API::FCFWTimelineEventData)) {
+                return;
+            }
+            const size_t timelineID = static_cast<const FCFW_API::FCFWTimelineEventData*>(a_msg->data)->timelineID;
+            const auto message = static_cast<FCFW_API::FCFWMessage>(a_msg->type);
+            if (message != FCFW_API::FCFWMessage::kPlaybackStart) {
+                ++invalidations;
+            }
+            SKSE::GetTaskInterface()->AddTask([this, timelineID, message]() {
+                if (std::this_thread::get_id() != mainThread) {
+                    ++wrongThreadCount;
+                }
+                if (registry.ApplyPlaybackMessage(timelineID, message)) {
+                    state.Modify([&](EditorState& a_state) { ++a_state.cacheVersions[timelineID]; });
+                }
+            });
+        }
+    };
+
+    void RunPlayback(Harness& a_harness, unsigned a_seed) {
+        std::mt19937 random(a_seed);
+        std::uniform_int_distribution<size_t> pick(0, kTimelineCount - 1);
+        std::uniform_int_distribution<int> action(0, 2);
+        for (int i = 0; i < kIterations; ++i) {
+            const size_t timelineID = a_harness.timelineIDs[pick(random)];
+            switch (action(random)) {
+            case 0:
+                (void)a_harness.fcfw.StartPlayback(kHandle, timelineID, 1.f, false, false, false, 0.f);
+                break;
+            case 1:
+                (void)a_harness.fcfw.StopPlayback(kHandle, timelineID);
+                break;
+            default:
+                (void)a_harness.fcfw.FinishPlayback(timelineID);
+                break;
+            }
+        }
+    }
+
+    // Cycling and selecting like the input commands: switching timelines always clears the selection
+    void RunInput(Harness& a_harness, unsigned a_seed) {
+        std::mt19937 random(a_seed);
+        std::uniform_int_distribution<int32_t> point(0, kPointsPerTimeline - 1);
+        for (int i = 0; i < kIterations; ++i) {
+            if (i % 3 == 0) {
+                a_harness.state.Modify([&](EditorState& a_state) {
+                    const auto it = std::find(a_harness.timelineIDs.begin(), a_harness.timelineIDs.end(), a_state.timelineID);
+                    const size_t next = it == a_harness.timelineIDs.end() ? 0 : static_cast<size_t>(it - a_harness.timelineIDs.begin()) + 1;
+                    a_state.timelineID = a_harness.timelineIDs[next % a_harness.timelineIDs.size()];
+                    a_state.selectedTranslationPoint = -1;
+                });
+            } else {
+                const int32_t selected = point(random);
+                a_harness.state.Modify([&](EditorState& a_state) {
+                    a_state.selectedTranslationPoint = static_cast<int32_t>(a_state.timelineID) * kPointsPerTimeline + selected;
+                });
+            }
+        }
+    }
+
+    void RunReader(Harness& a_harness, const std::atomic<bool>& a_isDone, std::atomic<int>& a_failureCount) {
+        std::unordered_map<size_t, uint32_t> lastVersions;
+        while (!a_isDone.load(std::memory_order_acquire)) {
+            const auto state = a_harness.state.Load();
+            const size_t timelineID = state->timelineID;
+            const int32_t selected = state->selectedTranslationPoint;
+
+            bool isConsistent = selected < 0 || static_cast<size_t>(selected / kPointsPerTimeline) == timelineID;
+            for (const size_t id : a_harness.timelineIDs) {
+                const uint32_t version = state->GetCacheVersion(id);
+                isConsistent &= version >= lastVersions[id];
+                lastVersions[id] = version;
+            }
+            // A published snapshot never changes under its reader
+            std::this_thread::yield();
+            isConsistent &= state->timelineID == timelineID && state->selectedTranslationPoint == selected;
+            if (!isConsistent) {
+                ++a_failureCount;
+            }
+        }
+    }
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    Harness harness;
+    harness.fcfw.SetListener([&harness](SKSE::MessagingInterface::Message* a_msg) { harness.OnFCFWMessage(a_msg); });
+    for (size_t i = 0; i < kTimelineCount; ++i) {
+        const size_t timelineID = harness.fcfw.RegisterTimeline(kHandle);
+        harness.registry.Add(timelineID);
+        harness.timelineIDs.push_back(timelineID);
+    }
+
+    std::atomic<bool> isDone = false;
+    std::atomic<int> readerFailureCount = 0;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < kReaderThreads; ++i) {
+        readers.emplace_back(RunReader, std::ref(harness), std::cref(isDone), std::ref(readerFailureCount));
+    }
+    std::vector<std::thread> writers;
+    for (int i = 0; i < kPlaybackThreads; ++i) {
+        writers.emplace_back(RunPlayback, std::ref(harness), 100u + static_cast<unsigned>(i));
+    }
+    for (int i = 0; i < kInputThreads; ++i) {
+        writers.emplace_back(RunInput, std::ref(harness), 200u + static_cast<unsigned>(i));
+    }
+
+    // The main thread runs the queued tasks like the game's task interface does between frames
+    std::atomic<int> runningWriters = static_cast<int>(writers.size());
+    std::thread joiner([&]() {
+        for (auto& writer : writers) {
+            writer.join();
+            --runningWriters;
+        }
+    });
+    size_t taskCount = 0;
+    while (runningWriters.load() > 0) {
+        taskCount += SKSE::GetTaskInterface()->RunTasks();
+        std::this_thread::yield();
+    }
+    joiner.join();
+    taskCount += SKSE::GetTaskInterface()->RunTasks();
+    isDone = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    FCSE_CHECK(taskCount > 0);
+    FCSE_CHECK(harness.wrongThreadCount == 0);
+    FCSE_CHECK(readerFailureCount == 0);
+
+    // Every message was applied once and in order: the registry ends up where FCFW is, and every message that ended
+    // playback bumped the cache version exactly once
+    const auto state = harness.state.Load();
+    uint32_t versionSum = 0;
+    for (const size_t timelineID : harness.timelineIDs) {
+        const auto* info = harness.registry.Find(timelineID);
+        const bool isPlaying = harness.fcfw.IsPlaybackRunning(kHandle, timelineID);
+        FCSE_CHECK(info && (info->playbackState == PlaybackState::kPlaying) == isPlaying);
+        versionSum += state->GetCacheVersion(timelineID);
+    }
+    FCSE_CHECK(versionSum == harness.invalidations);
+    std::printf("%zu tasks, %u invalidations\n", taskCount, harness.invalidations.load());
+    return Tools::Finish();
+}
@@ -0,0 +1,165 @@
+#include "HermiteKernel.h"
+#include "ToolCheck.h"
+
+#include <random>
+
+// Runs the batch functions at every SimdLevel this CPU supports and checks that their output matches the scalar path
+// bit for bit, for batch sizes that leave a scalar tail and for degenerate pieces.
+
+using namespace FCSE;
+
+namespace {
+    // Parameters in [0, 1] like Subdivide passes, plus a few outside of it
+    std::vector<float> MakeParameters(std::mt19937& a_random, size_t a_count) {
+        std::uniform_real_distribution<float> parameter(-0.25f, 1.25f);
+        std::vector<float> u(a_count);
+        for (auto& value : u) {
+            value = parameter(a_random);
+        }
+        return u;
+    }
+
+    CubicSegment MakeSegment(std::mt19937& a_random) {
+        std::uniform_real_distribution<float> coordinate(-100000.f, 100000.f);
+        const auto point = [&]() { return std::array<float, 3>{ coordinate(a_random), coordinate(a_random), coordinate(a_random) }; };
+        return CubicSegment::FromHermite(point(), point(), point(), point());
+    }
+
+    struct Hulls {
+        std::array<std::vector<float>, 3> start;
+        std::array<std::vector<float>, 3> end;
+        std::array<std::vector<float>, 3> startTangent;
+        std::array<std::vector<float>, 3> endTangent;
+
+        HullArrays Get(float a_span) const {
+            HullArrays hulls;
+            for (size_t axis = 0; axis < 3; ++axis) {
+                hulls.start[axis] = start[axis].data();
+                hulls.end[axis] = end[axis].data();
+                hulls.startTangent[axis] = startTangent[axis].data();
+                hulls.endTangent[axis] = endTangent[axis].data();
+            }
+            hulls.span = a_span;
+            return hulls;
+        }
+    };
+
+    // Pieces of every scale, every fifth one with a chord too short to measure against
+    Hulls MakeHulls(std::mt19937& a_random, size_t a_count) {
+        std::uniform_real_distribution<float> coordinate(-10000.f, 10000.f);
+        std::uniform_real_distribution<float> exponent(-4.f, 3.f);
+
+        Hulls hulls;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            for (auto* values : { &hulls.start[axis], &hulls.end[axis], &hulls.startTangent[axis], &hulls.endTangent[axis] }) {
+                values->resize(a_count);
+            }
+        }
+        for (size_t i = 0; i < a_count; ++i) {
+            const float scale = std::pow(10.f, exponent(a_random));
+            for (size_t axis = 0; axis < 3; ++axis) {
+                const float start = coordinate(a_random);
+                hulls.start[axis][i] = start;
+                hulls.end[axis][i] = i % 5 == 0 ? start : start + coordinate(a_random) * scale / 10000.f;
+                hulls.startTangent[axis][i] = coordinate(a_random) * scale;
+                hulls.endTangent[axis][i] = coordinate(a_random) * scale;
+            }
+        }
+        return hulls;
+    }
+
+    bool SameBits(const std::vector<float>& a_lhs, const std::vector<float>& a_rhs) {
+        return a_lhs.size() == a_rhs.size() && (a_lhs.empty() || std::memcmp(a_lhs.data(), a_rhs.data(), a_lhs.size() * sizeof(float)) == 0);
+    }
+
+    std::vector<SimdLevel> GetSupportedLevels() {
+        std::vector<SimdLevel> levels;
+        for (const SimdLevel level : { SimdLevel::kScalar, SimdLevel::kSSE2 }) {
+            if (level <= GetDetectedSimdLevel()) {
+                levels.push_back(level);
+            }
+        }
+        return levels;
+    }
+
+    void TestSetSimdLevel() {
+        for (const SimdLevel level : { SimdLevel::kScalar, SimdLevel::kSSE2 }) {
+            SetSimdLevel(level);
+            FCSE_CHECK(GetSimdLevel() == std::min(level, GetDetectedSimdLevel()));
+        }
+        SetSimdLevel(GetDetectedSimdLevel());
+    }
+
+    void TestEvaluateCubic() {
+        std::mt19937 random(1);
+        for (const size_t count : { 0u, 1u, 3u, 4u, 5u, 7u, 8u, 9u, 15u, 16u, 17u, 31u, 1000u, 1023u }) {
+            const std::vector<float> u = MakeParameters(random, count);
+            const CubicSegment segment = MakeSegment(random);
+            for (const CubicSegment& curve : { segment, segment.Derivative() }) {
+                std::array<std::vector<float>, 3> expected;
+                for (const SimdLevel level : GetSupportedLevels()) {
+                    SetSimdLevel(level);
+                    // Filled with NaNs, so values a path does not write are not mistaken for matches
+                    std::array<std::vector<float>, 3> actual;
+                    for (auto& values : actual) {
+                        values.assign(count, std::numeric_limits<float>::quiet_NaN());
+                    }
+                    EvaluateCubic(curve, u, { actual[0].data(), actual[1].data(), actual[2].data() });
+                    if (level == SimdLevel::kScalar) {
+                        expected = actual;
+                        continue;
+                    }
+                    for (size_t axis = 0; axis < 3; ++axis) {
+                        if (!FCSE_CHECK(SameBits(actual[axis], expected[axis]))) {
+                            std::printf("  %s, %zu parameters, axis %zu\n", GetSimdLevelName(level), count, axis);
+                        }
+                    }
+                }
+            }
+        }
+        SetSimdLevel(GetDetectedSimdLevel());
+    }
+
+    void TestTestHulls() {
+        std::mt19937 random(2);
+        std::uniform_real_distribution<float> coordinate(-10000.f, 10000.f);
+        for (const size_t count : { 0u, 1u, 3u, 4u, 5u, 7u, 8u, 9u, 15u, 16u, 17u, 31u, 1000u, 1023u }) {
+            const Hulls hulls = MakeHulls(random, count);
+            for (const float span : { 1.f / 3.f, 1.f / 48.f, 1.f / 768.f }) {
+                HullTolerance tolerance;
+                tolerance.camera = { coordinate(random), coordinate(random), coordinate(random) };
+                tolerance.errorScaleSq = 4e-6f;
+                tolerance.minDistanceSq = 2500.f;
+
+                std::vector<uint8_t> expected;
+                size_t splitCount = 0;
+                for (const SimdLevel level : GetSupportedLevels()) {
+                    SetSimdLevel(level);
+                    std::vector<uint8_t> actual(count, 0xFF);
+                    TestHulls(hulls.Get(span), tolerance, count, actual.data());
+                    if (level == SimdLevel::kScalar) {
+                        expected = actual;
+                        splitCount = static_cast<size_t>(std::count(actual.begin(), actual.end(), uint8_t(1)));
+                        continue;
+                    }
+                    if (!FCSE_CHECK(actual == expected)) {
+                        std::printf("  %s, %zu pieces, span %g\n", GetSimdLevelName(level), count, span);
+                    }
+                }
+                // The data has to exercise both answers to mean anything
+                if (count >= 1000) {
+                    FCSE_CHECK(splitCount > 0 && splitCount < count);
+                }
+            }
+        }
+        SetSimdLevel(GetDetectedSimdLevel());
+    }
+}
+
+int main() {
+    std::printf("Detected %s\n", GetSimdLevelName(GetDetectedSimdLevel()));
+    TestSetSimdLevel();
+    TestEvaluateCubic();
+    TestTestHulls();
+    return Tools::Finish();
+}
@@ -0,0 +1,97 @@
+#include "CommandQueue.h"
+#include "InputDispatcher.h"
+
+#include <cstdio>
+#include <random>
+
+// Times InputDispatcher on synthetic ButtonEvent chains like the ones ControlsManager's input sink receives: each frame
+// a few keys go down, are held or go up, with modifiers among them, and the commands are queued and drained the way the
+// sink and ControlsManager::Update do. Chains hold at least 1, 4, 16 and 64 events, one for each key that is down.
+
+using namespace FCSE;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using Command = InputDispatcher::Command;
+
+    constexpr size_t kFrames = 200'000;
+    constexpr float kFrameSeconds = 1.f / 60.f;
+
+    // Random keys going down, held for a few frames and going up again, as one chain per frame. The bound keys and the
+    // modifiers come up more often than the rest of the keyboard.
+    std::vector<std::vector<RE::ButtonEvent>> MakeFrames(size_t a_eventsPerFrame) {
+        std::mt19937 random(1);
+        std::vector<uint32_t> keys = { 29, 42, 56 };
+        for (const auto& binding : kDefaultKeyBindings) {
+            keys.push_back(binding.key);
+        }
+        std::uniform_int_distribution<size_t> pickKey(0, keys.size() - 1);
+        std::uniform_int_distribution<uint32_t> anyKey(1, 255);
+        std::uniform_int_distribution<int> holdFrames(1, 30);
+
+        struct HeldKey {
+            uint32_t key;
+            float seconds;
+            int framesLeft;
+        };
+        std::vector<HeldKey> held;
+        std::vector<std::vector<RE::ButtonEvent>> frames(kFrames);
+        for (auto& frame : frames) {
+            for (auto it = held.begin(); it != held.end();) {
+                RE::ButtonEvent event;
+                event.idCode = it->key;
+                it->seconds += kFrameSeconds;
+                event.heldDownSecs = it->seconds;
+                event.value = --it->framesLeft > 0 ? 1.f : 0.f;
+                frame.push_back(event);
+                it = event.value > 0.f ? it + 1 : held.erase(it);
+            }
+            while (frame.size() < a_eventsPerFrame) {
+                const uint32_t key = random() % 4 == 0 ? anyKey(random) : keys[pickKey(random)];
+                if (std::any_of(held.begin(), held.end(), [key](const HeldKey& a_held) { return a_held.key == key; })) {
+                    continue;
+                }
+                RE::ButtonEvent event;
+                event.idCode = key;
+                event.value = 1.f;
+                frame.push_back(event);
+                held.push_back({ key, 0.f, holdFrames(random) });
+            }
+            for (size_t i = 0; i + 1 < frame.size(); ++i) {
+                frame[i].next = &frame[i + 1];
+            }
+        }
+        return frames;
+    }
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::err);
+
+    std::printf("%8s %12s %12s %16s\n", "events", "chain ns", "event ns", "commands/frame");
+    for (const size_t eventsPerFrame : { 1u, 4u, 16u, 64u }) {
+        // The chains point into each frame's own buffer, which returning the frames does not move
+        const auto frames = MakeFrames(eventsPerFrame);
+        size_t eventCount = 0;
+        for (const auto& frame : frames) {
+            eventCount += frame.size();
+        }
+
+        InputDispatcher dispatcher;
+        CommandQueue<Command, 64> commands;
+        size_t commandCount = 0;
+        const auto start = Clock::now();
+        for (const auto& frame : frames) {
+            dispatcher.ProcessEvents(&frame.front(), [&commands](const Command& a_command) { (void)commands.Push(a_command); });
+            Command command;
+            while (commands.Pop(command)) {
+                ++commandCount;
+            }
+        }
+        const double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        std::printf("%8.1f %12.1f %12.2f %16.3f\n", static_cast<double>(eventCount) / kFrames, elapsed / kFrames,
+                    elapsed / static_cast<double>(eventCount), static_cast<double>(commandCount) / kFrames);
+    }
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include "InputDispatcher.h"
+#include "ToolCheck.h"
+
+// Feeds synthetic ButtonEvent chains through InputDispatcher: modifier combinations, hold and repeat triggers, and
+// releases the dispatcher never sees, like those made while the game is paused or in the background.
+
+using namespace FCSE;
+
+namespace {
+    using Command = InputDispatcher::Command;
+
+    constexpr uint32_t kKeyCtrl = 29;
+    constexpr uint32_t kKeyZ = 44;
+    constexpr uint32_t kKeyV = 47;
+    constexpr uint32_t kKeyU = 22;
+
+    // One frame of input, linked into a chain like the game's input device manager sends it
+    class Chain {
+    public:
+        Chain& Down(uint32_t a_key) { return Add(a_key, 1.f, 0.f); }
+        Chain& Held(uint32_t a_key, float a_seconds) { return Add(a_key, 1.f, a_seconds); }
+        Chain& Up(uint32_t a_key, float a_seconds) { return Add(a_key, 0.f, a_seconds); }
+
+        std::vector<Command> Dispatch(InputDispatcher& a_dispatcher) {
+            for (size_t i = 0; i + 1 < m_events.size(); ++i) {
+                m_events[i].next = &m_events[i + 1];
+            }
+            std::vector<Command> commands;
+            a_dispatcher.ProcessEvents(m_events.empty() ? nullptr : &m_events.front(),
+                                       [&commands](const Command& a_command) { commands.push_back(a_command); });
+            return commands;
+        }
+
+    private:
+        Chain& Add(uint32_t a_key, float a_value, float a_seconds) {
+            RE::ButtonEvent event;
+            event.idCode = a_key;
+            event.value = a_value;
+            event.heldDownSecs = a_seconds;
+            m_events.push_back(event);
+            return *this;
+        }
+
+        std::vector<RE::ButtonEvent> m_events;
+    };
+
+    bool IsCommand(const std::vector<Command>& a_commands, Action a_action, bool a_isRelease = false) {
+        return a_commands.size() == 1 && a_commands.front().action == a_action && a_commands.front().isRelease == a_isRelease;
+    }
+
+    InputDispatcher MakeDispatcher() {
+        InputDispatcher dispatcher;
+        auto bindings = kDefaultKeyBindings;
+        // Plain Z shares its key with Ctrl+Z, so a stuck modifier shows up as the wrong action
+        for (auto& binding : bindings) {
+            if (binding.action == Action::kToggleDrag) {
+                binding.key = kKeyZ;
+            }
+        }
+        dispatcher.BuildDispatchTable(bindings);
+        return dispatcher;
+    }
+
+    void TestModifiers() {
+        InputDispatcher dispatcher = MakeDispatcher();
+        FCSE_CHECK(IsCommand(Chain().Down(kKeyZ).Dispatch(dispatcher), Action::kToggleDrag));
+        FCSE_CHECK(Chain().Up(kKeyZ, 0.1f).Dispatch(dispatcher).empty());
+
+        // Pressed in the same frame, the modifier counts whichever event comes first
+        FCSE_CHECK(IsCommand(Chain().Down(kKeyZ).Down(kKeyCtrl).Dispatch(dispatcher), Action::kUndo));
+        FCSE_CHECK(dispatcher.GetModifiers() == kModifierCtrl);
+        FCSE_CHECK(Chain().Up(kKeyZ, 0.1f).Held(kKeyCtrl, 0.1f).Dispatch(dispatcher).empty());
+        FCSE_CHECK(IsCommand(Chain().Held(kKeyCtrl, 0.2f).Down(kKeyZ).Dispatch(dispatcher), Action::kUndo));
+        FCSE_CHECK(Chain().Up(kKeyZ, 0.1f).Up(kKeyCtrl, 0.3f).Dispatch(dispatcher).empty());
+        FCSE_CHECK(dispatcher.GetModifiers() == kModifierNone);
+    }
+
+    // Ctrl goes up while no events arrive, the next plain Z must not undo
+    void TestMissedModifierRelease() {
+        InputDispatcher dispatcher = MakeDispatcher();
+        FCSE_CHECK(Chain().Down(kKeyCtrl).Dispatch(dispatcher).empty());
+        FCSE_CHECK(dispatcher.GetModifiers() == kModifierCtrl);
+        FCSE_CHECK(IsCommand(Chain().Down(kKeyZ).Dispatch(dispatcher), Action::kToggleDrag));
+        FCSE_CHECK(dispatcher.GetModifiers() == kModifierNone);
+    }
+
+    void TestTriggers() {
+        InputDispatcher dispatcher = MakeDispatcher();
+        // U repeats every 0.3 s while held
+        FCSE_CHECK(IsCommand(Chain().Down(kKeyU).Dispatch(dispatcher), Action::kCycleUp));
+        FCSE_CHECK(Chain().Held(kKeyU, 0.2f).Dispatch(dispatcher).empty());
+        FCSE_CHECK(IsCommand(Chain().Held(kKeyU, 0.35f).Dispatch(dispatcher), Action::kCycleUp));
+        FCSE_CHECK(Chain().Held(kKeyU, 0.5f).Dispatch(dispatcher).empty());
+        FCSE_CHECK(IsCommand(Chain().Held(kKeyU, 0.61f).Dispatch(dispatcher), Action::kCycleUp));
+        FCSE_CHECK(Chain().Up(kKeyU, 0.7f).Dispatch(dispatcher).empty());
+
+        // A hold trigger fires once, after its time
+        auto bindings = kDefaultKeyBindings;
+        for (auto& binding : bindings) {
+            if (binding.action == Action::kClearTimeline) {
+                binding.trigger = Trigger::kHold;
+                binding.time = 1.f;
+            }
+        }
+        dispatcher.BuildDispatchTable(bindings);
+        constexpr uint32_t kKey5 = 6;
+        FCSE_CHECK(Chain().Down(kKey5).Dispatch(dispatcher).empty());
+        FCSE_CHECK(Chain().Held(kKey5, 0.9f).Dispatch(dispatcher).empty());
+        FCSE_CHECK(IsCommand(Chain().Held(kKey5, 1.1f).Dispatch(dispatcher), Action::kClearTimeline));
+        FCSE_CHECK(Chain().Held(kKey5, 2.5f).Dispatch(dispatcher).empty());
+    }
+
+    // Scrubbing lasts from press to release, also when the release is lost to a reset
+    void TestReset() {
+        InputDispatcher dispatcher = MakeDispatcher();
+        FCSE_CHECK(IsCommand(Chain().Down(kKeyV).Dispatch(dispatcher), Action::kScrub));
+        FCSE_CHECK(Chain().Held(kKeyV, 0.5f).Dispatch(dispatcher).empty());
+        FCSE_CHECK(IsCommand(Chain().Up(kKeyV, 0.6f).Dispatch(dispatcher), Action::kScrub, true));
+
+        FCSE_CHECK(Chain().Down(kKeyV).Down(kKeyU).Dispatch(dispatcher).size() == 2);
+        FCSE_CHECK(Chain().Held(kKeyV, 0.1f).Held(kKeyU, 0.1f).Down(kKeyCtrl).Dispatch(dispatcher).empty());
+        FCSE_CHECK(dispatcher.GetModifiers() == kModifierCtrl);
+        std::vector<Command> releases;
+        dispatcher.Reset([&releases](const Command& a_release) { releases.push_back(a_release); });
+        FCSE_CHECK(IsCommand(releases, Action::kScrub, true));
+        FCSE_CHECK(dispatcher.GetModifiers() == kModifierNone);
+
+        // Keys still held afterwards do nothing until they are pressed again
+        FCSE_CHECK(Chain().Held(kKeyV, 2.f).Held(kKeyU, 2.f).Dispatch(dispatcher).empty());
+        FCSE_CHECK(Chain().Up(kKeyV, 2.1f).Dispatch(dispatcher).empty());
+        releases.clear();
+        dispatcher.Reset([&releases](const Command& a_release) { releases.push_back(a_release); });
+        FCSE_CHECK(releases.empty());
+    }
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::err);
+    TestModifiers();
+    TestMissedModifierRelease();
+    TestTriggers();
+    TestReset();
+    return Tools::Finish();
+}
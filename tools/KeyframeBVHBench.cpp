@@ -0,0 +1,114 @@
+#include "KeyframeBVH.h"
+
+#include <cstdio>
+#include <random>
+
+// Times building a KeyframeBVH over 10k and 100k keyframes, refitting single keyframes as a drag does, and picking with
+// rays from a camera on the path, against a linear scan over all keyframes. Every pick, made after the refits, has to
+// find the same keyframe as the scan.
+
+using namespace FCSE;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double GetNanoseconds(Clock::time_point a_start, Clock::time_point a_end) {
+        return std::chrono::duration<double, std::nano>(a_end - a_start).count();
+    }
+
+    // A random walk like a recorded camera path
+    std::vector<RE::NiPoint3> MakePath(size_t a_count) {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> step(-200.f, 200.f);
+
+        std::vector<RE::NiPoint3> points;
+        points.reserve(a_count);
+        RE::NiPoint3 point;
+        for (size_t i = 0; i < a_count; ++i) {
+            point += RE::NiPoint3(step(random), step(random), step(random) / 4.f);
+            points.push_back(point);
+        }
+        return points;
+    }
+
+    // Same metric as KeyframeBVH::PickRay, over every point
+    uint32_t PickLinear(std::span<const RE::NiPoint3> a_points, const RE::NiPoint3& a_origin, const RE::NiPoint3& a_direction, float a_maxAngle) {
+        float bestTan = std::tan(a_maxAngle);
+        uint32_t best = KeyframeBVH::kInvalidIndex;
+        for (uint32_t i = 0; i < a_points.size(); ++i) {
+            const RE::NiPoint3 toPoint = a_points[i] - a_origin;
+            const float along = toPoint.Dot(a_direction);
+            if (along <= 0.f) {
+                continue;
+            }
+            const float tangent = (toPoint - a_direction * along).Length() / along;
+            if (tangent < bestTan) {
+                bestTan = tangent;
+                best = i;
+            }
+        }
+        return best;
+    }
+}
+
+int main() {
+    constexpr size_t kRefits = 100'000;
+    constexpr size_t kPicks = 2'000;
+    constexpr float kMaxAngle = 0.012f;  // about 12 pixels at the default 1000 pixels per radian
+
+    std::printf("%10s %10s %10s %10s %12s %8s\n", "keyframes", "build ms", "refit ns", "pick ns", "scan ns", "misses");
+    bool succeeded = true;
+    for (const size_t count : { 10'000u, 100'000u }) {
+        std::vector<RE::NiPoint3> points = MakePath(count);
+        std::mt19937 random(2);
+        std::uniform_int_distribution<uint32_t> pickIndex(0, static_cast<uint32_t>(count - 1));
+        std::uniform_real_distribution<float> offset(-20.f, 20.f);
+        std::uniform_real_distribution<float> aim(-2.f, 2.f);
+
+        KeyframeBVH bvh;
+        auto start = Clock::now();
+        bvh.Build(points);
+        const double build = GetNanoseconds(start, Clock::now()) / 1e6;
+
+        // Small moves, as a drag makes every frame
+        start = Clock::now();
+        for (size_t i = 0; i < kRefits; ++i) {
+            const uint32_t index = pickIndex(random);
+            points[index] += RE::NiPoint3(offset(random), offset(random), offset(random));
+            bvh.Refit(index, points[index]);
+        }
+        const double refit = GetNanoseconds(start, Clock::now()) / kRefits;
+
+        // Rays from a camera at one keyframe towards another one nearby, slightly off target
+        std::vector<std::pair<RE::NiPoint3, RE::NiPoint3>> rays;
+        rays.reserve(kPicks);
+        for (size_t i = 0; i < kPicks; ++i) {
+            const uint32_t from = pickIndex(random);
+            const uint32_t to = std::min(from + 1 + pickIndex(random) % 50, static_cast<uint32_t>(count - 1));
+            const RE::NiPoint3 origin = points[from] + RE::NiPoint3(0.f, 0.f, 100.f);
+            RE::NiPoint3 direction = points[to] + RE::NiPoint3(aim(random), aim(random), aim(random)) - origin;
+            direction.Unitize();
+            rays.emplace_back(origin, direction);
+        }
+
+        std::vector<uint32_t> picked(kPicks);
+        start = Clock::now();
+        for (size_t i = 0; i < kPicks; ++i) {
+            picked[i] = bvh.PickRay(rays[i].first, rays[i].second, kMaxAngle);
+        }
+        const double pick = GetNanoseconds(start, Clock::now()) / kPicks;
+
+        std::vector<uint32_t> scanned(kPicks);
+        start = Clock::now();
+        for (size_t i = 0; i < kPicks; ++i) {
+            scanned[i] = PickLinear(points, rays[i].first, rays[i].second, kMaxAngle);
+        }
+        const double scan = GetNanoseconds(start, Clock::now()) / kPicks;
+
+        const size_t misses = static_cast<size_t>(std::count(picked.begin(), picked.end(), KeyframeBVH::kInvalidIndex));
+        const bool matches = picked == scanned;
+        succeeded &= matches;
+        std::printf("%10zu %10.2f %10.1f %10.1f %12.1f %8zu%s\n", count, build, refit, pick, scan, misses, matches ? "" : "  MISMATCH");
+    }
+    return succeeded ? 0 : 1;
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+#include "API/FCFW_API.h"
+#include "TimelineModel.h"
+
+// An in-memory stand-in for FCFW's IVFCFW1 for the tests in tools/. Timelines keep their points sorted by time, and
+// every call that changes points is recorded. New points go after existing points with the same time unless the tie
+// order says otherwise, since FCFW does not promise either. Playback only sends FCFW's messages. All calls may come
+// from any thread; messages are sent to the listener on the calling thread, like SKSE's messaging interface does.
+
+namespace FCSE::Tools {
+    class MockFCFW : public FCFW_API::IVFCFW1 {
+    public:
+        using Listener = std::function<void(SKSE::MessagingInterface::Message*)>;
+
+        // Where a new point goes among existing points with the same time
+        enum class TieOrder {
+            kAfter,
+            kBefore
+        };
+
+        struct Call {
+            enum class Type {
+                kAddTranslation,
+                kAddRotation,
+                kRemoveTranslation,
+                kRemoveRotation,
+                kClear
+            };
+
+            Type type = Type::kClear;
+            size_t timelineID = 0;
+            int index = -1;  // of the added or removed point, -1 if the call failed
+            float time = 0.f;
+
+            bool operator==(const Call&) const = default;
+        };
+
+        struct Timeline {
+            std::vector<TranslationKeyframe> translations;
+            std::vector<RotationKeyframe> rotations;
+            bool isPlaying = false;
+        };
+
+        void SetListener(Listener a_listener) {
+            std::lock_guard lock(m_mutex);
+            m_listener = std::move(a_listener);
+        }
+
+        // Playback of a_timelineID reached its end in kWait mode
+        bool FinishPlayback(size_t a_timelineID) const {
+            std::lock_guard lock(m_mutex);
+            auto* timeline = Find(a_timelineID);
+            if (!timeline || !timeline->isPlaying) {
+                return false;
+            }
+            timeline->isPlaying = false;
+            Send(FCFW_API::FCFWMessage::kPlaybackWait, a_timelineID);
+            return true;
+        }
+
+        void SetTieOrder(TieOrder a_order) {
+            std::lock_guard lock(m_mutex);
+            m_tieOrder = a_order;
+        }
+
+        // Returns the calls recorded since the last TakeCalls
+        std::vector<Call> TakeCalls() {
+            std::lock_guard lock(m_mutex);
+            return std::exchange(m_calls, {});
+        }
+
+        Timeline GetTimeline(size_t a_timelineID) const {
+            std::lock_guard lock(m_mutex);
+            const auto it = m_timelines.find(a_timelineID);
+            return it != m_timelines.end() ? it->second : Timeline();
+        }
+
+        unsigned long GetFCFWThreadId() const noexcept override { return 0; }
+        int GetFCFWPluginVersion() const noexcept override { return 10000; }
+        bool RegisterPlugin(SKSE::PluginHandle) const noexcept override { return true; }
+
+        size_t RegisterTimeline(SKSE::PluginHandle) const noexcept override {
+            std::lock_guard lock(m_mutex);
+            const size_t timelineID = ++m_lastTimelineID;
+            m_timelines.emplace(timelineID, Timeline());
+            return timelineID;
+        }
+
+        bool UnregisterTimeline(SKSE::PluginHandle, size_t a_timelineID) const noexcept override {
+            std::lock_guard lock(m_mutex);
+            return m_timelines.erase(a_timelineID) > 0;
+        }
+
+        int AddTranslationPoint(SKSE::PluginHandle, size_t a_timelineID, float a_time, const RE::NiPoint3& a_position, bool a_easeIn, bool a_easeOut,
+                                int a_interpolationMode) const noexcept override {
+            return AddTranslation({ .time = a_time, .value = { a_position.x, a_position.y, a_position.z } }, a_timelineID, a_easeIn, a_easeOut,
+                                  a_interpolationMode);
+        }
+
+        int AddTranslationPointAtRef(SKSE::PluginHandle, size_t a_timelineID, float a_time, RE::TESObjectREFR*, const RE::NiPoint3& a_offset,
+                                     bool a_isOffsetRelative, bool a_easeIn, bool a_easeOut, int a_interpolationMode) const noexcept override {
+            TranslationKeyframe keyframe{ .time = a_time, .value = { a_offset.x, a_offset.y, a_offset.z } };
+            keyframe.flags = a_isOffsetRelative ? kKeyframeOffsetRelative : 0;
+            return AddTranslation(keyframe, a_timelineID, a_easeIn, a_easeOut, a_interpolationMode);
+        }
+
+        int AddTranslationPointAtCamera(SKSE::PluginHandle, size_t a_timelineID, float a_time, bool a_easeIn, bool a_easeOut,
+                                        int a_interpolationMode) const noexcept override {
+            return AddTranslation({ .time = a_time, .flags = kKeyframeAtCamera }, a_timelineID, a_easeIn, a_easeOut, a_interpolationMode);
+        }
+
+        int AddRotationPoint(SKSE::PluginHandle, size_t a_timelineID, float a_time, const RE::BSTPoint2<float>& a_rotation, bool a_easeIn, bool a_easeOut,
+                             int a_interpolationMode) const noexcept override {
+            return AddRotation({ .time = a_time, .value = { a_rotation.x, a_rotation.y } }, a_timelineID, a_easeIn, a_easeOut, a_interpolationMode);
+        }
+
+        int AddRotationPointAtRef(SKSE::PluginHandle, size_t a_timelineID, float a_time, RE::TESObjectREFR*, const RE::BSTPoint2<float>& a_offset,
+                                  bool a_isOffsetRelative, bool a_easeIn, bool a_easeOut, int a_interpolationMode) const noexcept override {
+            RotationKeyframe keyframe{ .time = a_time, .value = { a_offset.x, a_offset.y } };
+            keyframe.flags = a_isOffsetRelative ? kKeyframeOffsetRelative : 0;
+            return AddRotation(keyframe, a_timelineID, a_easeIn, a_easeOut, a_interpolationMode);
+        }
+
+        int AddRotationPointAtCamera(SKSE::PluginHandle, size_t a_timelineID, float a_time, bool a_easeIn, bool a_easeOut,
+                                     int a_interpolationMode) const noexcept override {
+            return AddRotation({ .time = a_time, .flags = kKeyframeAtCamera }, a_timelineID, a_easeIn, a_easeOut, a_interpolationMode);
+        }
+
+        bool RemoveTranslationPoint(SKSE::PluginHandle, size_t a_timelineID, size_t a_index) const noexcept override {
+            return Erase(Call::Type::kRemoveTranslation, a_timelineID, a_index);
+        }
+
+        bool RemoveRotationPoint(SKSE::PluginHandle, size_t a_timelineID, size_t a_index) const noexcept override {
+            return Erase(Call::Type::kRemoveRotation, a_timelineID, a_index);
+        }
+
+        bool StartRecording(SKSE::PluginHandle, size_t, float, bool, float) const noexcept override { return false; }
+        bool StopRecording(SKSE::PluginHandle, size_t) const noexcept override { return false; }
+
+        bool ClearTimeline(SKSE::PluginHandle, size_t a_timelineID) const noexcept override {
+            std::lock_guard lock(m_mutex);
+            auto* timeline = Find(a_timelineID);
+            m_calls.push_back({ Call::Type::kClear, a_timelineID, timeline ? 0 : -1, 0.f });
+            if (!timeline) {
+                return false;
+            }
+            timeline->translations.clear();
+            timeline->rotations.clear();
+            return true;
+        }
+
+        int GetTranslationPointCount(SKSE::PluginHandle, size_t a_timelineID) const noexcept override {
+            std::lock_guard lock(m_mutex);
+            const auto* timeline = Find(a_timelineID);
+            return timeline ? static_cast<int>(timeline->translations.size()) : -1;
+        }
+
+        int GetRotationPointCount(SKSE::PluginHandle, size_t a_timelineID) const noexcept override {
+            std::lock_guard lock(m_mutex);
+            const auto* timeline = Find(a_timelineID);
+            return timeline ? static_cast<int>(timeline->rotations.size()) : -1;
+        }
+
+        RE::NiPoint3 GetTranslationPoint(SKSE::PluginHandle, size_t a_timelineID, size_t a_index) const noexcept override {
+            std::lock_guard lock(m_mutex);
+            const auto* timeline = Find(a_timelineID);
+            if (!timeline || a_index >= timeline->translations.size()) {
+                return RE::NiPoint3();
+            }
+            const auto& value = timeline->translations[a_index].value;
+            return { value[0], value[1], value[2] };
+        }
+
+        RE::BSTPoint2<float> GetRotationPoint(SKSE::PluginHandle, size_t a_timelineID, size_t a_index) const noexcept override {
+            std::lock_guard lock(m_mutex);
+            const auto* timeline = Find(a_timelineID);
+            if (!timeline || a_index >= timeline->rotations.size()) {
+                return {};
+            }
+            const auto& value = timeline->rotations[a_index].value;
+            return { value[0], value[1] };
+        }
+
+        bool StartPlayback(SKSE::PluginHandle, size_t a_timelineID, float, bool, bool, bool, float) const noexcept override {
+            std::lock_guard lock(m_mutex);
+            auto* timeline = Find(a_timelineID);
+            if (!timeline || timeline->isPlaying) {
+                return false;
+            }
+            timeline->isPlaying = true;
+            Send(FCFW_API::FCFWMessage::kPlaybackStart, a_timelineID);
+            return true;
+        }
+
+        bool StopPlayback(SKSE::PluginHandle, size_t a_timelineID) const noexcept override {
+            std::lock_guard lock(m_mutex);
+            auto* timeline = Find(a_timelineID);
+            if (!timeline || !timeline->isPlaying) {
+                return false;
+            }
+            timeline->isPlaying = false;
+            Send(FCFW_API::FCFWMessage::kPlaybackStop, a_timelineID);
+            return true;
+        }
+
+        bool SwitchPlayback(SKSE::PluginHandle, size_t, size_t) const noexcept override { return false; }
+        bool PausePlayback(SKSE::PluginHandle, size_t) const noexcept override { return false; }
+        bool ResumePlayback(SKSE::PluginHandle, size_t) const noexcept override { return false; }
+
+        bool IsPlaybackRunning(SKSE::PluginHandle, size_t a_timelineID) const noexcept override {
+            std::lock_guard lock(m_mutex);
+            const auto* timeline = Find(a_timelineID);
+            return timeline && timeline->isPlaying;
+        }
+
+        bool IsRecording(SKSE::PluginHandle, size_t) const noexcept override { return false; }
+        bool IsPlaybackPaused(SKSE::PluginHandle, size_t) const noexcept override { return false; }
+        size_t GetActiveTimelineID() const noexcept override { return 0; }
+        void AllowUserRotation(SKSE::PluginHandle, size_t, bool) const noexcept override {}
+        bool IsUserRotationAllowed(SKSE::PluginHandle, size_t) const noexcept override { return false; }
+        bool SetPlaybackMode(SKSE::PluginHandle, size_t, int, float) const noexcept override { return true; }
+        bool AddTimelineFromFile(SKSE::PluginHandle, size_t, const char*, float) const noexcept override { return false; }
+        bool ExportTimeline(SKSE::PluginHandle, size_t, const char*) const noexcept override { return false; }
+
+    private:
+        Timeline* Find(size_t a_timelineID) const {
+            const auto it = m_timelines.find(a_timelineID);
+            return it != m_timelines.end() ? &it->second : nullptr;
+        }
+
+        // Sent while holding the lock, so the listener sees the messages of a timeline in the order of its state changes
+        void Send(FCFW_API::FCFWMessage a_message, size_t a_timelineID) const {
+            if (!m_listener) {
+                return;
+            }
+            FCFW_API::FCFWTimelineEventData data{ a_timelineID };
+            SKSE::MessagingInterface::Message message{ FCFW_API::FCFWPluginName, static_cast<uint32_t>(a_message), sizeof(data), &data };
+            m_listener(&message);
+        }
+
+        template <size_t N>
+        int Insert(std::vector<Keyframe<N>>& a_points, Keyframe<N> a_keyframe, bool a_easeIn, bool a_easeOut, int a_interpolationMode) const {
+            if (a_interpolationMode < 0 || a_interpolationMode > 2) {
+                return -1;
+            }
+            a_keyframe.flags |= (a_easeIn ? kKeyframeEaseIn : 0) | (a_easeOut ? kKeyframeEaseOut : 0);
+            a_keyframe.mode = static_cast<InterpolationMode>(a_interpolationMode);
+            const auto byTime = [](const Keyframe<N>& a_lhs, const Keyframe<N>& a_rhs) { return a_lhs.time < a_rhs.time; };
+            const auto it = m_tieOrder == TieOrder::kAfter ? std::upper_bound(a_points.begin(), a_points.end(), a_keyframe, byTime)
+                                                           : std::lower_bound(a_points.begin(), a_points.end(), a_keyframe, byTime);
+            const auto index = it - a_points.begin();
+            a_points.insert(it, a_keyframe);
+            return static_cast<int>(index);
+        }
+
+        int AddTranslation(const TranslationKeyframe& a_keyframe, size_t a_timelineID, bool a_easeIn, bool a_easeOut, int a_interpolationMode) const {
+            std::lock_guard lock(m_mutex);
+            auto* timeline = Find(a_timelineID);
+            const int index = timeline ? Insert(timeline->translations, a_keyframe, a_easeIn, a_easeOut, a_interpolationMode) : -1;
+            m_calls.push_back({ Call::Type::kAddTranslation, a_timelineID, index, a_keyframe.time });
+            return index;
+        }
+
+        int AddRotation(const RotationKeyframe& a_keyframe, size_t a_timelineID, bool a_easeIn, bool a_easeOut, int a_interpolationMode) const {
+            std::lock_guard lock(m_mutex);
+            auto* timeline = Find(a_timelineID);
+            const int index = timeline ? Insert(timeline->rotations, a_keyframe, a_easeIn, a_easeOut, a_interpolationMode) : -1;
+            m_calls.push_back({ Call::Type::kAddRotation, a_timelineID, index, a_keyframe.time });
+            return index;
+        }
+
+        bool Erase(Call::Type a_type, size_t a_timelineID, size_t a_index) const {
+            std::lock_guard lock(m_mutex);
+            auto* timeline = Find(a_timelineID);
+            const auto erase = [&](auto& a_points) {
+                if (a_index >= a_points.size()) {
+                    return false;
+                }
+                m_calls.push_back({ a_type, a_timelineID, static_cast<int>(a_index), a_points[a_index].time });
+                a_points.erase(a_points.begin() + static_cast<std::ptrdiff_t>(a_index));
+                return true;
+            };
+            const bool removed = timeline && (a_type == Call::Type::kRemoveTranslation ? erase(timeline->translations) : erase(timeline->rotations));
+            if (!removed) {
+                m_calls.push_back({ a_type, a_timelineID, -1, 0.f });
+            }
+            return removed;
+        }
+
+        mutable std::mutex m_mutex;
+        mutable std::unordered_map<size_t, Timeline> m_timelines;
+        mutable std::vector<Call> m_calls;
+        mutable size_t m_lastTimelineID = 0;
+        TieOrder m_tieOrder = TieOrder::kAfter;
+        Listener m_listener;
+    }; // class MockFCFW
+} // namespace FCSE::Tools
@@ -0,0 +1,142 @@
+#include "SplineEvaluator.h"
+
+#include <cstdio>
+#include <random>
+
+// Times tessellating paths of 1k, 10k and 100k CubicHermite keyframes, with the camera far from the path and with
+// it in the middle of it, where Subdivide has to split most segments down to the screen-space tolerance. Each path is
+// tessellated at every SimdLevel the CPU supports, and then the batch functions alone are timed on large batches.
+
+using namespace FCSE;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Best of a few runs, the first one also grows Subdivide's scratch buffers
+    template <class Func>
+    double Time(Func&& a_func) {
+        constexpr int kRuns = 5;
+        double best = std::numeric_limits<double>::max();
+        for (int run = 0; run < kRuns; ++run) {
+            const auto start = Clock::now();
+            a_func();
+            best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        return best;
+    }
+
+    // A random walk with steps of a few hundred units, like a camera path recorded through a cell
+    std::vector<RE::NiPoint3> MakePath(size_t a_count) {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> step(-400.f, 400.f);
+
+        std::vector<RE::NiPoint3> points;
+        points.reserve(a_count);
+        RE::NiPoint3 point;
+        for (size_t i = 0; i < a_count; ++i) {
+            point += RE::NiPoint3(step(random), step(random), step(random) / 4.f);
+            points.push_back(point);
+        }
+        return points;
+    }
+
+    std::vector<SimdLevel> GetSupportedLevels() {
+        std::vector<SimdLevel> levels;
+        for (const SimdLevel level : { SimdLevel::kScalar, SimdLevel::kSSE2 }) {
+            if (level <= GetDetectedSimdLevel()) {
+                levels.push_back(level);
+            }
+        }
+        return levels;
+    }
+
+    // Nanoseconds per element of EvaluateCubic and TestHulls on batches of a_count, repeated to about 10M elements
+    std::pair<double, double> TimeKernels(size_t a_count) {
+        std::mt19937 random(2);
+        std::uniform_real_distribution<float> coordinate(-10000.f, 10000.f);
+        const auto fill = [&](std::vector<float>& a_values) {
+            a_values.resize(a_count);
+            for (auto& value : a_values) {
+                value = coordinate(random);
+            }
+        };
+
+        std::vector<float> u(a_count);
+        for (size_t i = 0; i < a_count; ++i) {
+            u[i] = static_cast<float>(i) / static_cast<float>(a_count);
+        }
+        const CubicSegment segment = CubicSegment::FromHermite({ 0.f, 0.f, 0.f }, { 100.f, 0.f, 0.f }, { 100.f, 100.f, 50.f }, { 0.f, 100.f, 0.f });
+        std::array<std::vector<float>, 3> out;
+        for (auto& values : out) {
+            values.resize(a_count);
+        }
+
+        std::array<std::vector<float>, 3> start, end, startTangent, endTangent;
+        HullArrays hulls;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            fill(start[axis]);
+            fill(end[axis]);
+            fill(startTangent[axis]);
+            fill(endTangent[axis]);
+            hulls.start[axis] = start[axis].data();
+            hulls.end[axis] = end[axis].data();
+            hulls.startTangent[axis] = startTangent[axis].data();
+            hulls.endTangent[axis] = endTangent[axis].data();
+        }
+        hulls.span = 1.f / 48.f;
+        HullTolerance tolerance;
+        tolerance.errorScaleSq = 4e-6f;
+        tolerance.minDistanceSq = 2500.f;
+        std::vector<uint8_t> split(a_count);
+
+        const size_t repeats = std::max<size_t>(10'000'000 / a_count, 1);
+        const double elements = static_cast<double>(repeats * a_count);
+        const double evaluate = Time([&]() {
+            for (size_t i = 0; i < repeats; ++i) {
+                EvaluateCubic(segment, u, { out[0].data(), out[1].data(), out[2].data() });
+            }
+        });
+        const double test = Time([&]() {
+            for (size_t i = 0; i < repeats; ++i) {
+                TestHulls(hulls, tolerance, a_count, split.data());
+            }
+        });
+        return { evaluate * 1e6 / elements, test * 1e6 / elements };
+    }
+}
+
+int main() {
+    const std::vector<SimdLevel> levels = GetSupportedLevels();
+    std::printf("%10s %8s %10s %8s %10s %12s\n", "keyframes", "camera", "lines", "simd", "ms", "ns/segment");
+    for (const size_t count : { 1'000u, 10'000u, 100'000u }) {
+        const std::vector<RE::NiPoint3> points = MakePath(count);
+        RE::NiPoint3 center;
+        for (const auto& point : points) {
+            center += point / static_cast<float>(count);
+        }
+
+        for (const bool isNear : { false, true }) {
+            TessellationParams params;
+            params.cameraPosition = isNear ? center : center + RE::NiPoint3(0.f, 0.f, 100000.f);
+
+            for (const SimdLevel level : levels) {
+                SetSimdLevel(level);
+                std::vector<RE::NiPoint3> out;
+                out.reserve(count * 16);
+                const double milliseconds = Time([&]() { TessellatePath(points, {}, params, out); });
+                std::printf("%10zu %8s %10zu %8s %10.2f %12.1f\n", count, isNear ? "near" : "far", out.size() - 1, GetSimdLevelName(level),
+                            milliseconds, milliseconds * 1e6 / static_cast<double>(count - 1));
+            }
+        }
+    }
+
+    std::printf("\n%10s %8s %14s %14s\n", "batch", "simd", "evaluate ns", "hulls ns");
+    for (const size_t count : { 8u, 64u, 1024u }) {
+        for (const SimdLevel level : levels) {
+            SetSimdLevel(level);
+            const auto [evaluate, test] = TimeKernels(count);
+            std::printf("%10zu %8s %14.3f %14.3f\n", count, GetSimdLevelName(level), evaluate, test);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include "SplineEvaluator.h"
+#include "ToolCheck.h"
+
+// Checks the path evaluation against samples worked out by hand from FCFW's formulas, and that the tessellated path
+// keeps to its screen-space tolerance.
+
+using namespace FCSE;
+
+namespace {
+    bool Near(float a_actual, float a_expected) {
+        return std::abs(a_actual - a_expected) <= 1e-5f * std::max(1.f, std::abs(a_expected));
+    }
+
+    bool Near(const RE::NiPoint3& a_actual, const RE::NiPoint3& a_expected) {
+        return Near(a_actual.x, a_expected.x) && Near(a_actual.y, a_expected.y) && Near(a_actual.z, a_expected.z);
+    }
+
+    void TestEasing() {
+        FCSE_CHECK(Near(ApplyEasing(0.5f, false, false), 0.5f));
+        FCSE_CHECK(Near(ApplyEasing(0.5f, true, false), 0.25f));
+        FCSE_CHECK(Near(ApplyEasing(0.5f, false, true), 0.75f));
+        FCSE_CHECK(Near(ApplyEasing(0.5f, true, true), 0.5f));
+        FCSE_CHECK(Near(ApplyEasing(0.25f, true, false), 0.0625f));
+        FCSE_CHECK(Near(ApplyEasing(0.25f, false, true), 0.4375f));
+        FCSE_CHECK(Near(ApplyEasing(0.25f, true, true), 0.15625f));
+
+        // Every curve keeps the segment ends
+        for (const bool easeIn : { false, true }) {
+            for (const bool easeOut : { false, true }) {
+                FCSE_CHECK(ApplyEasing(0.f, easeIn, easeOut) == 0.f);
+                FCSE_CHECK(ApplyEasing(1.f, easeIn, easeOut) == 1.f);
+            }
+        }
+    }
+
+    void TestNone() {
+        using Evaluator = SegmentEvaluator<InterpolationMode::kNone>;
+        const RE::NiPoint3 p0(-1.f, 0.f, 0.f);
+        const RE::NiPoint3 p1(0.f, 0.f, 0.f);
+        const RE::NiPoint3 p2(4.f, 8.f, -2.f);
+        const RE::NiPoint3 p3(5.f, 8.f, -2.f);
+
+        FCSE_CHECK(Evaluator::Evaluate(p0, p1, p2, p3, 0.f) == p1);
+        FCSE_CHECK(Evaluator::Evaluate(p0, p1, p2, p3, 0.999f) == p1);
+        FCSE_CHECK(Evaluator::Evaluate(p0, p1, p2, p3, 1.f) == p2);
+        FCSE_CHECK(Evaluator::Derivative(p0, p1, p2, p3, 0.5f) == RE::NiPoint3());
+    }
+
+    void TestLinear() {
+        using Evaluator = SegmentEvaluator<InterpolationMode::kLinear>;
+        const RE::NiPoint3 p0(-1.f, 0.f, 0.f);
+        const RE::NiPoint3 p1(0.f, 0.f, 0.f);
+        const RE::NiPoint3 p2(4.f, 8.f, -2.f);
+        const RE::NiPoint3 p3(5.f, 8.f, -2.f);
+
+        FCSE_CHECK(Evaluator::Evaluate(p0, p1, p2, p3, 0.f) == p1);
+        FCSE_CHECK(Near(Evaluator::Evaluate(p0, p1, p2, p3, 0.25f), { 1.f, 2.f, -0.5f }));
+        FCSE_CHECK(Near(Evaluator::Evaluate(p0, p1, p2, p3, 0.5f), { 2.f, 4.f, -1.f }));
+        FCSE_CHECK(Evaluator::Evaluate(p0, p1, p2, p3, 1.f) == p2);
+        FCSE_CHECK(Evaluator::Derivative(p0, p1, p2, p3, 0.3f) == RE::NiPoint3(4.f, 8.f, -2.f));
+    }
+
+    void TestCubicHermite() {
+        using Evaluator = SegmentEvaluator<InterpolationMode::kCubicHermite>;
+
+        // Evenly spaced points: the tangents m1 = m2 = (1, 0.5, 0) cancel at the midpoint
+        {
+            const RE::NiPoint3 p0(0.f, 0.f, 0.f);
+            const RE::NiPoint3 p1(1.f, 0.f, 0.f);
+            const RE::NiPoint3 p2(2.f, 1.f, 0.f);
+            const RE::NiPoint3 p3(3.f, 1.f, 0.f);
+            FCSE_CHECK(Near(Evaluator::Evaluate(p0, p1, p2, p3, 0.f), p1));
+            FCSE_CHECK(Near(Evaluator::Evaluate(p0, p1, p2, p3, 0.5f), { 1.5f, 0.5f, 0.f }));
+            FCSE_CHECK(Near(Evaluator::Evaluate(p0, p1, p2, p3, 1.f), p2));
+        }
+
+        // First segment of a path (p0 = p1) turning towards p3: m1 = (5, 0, 0), m2 = (5, 5, 0).
+        // t = 0.25: h00 = 0.84375, h10 = 0.140625, h01 = 0.15625, h11 = -0.046875
+        // t = 0.5:  h00 = 0.5,     h10 = 0.125,    h01 = 0.5,     h11 = -0.125
+        {
+            const RE::NiPoint3 p0(0.f, 0.f, 0.f);
+            const RE::NiPoint3 p1(0.f, 0.f, 0.f);
+            const RE::NiPoint3 p2(10.f, 0.f, 0.f);
+            const RE::NiPoint3 p3(10.f, 10.f, 0.f);
+            FCSE_CHECK(Near(Evaluator::Evaluate(p0, p1, p2, p3, 0.25f), { 2.03125f, -0.234375f, 0.f }));
+            FCSE_CHECK(Near(Evaluator::Evaluate(p0, p1, p2, p3, 0.5f), { 5.f, -0.625f, 0.f }));
+            FCSE_CHECK(Near(Evaluator::Derivative(p0, p1, p2, p3, 0.f), { 5.f, 0.f, 0.f }));
+            FCSE_CHECK(Near(Evaluator::Derivative(p0, p1, p2, p3, 1.f), { 5.f, 5.f, 0.f }));
+
+            // The power basis used by the tessellator describes the same curve
+            const CubicSegment curve = CubicSegment::FromHermite(detail::ToArray(p0), detail::ToArray(p1), detail::ToArray(p2), detail::ToArray(p3));
+            const std::array<float, 5> u = { 0.f, 0.25f, 0.5f, 0.75f, 1.f };
+            std::array<std::array<float, 5>, 3> sample{};
+            EvaluateCubic(curve, u, { sample[0].data(), sample[1].data(), sample[2].data() });
+            for (size_t i = 0; i < u.size(); ++i) {
+                FCSE_CHECK(Near({ sample[0][i], sample[1][i], sample[2][i] }, Evaluator::Evaluate(p0, p1, p2, p3, u[i])));
+            }
+        }
+    }
+
+    void TestEvaluatePath() {
+        const std::array<RE::NiPoint3, 3> points = { RE::NiPoint3(0.f, 0.f, 0.f), RE::NiPoint3(10.f, 0.f, 0.f), RE::NiPoint3(10.f, 10.f, 0.f) };
+        const std::array<InterpolationMode, 3> modes = { InterpolationMode::kCubicHermite, InterpolationMode::kCubicHermite, InterpolationMode::kLinear };
+
+        // Segment 0 is the Hermite segment above with p3 = points[2]; ease-in maps t = 0.5 to 0.25
+        FCSE_CHECK(Near(EvaluatePath(points, modes, 0, 0.5f, false, false), { 5.f, -0.625f, 0.f }));
+        FCSE_CHECK(Near(EvaluatePath(points, modes, 0, 0.5f, true, false), { 2.03125f, -0.234375f, 0.f }));
+        // The mode of the end keyframe applies, so segment 1 is linear
+        FCSE_CHECK(Near(EvaluatePath(points, modes, 1, 0.25f, false, false), { 10.f, 2.5f, 0.f }));
+        FCSE_CHECK(Near(EvaluatePath(points, modes, 1, 0.5f, false, true), { 10.f, 7.5f, 0.f }));
+        // Out of range parameters clamp to the path
+        FCSE_CHECK(EvaluatePath(points, modes, 1, 2.f, false, false) == points[2]);
+        FCSE_CHECK(EvaluatePath(points, modes, 5, 0.f, false, false) == points[2]);
+        FCSE_CHECK(EvaluatePath({}, modes, 0, 0.f, false, false) == RE::NiPoint3());
+    }
+
+    float DistanceToPolyline(const RE::NiPoint3& a_point, std::span<const RE::NiPoint3> a_polyline) {
+        float distance = std::numeric_limits<float>::max();
+        for (size_t i = 0; i + 1 < a_polyline.size(); ++i) {
+            distance = std::min(distance, detail::DistanceToLine(a_point, a_polyline[i], a_polyline[i + 1]));
+        }
+        return distance;
+    }
+
+    void TestTessellation() {
+        const std::array<RE::NiPoint3, 5> points = { RE::NiPoint3(0.f, 0.f, 0.f), RE::NiPoint3(1000.f, 0.f, 200.f), RE::NiPoint3(1000.f, 1000.f, 0.f),
+                                                     RE::NiPoint3(0.f, 1000.f, -300.f), RE::NiPoint3(-500.f, 0.f, 0.f) };
+        const std::array<InterpolationMode, 5> modes = { InterpolationMode::kCubicHermite, InterpolationMode::kCubicHermite, InterpolationMode::kLinear,
+                                                         InterpolationMode::kCubicHermite, InterpolationMode::kNone };
+        TessellationParams params;
+        params.cameraPosition = { 500.f, 500.f, 2000.f };
+
+        std::vector<RE::NiPoint3> out;
+        TessellatePath(points, modes, params, out);
+        FCSE_CHECK(out.size() > points.size());
+        FCSE_CHECK(out.front() == points.front());
+        FCSE_CHECK(out.back() == points.back());
+
+        // Every keyframe is hit exactly and every segment stays within 2^maxDepth lines
+        size_t first = 0;
+        for (size_t i = 1; i < points.size(); ++i) {
+            const auto found = std::find(out.begin() + static_cast<std::ptrdiff_t>(first) + 1, out.end(), points[i]);
+            if (!FCSE_CHECK(found != out.end())) {
+                return;
+            }
+            const size_t last = static_cast<size_t>(found - out.begin());
+            const size_t lines = last - first;
+            FCSE_CHECK(lines <= (size_t(1) << params.maxDepth));
+            if (modes[i] != InterpolationMode::kCubicHermite) {
+                FCSE_CHECK(lines == 1);
+            }
+
+            // Dense samples of the curve lie within the allowed error of the lines
+            const std::span<const RE::NiPoint3> piece(out.data() + first, lines + 1);
+            for (int sample = 0; sample <= 256; ++sample) {
+                const float t = static_cast<float>(sample) / 256.f;
+                const RE::NiPoint3 point = EvaluatePath(points, modes, i - 1, t, false, false);
+                if (modes[i] == InterpolationMode::kNone) {
+                    continue;
+                }
+                const float allowed = detail::AllowedError(params, point, point) * 1.001f + 1e-3f;
+                FCSE_CHECK(DistanceToPolyline(point, piece) <= allowed);
+            }
+            first = last;
+        }
+    }
+}
+
+int main() {
+    TestEasing();
+    TestNone();
+    TestLinear();
+    TestCubicHermite();
+    TestEvaluatePath();
+    TestTessellation();
+    return Tools::Finish();
+}
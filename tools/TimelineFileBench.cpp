@@ -0,0 +1,131 @@
+#include "TimelineFile.h"
+#include "YamlWriter.h"
+
+#include <cstdio>
+#include <random>
+
+// Times reading and writing timeline files of 10k, 100k and 1M keyframes in both formats and checks that the binary
+// copy decodes to the same keyframes. Files are written under Data/ in the working directory.
+
+using namespace FCSE;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double GetMilliseconds(Clock::time_point a_start, Clock::time_point a_end) {
+        return std::chrono::duration<double, std::milli>(a_end - a_start).count();
+    }
+
+    // Best of a few runs, the first one also pays for the page cache
+    template <class Func>
+    double Time(Func&& a_func) {
+        constexpr int kRuns = 3;
+        double best = std::numeric_limits<double>::max();
+        for (int run = 0; run < kRuns; ++run) {
+            const auto start = Clock::now();
+            a_func();
+            best = std::min(best, GetMilliseconds(start, Clock::now()));
+        }
+        return best;
+    }
+
+    // World, reference and camera keyframes with every flag and mode, limited to what the YAML format can express
+    TimelineData MakeTimeline(size_t a_count) {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> coordinate(-100000.f, 100000.f);
+        std::uniform_real_distribution<float> angle(-3.f, 3.f);
+
+        TimelineData data;
+        data.translations.reserve(a_count);
+        data.rotations.reserve(a_count);
+        for (size_t i = 0; i < a_count; ++i) {
+            TranslationKeyframe translation;
+            translation.time = static_cast<float>(i) * 0.01f;
+            translation.value = { coordinate(random), coordinate(random), coordinate(random) / 10.f };
+            translation.mode = static_cast<InterpolationMode>(i % 3);
+            translation.flags = static_cast<uint8_t>(i % 4);
+            if (i % 11 == 0) {
+                translation.flags |= kKeyframeAtCamera;
+            } else if (i % 7 == 0) {
+                translation.reference = 0x000D8C58;
+                translation.flags |= kKeyframeOffsetRelative;
+            }
+
+            RotationKeyframe rotation;
+            rotation.time = translation.time;
+            rotation.value = { angle(random), angle(random) };
+            rotation.mode = translation.mode;
+            rotation.flags = translation.flags;
+            rotation.reference = translation.reference;
+
+            data.translations.push_back(translation);
+            data.rotations.push_back(rotation);
+        }
+        return data;
+    }
+
+    // Largest position error of the quantised binary copy, or -1 if it exceeds the quantisation step plus float rounding
+    // or anything else differs
+    float Compare(const TimelineData& a_expected, const TimelineData& a_actual) {
+        if (a_actual.translations.size() != a_expected.translations.size() || a_actual.rotations != a_expected.rotations) {
+            return -1.f;
+        }
+        float maxError = 0.f;
+        for (size_t i = 0; i < a_expected.translations.size(); ++i) {
+            const auto& expected = a_expected.translations[i];
+            const auto& actual = a_actual.translations[i];
+            if (actual.time != expected.time || actual.flags != expected.flags || actual.mode != expected.mode || actual.reference != expected.reference) {
+                return -1.f;
+            }
+            for (size_t axis = 0; axis < 3; ++axis) {
+                const float error = std::abs(actual.value[axis] - expected.value[axis]);
+                if (error > TimelineFile::kPositionStep + std::abs(expected.value[axis]) * std::numeric_limits<float>::epsilon()) {
+                    return -1.f;
+                }
+                maxError = std::max(maxError, error);
+            }
+        }
+        return maxError;
+    }
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+    std::filesystem::create_directories(TimelineFile::GetFullPath("SKSE/Plugins"));
+    constexpr std::string_view yamlPath = "SKSE/Plugins/FCSE_Bench.yaml";
+    constexpr std::string_view binaryPath = "SKSE/Plugins/FCSE_Bench.fcsb";
+
+    std::printf("%10s %10s %10s %10s %10s %10s %10s %10s %12s\n", "keyframes", "yaml MB", "yaml w ms", "yaml r ms", "fcsb MB",
+                "fcsb w ms", "open ms", "decode ms", "max error");
+    bool succeeded = true;
+    for (const size_t count : { 10'000u, 100'000u, 1'000'000u }) {
+        const TimelineData data = MakeTimeline(count);
+
+        bool written = true;
+        const double writeYaml = Time([&]() { written &= Tools::WriteYaml(yamlPath, data); });
+        const double readYaml = Time([&]() {
+            TimelineData read;
+            written &= TimelineFile::ReadYaml(yamlPath, read);
+        });
+        const double writeBinary = Time([&]() { written &= TimelineFile::WriteBinary(binaryPath, data); });
+
+        // Open maps the file and checks its checksum and layout, ReadAll decodes every keyframe
+        MappedTimeline timeline;
+        const double open = Time([&]() { written &= timeline.Open(binaryPath); });
+        TimelineData decoded;
+        const double decode = Time([&]() { timeline.ReadAll(decoded); });
+        const float maxError = Compare(data, decoded);
+
+        TimelineData yaml;
+        written &= TimelineFile::ReadYaml(yamlPath, yaml) && yaml.translations == data.translations && yaml.rotations == data.rotations;
+        const bool matches = written && maxError >= 0.f;
+        succeeded &= matches;
+
+        const double megabyte = 1024. * 1024.;
+        std::printf("%10zu %10.2f %10.1f %10.1f %10.2f %10.1f %10.2f %10.2f %12g%s\n", count,
+                    std::filesystem::file_size(TimelineFile::GetFullPath(yamlPath)) / megabyte, writeYaml, readYaml,
+                    std::filesystem::file_size(TimelineFile::GetFullPath(binaryPath)) / megabyte, writeBinary, open, decode, maxError,
+                    matches ? "" : "  MISMATCH");
+    }
+    return succeeded ? 0 : 1;
+}
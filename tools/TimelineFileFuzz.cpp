@@ -0,0 +1,143 @@
+#include "TimelineFile.h"
+#include "YamlWriter.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+
+// Feeds mutated YAML and binary timeline files to every reader and checks what they return. Built with AddressSanitizer
+// and UndefinedBehaviorSanitizer, so reads outside the mapping or overflowing conversions stop the run.
+//
+//     TimelineFileFuzz [iterations] [seed]
+
+using namespace FCSE;
+
+namespace {
+    constexpr std::string_view kYamlPath = "SKSE/Plugins/FCSE_Fuzz.yaml";
+    constexpr std::string_view kBinaryPath = "SKSE/Plugins/FCSE_Fuzz.fcsb";
+
+    // Fragments that steer mutations towards the parser's special cases
+    constexpr std::string_view kTokens[] = {
+        "{", "}", ":", ",", "-", "\n", "\r\n", "\t", "  ", "#", " # comment", "\"a # b\"", "'c#d'", "\"\\\"#\"", "---", "nan", "inf",
+        "-inf", "1e39", "-1e39", "0x", "0xFFFFFFFFFF", "translationPoints:\n", "rotationPoints:\n", "position: {x: ", "rotation: {pitch: ",
+        "time: ", "type: reference", "type: world", "type: camera", "reference: 0x000D8C58", "{x: 1, y: 2, z: 3}", ""
+    };
+
+    std::string ReadRaw(std::string_view a_path) {
+        std::ifstream file(TimelineFile::GetFullPath(a_path), std::ios::binary);
+        return { std::istreambuf_iterator<char>(file), {} };
+    }
+
+    void WriteRaw(std::string_view a_path, const std::string& a_bytes) {
+        std::ofstream file(TimelineFile::GetFullPath(a_path), std::ios::binary | std::ios::trunc);
+        file.write(a_bytes.data(), static_cast<std::streamsize>(a_bytes.size()));
+    }
+
+    void Mutate(std::string& a_bytes, std::mt19937& a_random) {
+        const uint32_t mutationCount = 1 + a_random() % 16;
+        for (uint32_t i = 0; i < mutationCount && !a_bytes.empty(); ++i) {
+            const size_t position = a_random() % a_bytes.size();
+            switch (a_random() % 5) {
+            case 0:
+                a_bytes[position] = static_cast<char>(a_random());
+                break;
+            case 1:
+                a_bytes.erase(position, 1 + a_random() % 64);
+                break;
+            case 2:
+                a_bytes.insert(position, kTokens[a_random() % std::size(kTokens)]);
+                break;
+            case 3:
+                a_bytes.resize(position);
+                break;
+            default:
+                a_bytes.insert(position, a_bytes.substr(a_random() % a_bytes.size(), a_random() % 128));
+                break;
+            }
+        }
+    }
+
+    template <size_t N>
+    bool IsSorted(const std::vector<Keyframe<N>>& a_keyframes) {
+        return std::ranges::is_sorted(a_keyframes, {}, &Keyframe<N>::time);
+    }
+
+    // What every reader promises for any input, valid or not
+    const char* Check(const TimelineData& a_data, const TimelinePreview& a_preview) {
+        if (!IsSorted(a_data.translations) || !IsSorted(a_data.rotations)) {
+            return "keyframes not sorted by time";
+        }
+        if (a_preview.points.size() != a_preview.times.size() || !std::ranges::is_sorted(a_preview.times)) {
+            return "preview times missing or not sorted";
+        }
+        for (const auto& point : a_preview.points) {
+            for (size_t axis = 0; axis < 3; ++axis) {
+                if (!std::isfinite(point[axis]) || point[axis] < a_preview.boundsMin[axis] || point[axis] > a_preview.boundsMax[axis]) {
+                    return "preview point not finite or outside the bounds";
+                }
+            }
+        }
+        return nullptr;
+    }
+}
+
+int main(int a_argc, char** a_argv) {
+    const long iterations = a_argc > 1 ? std::strtol(a_argv[1], nullptr, 10) : 20000;
+    const unsigned long seed = a_argc > 2 ? std::strtoul(a_argv[2], nullptr, 10) : 7;
+    spdlog::set_level(spdlog::level::off);
+    std::filesystem::create_directories(TimelineFile::GetFullPath("SKSE/Plugins"));
+
+    std::mt19937 random(static_cast<std::mt19937::result_type>(seed));
+    std::uniform_real_distribution<float> coordinate(-1000.f, 1000.f);
+    TimelineData seedData;
+    for (int i = 0; i < 200; ++i) {
+        TranslationKeyframe translation;
+        translation.time = static_cast<float>(i) * 0.5f;
+        translation.value = { coordinate(random), coordinate(random), coordinate(random) };
+        translation.reference = i % 5 == 0 ? 0x14 : 0;
+        seedData.translations.push_back(translation);
+
+        RotationKeyframe rotation;
+        rotation.time = translation.time;
+        rotation.value = { coordinate(random) / 1000.f, coordinate(random) / 1000.f };
+        seedData.rotations.push_back(rotation);
+    }
+    if (!Tools::WriteYaml(kYamlPath, seedData) || !TimelineFile::WriteBinary(kBinaryPath, seedData)) {
+        std::printf("Could not write the seed files under Data/\n");
+        return 1;
+    }
+    const std::string yamlSeed = ReadRaw(kYamlPath);
+    const std::string binarySeed = ReadRaw(kBinaryPath);
+
+    size_t accepted = 0;
+    TimelinePreview preview;
+    for (long iteration = 0; iteration < iterations; ++iteration) {
+        // Every fourth input is binary. Those are also opened without the checksum, so damaged chunks reach the decoder.
+        const bool isBinary = iteration % 4 == 3;
+        const std::string_view path = isBinary ? kBinaryPath : kYamlPath;
+        std::string bytes = isBinary ? binarySeed : yamlSeed;
+        Mutate(bytes, random);
+        WriteRaw(path, bytes);
+
+        TimelineData data;
+        accepted += TimelineFile::Read(path, data);
+        TimelineFile::ReadPreview(path, preview);
+        const char* failure = Check(data, preview);
+        if (!failure && isBinary) {
+            MappedTimeline timeline;
+            if (timeline.Open(path, false)) {
+                timeline.ReadAll(data);
+                failure = Check(data, preview);
+            }
+        }
+        if (failure) {
+            const std::string_view failurePath = isBinary ? "FCSE_Fuzz_Failure.fcsb" : "FCSE_Fuzz_Failure.yaml";
+            WriteRaw(failurePath, bytes);
+            std::printf("Iteration %ld: %s, input saved as Data/%s\n", iteration, failure, failurePath.data());
+            return 1;
+        }
+    }
+    std::printf("%ld inputs, %zu read without error\n", iterations, accepted);
+    return 0;
+}
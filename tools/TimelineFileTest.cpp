@@ -0,0 +1,111 @@
+#include "TimelineFile.h"
+#include "ToolCheck.h"
+#include "YamlWriter.h"
+
+#include <fstream>
+
+// Checks which files TimelineFile::Read accepts. An import reads the file with it on a worker thread and passes the file
+// to FCFW's AddTimelineFromFile when it fails, so anything FCSE cannot read must fail here instead of reading as an
+// empty timeline or as keyframes at the origin.
+
+using namespace FCSE;
+
+namespace {
+    void WriteText(std::string_view a_path, std::string_view a_text) {
+        std::ofstream file(TimelineFile::GetFullPath(a_path), std::ios::binary | std::ios::trunc);
+        file.write(a_text.data(), static_cast<std::streamsize>(a_text.size()));
+    }
+
+    bool ReadText(std::string_view a_text, TimelineData& a_out) {
+        constexpr std::string_view path = "SKSE/Plugins/FCSE_Test.yaml";
+        WriteText(path, a_text);
+        return TimelineFile::Read(path, a_out);
+    }
+
+    void TestRoundTrip() {
+        TimelineData data;
+        data.translations.push_back({ .time = 0.f, .value = { 1.f, 2.f, 3.f } });
+        data.translations.push_back({ .time = 1.5f, .value = { 0.f, 0.f, 0.f }, .flags = kKeyframeAtCamera });
+        data.translations.push_back({ .time = 3.f, .value = { 10.f, 0.f, -5.f }, .flags = kKeyframeOffsetRelative, .reference = 0x14 });
+        data.rotations.push_back({ .time = 0.f, .value = { 0.25f, -1.f }, .mode = InterpolationMode::kLinear });
+
+        constexpr std::string_view path = "SKSE/Plugins/FCSE_Test.yaml";
+        TimelineData read;
+        FCSE_CHECK(Tools::WriteYaml(path, data));
+        FCSE_CHECK(TimelineFile::Read(path, read));
+        FCSE_CHECK(read.translations == data.translations);
+        FCSE_CHECK(read.rotations == data.rotations);
+    }
+
+    void TestCommentsAndQuotes() {
+        TimelineData read;
+        FCSE_CHECK(ReadText("# exported by hand\n"
+                            "translationPoints:  # world points only\n"
+                            "  - time: 2  # seconds\n"
+                            "    type: world\n"
+                            "    name: \"shot #1\"\n"
+                            "    position: {x: 1, y: 2, z: 3}\n",
+                            read));
+        FCSE_CHECK(read.translations.size() == 1 && read.translations[0].time == 2.f && read.translations[0].value[2] == 3.f);
+    }
+
+    // Files FCFW may understand but this reader does not
+    void TestForeignLayouts() {
+        TimelineData read;
+
+        // Different top-level keys
+        FCSE_CHECK(!ReadText("keyframes:\n"
+                             "  - t: 1.0\n"
+                             "    pos: [1.0, 2.0, 3.0]\n",
+                             read));
+        FCSE_CHECK(read.translations.empty() && read.rotations.empty());
+
+        // Known sections, unknown keys in the points
+        FCSE_CHECK(!ReadText("translationPoints:\n"
+                             "  - timestamp: 1.0\n"
+                             "    location: [1.0, 2.0, 3.0]\n"
+                             "rotationPoints:\n"
+                             "  - timestamp: 1.0\n"
+                             "    angles: [0.1, 0.2]\n",
+                             read));
+        FCSE_CHECK(read.translations.empty() && read.rotations.empty());
+
+        // One point of many without its value is enough to fail, rather than import it at the origin
+        FCSE_CHECK(!ReadText("translationPoints:\n"
+                             "  - time: 0.0\n"
+                             "    position: {x: 1, y: 2, z: 3}\n"
+                             "  - time: 1.0\n"
+                             "    position: [4, 5, 6]\n",
+                             read));
+
+        // Sections without points, and an empty file
+        FCSE_CHECK(!ReadText("translationPoints:\nrotationPoints:\n", read));
+        FCSE_CHECK(!ReadText("", read));
+        FCSE_CHECK(!TimelineFile::Read("SKSE/Plugins/FCSE_Missing.yaml", read));
+    }
+
+    // Camera points have no position of their own, so they need none in the file
+    void TestCameraPointsWithoutValue() {
+        TimelineData read;
+        FCSE_CHECK(ReadText("translationPoints:\n"
+                            "  - time: 0.5\n"
+                            "    type: camera\n"
+                            "rotationPoints:\n"
+                            "  - time: 0.5\n"
+                            "    type: camera\n",
+                            read));
+        FCSE_CHECK(read.translations.size() == 1 && (read.translations[0].flags & kKeyframeAtCamera));
+        FCSE_CHECK(read.rotations.size() == 1 && (read.rotations[0].flags & kKeyframeAtCamera));
+    }
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::off);
+    std::filesystem::create_directories(TimelineFile::GetFullPath("SKSE/Plugins"));
+
+    TestRoundTrip();
+    TestCommentsAndQuotes();
+    TestForeignLayouts();
+    TestCameraPointsWithoutValue();
+    return Tools::Finish();
+}
@@ -0,0 +1,228 @@
+#include "MockFCFW.h"
+#include "TimelineModel.h"
+#include "ToolCheck.h"
+
+// Checks the calls TimelineModel::Sync makes against a recording MockFCFW, and that the mock's timeline matches the
+// model afterwards, including when FCFW orders keyframes with equal times differently than the model does.
+
+using namespace FCSE;
+
+namespace {
+    using Call = Tools::MockFCFW::Call;
+    using TieOrder = Tools::MockFCFW::TieOrder;
+
+    constexpr SKSE::PluginHandle kHandle = 1;
+
+    TranslationKeyframe MakeTranslation(float a_time, float a_x) {
+        return { .time = a_time, .value = { a_x, 0.f, 0.f } };
+    }
+
+    RotationKeyframe MakeRotation(float a_time, float a_yaw) {
+        return { .time = a_time, .value = { 0.f, a_yaw } };
+    }
+
+    // Keyframes in a fixed order, so tracks that only differ in the order of equal times compare equal
+    template <size_t N>
+    std::vector<Keyframe<N>> Sorted(std::vector<Keyframe<N>> a_keyframes) {
+        std::sort(a_keyframes.begin(), a_keyframes.end(), [](const Keyframe<N>& a_lhs, const Keyframe<N>& a_rhs) {
+            return std::tie(a_lhs.time, a_lhs.value, a_lhs.flags, a_lhs.mode) < std::tie(a_rhs.time, a_rhs.value, a_rhs.flags, a_rhs.mode);
+        });
+        return a_keyframes;
+    }
+
+    template <size_t N>
+    std::vector<Keyframe<N>> ToVector(const KeyframeTrack<N>& a_track) {
+        std::vector<Keyframe<N>> keyframes;
+        a_track.ForEach([&keyframes](const Keyframe<N>& a_keyframe) { keyframes.push_back(a_keyframe); });
+        return keyframes;
+    }
+
+    bool Matches(const TimelineModel& a_model, const Tools::MockFCFW& a_fcfw, size_t a_timelineID) {
+        const auto timeline = a_fcfw.GetTimeline(a_timelineID);
+        return Sorted(ToVector(a_model.GetTranslations())) == Sorted(timeline.translations) &&
+               Sorted(ToVector(a_model.GetRotations())) == Sorted(timeline.rotations);
+    }
+
+    size_t CountCalls(const std::vector<Call>& a_calls, Call::Type a_type) {
+        return static_cast<size_t>(std::count_if(a_calls.begin(), a_calls.end(), [a_type](const Call& a_call) { return a_call.type == a_type; }));
+    }
+
+    void TestAdd() {
+        Tools::MockFCFW fcfw;
+        const size_t timelineID = fcfw.RegisterTimeline(kHandle);
+        TimelineModel model;
+        model.AddTranslation(MakeTranslation(2.f, 30.f));
+        model.AddTranslation(MakeTranslation(0.f, 10.f));
+        model.AddTranslation({ .time = 1.f, .flags = kKeyframeAtCamera | kKeyframeEaseIn, .mode = InterpolationMode::kLinear });
+        model.AddRotation(MakeRotation(0.f, 1.f));
+        model.AddRotation(MakeRotation(1.5f, 2.f));
+
+        const auto stats = model.Sync(fcfw, kHandle, timelineID);
+        FCSE_CHECK(stats.added == 5 && stats.removed == 0 && stats.failed == 0 && !stats.rewritten);
+        const auto calls = fcfw.TakeCalls();
+        FCSE_CHECK(calls.size() == 5);
+        FCSE_CHECK(CountCalls(calls, Call::Type::kAddTranslation) == 3 && CountCalls(calls, Call::Type::kAddRotation) == 2);
+        FCSE_CHECK(Matches(model, fcfw, timelineID));
+        FCSE_CHECK(!model.IsDirty());
+
+        // Nothing changed, nothing is sent
+        const auto again = model.Sync(fcfw, kHandle, timelineID);
+        FCSE_CHECK(again.added == 0 && again.removed == 0);
+        FCSE_CHECK(fcfw.TakeCalls().empty());
+    }
+
+    void TestRemoveBackToFront() {
+        Tools::MockFCFW fcfw;
+        const size_t timelineID = fcfw.RegisterTimeline(kHandle);
+        TimelineModel model;
+        for (int i = 0; i < 5; ++i) {
+            model.AddTranslation(MakeTranslation(static_cast<float>(i), static_cast<float>(i) * 10.f));
+        }
+        model.Sync(fcfw, kHandle, timelineID);
+        fcfw.TakeCalls();
+
+        // The keyframes at 1 and 3; the second index is after the first removal
+        model.RemoveTranslation(1);
+        model.RemoveTranslation(2);
+        const auto stats = model.Sync(fcfw, kHandle, timelineID);
+        FCSE_CHECK(stats.removed == 2 && stats.added == 0 && !stats.rewritten);
+        const std::vector<Call> expected = { { Call::Type::kRemoveTranslation, timelineID, 3, 3.f }, { Call::Type::kRemoveTranslation, timelineID, 1, 1.f } };
+        FCSE_CHECK(fcfw.TakeCalls() == expected);
+        FCSE_CHECK(Matches(model, fcfw, timelineID));
+
+        // A changed keyframe is removed and added again
+        model.SetTranslation(1, MakeTranslation(2.f, -5.f));
+        model.Sync(fcfw, kHandle, timelineID);
+        const std::vector<Call> changed = { { Call::Type::kRemoveTranslation, timelineID, 1, 2.f }, { Call::Type::kAddTranslation, timelineID, 1, 2.f } };
+        FCSE_CHECK(fcfw.TakeCalls() == changed);
+        FCSE_CHECK(Matches(model, fcfw, timelineID));
+    }
+
+    void TestClearAndRewrite() {
+        Tools::MockFCFW fcfw;
+        const size_t timelineID = fcfw.RegisterTimeline(kHandle);
+        TimelineModel model;
+        for (int i = 0; i < 3; ++i) {
+            model.AddTranslation(MakeTranslation(static_cast<float>(i), 1.f));
+        }
+        model.AddRotation(MakeRotation(0.f, 0.5f));
+        model.Sync(fcfw, kHandle, timelineID);
+        fcfw.TakeCalls();
+
+        // Everything goes, so one ClearTimeline replaces four removals
+        model.Clear();
+        model.AddTranslation(MakeTranslation(0.5f, 7.f));
+        model.AddTranslation(MakeTranslation(4.f, 8.f));
+        const auto stats = model.Sync(fcfw, kHandle, timelineID);
+        FCSE_CHECK(stats.rewritten && stats.removed == 4 && stats.added == 2 && stats.failed == 0);
+        const auto calls = fcfw.TakeCalls();
+        FCSE_CHECK(!calls.empty() && calls.front().type == Call::Type::kClear);
+        FCSE_CHECK(CountCalls(calls, Call::Type::kRemoveTranslation) + CountCalls(calls, Call::Type::kRemoveRotation) == 0);
+        FCSE_CHECK(CountCalls(calls, Call::Type::kAddTranslation) == 2);
+        FCSE_CHECK(Matches(model, fcfw, timelineID));
+    }
+
+    // Removing or changing one of several keyframes with the same time must not depend on FCFW's order among them
+    void TestEqualTimes(TieOrder a_order) {
+        Tools::MockFCFW fcfw;
+        fcfw.SetTieOrder(a_order);
+        const size_t timelineID = fcfw.RegisterTimeline(kHandle);
+        TimelineModel model;
+        model.AddTranslation(MakeTranslation(0.f, 0.f));
+        model.AddTranslation(MakeTranslation(1.f, 1.f));
+        model.AddTranslation(MakeTranslation(1.f, 2.f));
+        model.AddTranslation(MakeTranslation(1.f, 3.f));
+        model.AddTranslation(MakeTranslation(2.f, 4.f));
+        model.AddRotation(MakeRotation(1.f, 1.f));
+        model.AddRotation(MakeRotation(1.f, 2.f));
+        model.AddRotation(MakeRotation(3.f, 3.f));
+        model.Sync(fcfw, kHandle, timelineID);
+        FCSE_CHECK(Matches(model, fcfw, timelineID));
+        fcfw.TakeCalls();
+
+        // The last keyframe of each group, the only one the diff itself removes
+        model.RemoveTranslation(3);
+        model.RemoveRotation(1);
+        auto stats = model.Sync(fcfw, kHandle, timelineID);
+        FCSE_CHECK(stats.failed == 0 && !stats.rewritten);
+        FCSE_CHECK(Matches(model, fcfw, timelineID));
+        // The rest of the group at 1 is sent again, the keyframes around it are left alone
+        const auto calls = fcfw.TakeCalls();
+        FCSE_CHECK(CountCalls(calls, Call::Type::kRemoveTranslation) == 3 && CountCalls(calls, Call::Type::kAddTranslation) == 2);
+        FCSE_CHECK(CountCalls(calls, Call::Type::kRemoveRotation) == 2 && CountCalls(calls, Call::Type::kAddRotation) == 1);
+        FCSE_CHECK(std::all_of(calls.begin(), calls.end(), [](const Call& a_call) { return a_call.time == 1.f; }));
+
+        model.SetTranslation(2, MakeTranslation(1.f, 9.f));
+        model.AddTranslation(MakeTranslation(1.f, 5.f));
+        stats = model.Sync(fcfw, kHandle, timelineID);
+        FCSE_CHECK(stats.failed == 0);
+        FCSE_CHECK(Matches(model, fcfw, timelineID));
+
+        // Keyframes at unique times still cost a single call
+        fcfw.TakeCalls();
+        model.RemoveTranslation(0);
+        model.Sync(fcfw, kHandle, timelineID);
+        const std::vector<Call> unique = { { Call::Type::kRemoveTranslation, timelineID, 0, 0.f } };
+        FCSE_CHECK(fcfw.TakeCalls() == unique);
+        FCSE_CHECK(Matches(model, fcfw, timelineID));
+    }
+
+    void TestStaleIndices() {
+        Tools::MockFCFW fcfw;
+        const size_t timelineID = fcfw.RegisterTimeline(kHandle);
+        TimelineModel model;
+        for (int i = 0; i < 3; ++i) {
+            model.AddTranslation(MakeTranslation(static_cast<float>(i), static_cast<float>(i)));
+        }
+        model.Sync(fcfw, kHandle, timelineID);
+
+        // A recording adds a point the model does not know about
+        (void)fcfw.AddTranslationPoint(kHandle, timelineID, 0.5f, { 100.f, 0.f, 0.f }, false, false, 2);
+        model.MarkExternallyModified();
+        fcfw.TakeCalls();
+
+        // Additions do not depend on indices and are still patched in
+        model.AddTranslation(MakeTranslation(3.f, 3.f));
+        auto stats = model.Sync(fcfw, kHandle, timelineID);
+        FCSE_CHECK(!stats.rewritten && stats.added == 1);
+        FCSE_CHECK(fcfw.TakeCalls().size() == 1);
+        FCSE_CHECK(fcfw.GetTimeline(timelineID).translations.size() == 5);
+        FCSE_CHECK(model.IsExternallyModified());
+
+        // A removal by index would hit the wrong point, so the timeline is rewritten from the model
+        model.RemoveTranslation(1);
+        stats = model.Sync(fcfw, kHandle, timelineID);
+        FCSE_CHECK(stats.rewritten && stats.added == 3 && stats.failed == 0);
+        const auto calls = fcfw.TakeCalls();
+        FCSE_CHECK(!calls.empty() && calls.front().type == Call::Type::kClear);
+        FCSE_CHECK(CountCalls(calls, Call::Type::kRemoveTranslation) == 0);
+        FCSE_CHECK(Matches(model, fcfw, timelineID));
+        FCSE_CHECK(!model.IsExternallyModified());
+    }
+
+    // Keyframes bound to references cannot be sent outside the game, which exercises the failure path
+    void TestFailedAdd() {
+        Tools::MockFCFW fcfw;
+        const size_t timelineID = fcfw.RegisterTimeline(kHandle);
+        TimelineModel model;
+        model.AddTranslation(MakeTranslation(0.f, 0.f));
+        model.AddTranslation({ .time = 1.f, .value = { 0.f, 0.f, 50.f }, .reference = 0x14 });
+
+        const auto stats = model.Sync(fcfw, kHandle, timelineID);
+        FCSE_CHECK(stats.added == 2 && stats.failed == 1);
+        FCSE_CHECK(fcfw.GetTimeline(timelineID).translations.size() == 1);
+        FCSE_CHECK(model.IsExternallyModified());
+    }
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::err);
+    TestAdd();
+    TestRemoveBackToFront();
+    TestClearAndRewrite();
+    TestEqualTimes(TieOrder::kAfter);
+    TestEqualTimes(TieOrder::kBefore);
+    TestStaleIndices();
+    TestFailedAdd();
+    return Tools::Finish();
+}
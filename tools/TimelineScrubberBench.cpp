@@ -0,0 +1,142 @@
+#include "ArcLengthTable.h"
+#include "TimelineScrubber.h"
+
+#include <cstdio>
+#include <random>
+
+// Times the lookups scrubbing makes every frame on timelines of 1k, 10k and 100k keyframes: TimelineScrubber::Evaluate
+// at random times and along a sweep, as dragging the scrub slider does, and ArcLengthTable::Locate at random distances
+// with and without evaluating the path there. Each lookup has to stay under a microsecond, and both have to land on the
+// keyframes at their own times and distances.
+
+using namespace FCSE;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t kLookups = 1'000'000;
+    constexpr double kBudgetNanoseconds = 1000.;
+
+    // Results are summed into this so the lookups are not optimised away
+    volatile float g_sink = 0.f;
+
+    // Best of a few runs, in nanoseconds per lookup
+    template <class Func>
+    double TimePerLookup(Func&& a_func) {
+        constexpr int kRuns = 5;
+        double best = std::numeric_limits<double>::max();
+        for (int run = 0; run < kRuns; ++run) {
+            const auto start = Clock::now();
+            a_func();
+            best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start).count() / kLookups);
+        }
+        return best;
+    }
+
+    // A random walk like a recorded camera path, with uneven gaps between the keyframe times
+    void MakeTimeline(size_t a_count, std::vector<float>& a_times, std::vector<std::array<float, 3>>& a_positions,
+                      std::vector<std::array<float, 2>>& a_rotations) {
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> step(-200.f, 200.f);
+        std::uniform_real_distribution<float> gap(0.05f, 0.5f);
+        std::uniform_real_distribution<float> turn(-0.3f, 0.3f);
+
+        std::array<float, 3> position{};
+        std::array<float, 2> rotation{};
+        float time = 0.f;
+        for (size_t i = 0; i < a_count; ++i) {
+            position = { position[0] + step(random), position[1] + step(random), position[2] + step(random) / 4.f };
+            rotation = { std::clamp(rotation[0] + turn(random), -1.f, 1.f), rotation[1] + turn(random) };
+            a_times.push_back(time);
+            a_positions.push_back(position);
+            a_rotations.push_back(rotation);
+            time += gap(random);
+        }
+    }
+}
+
+int main() {
+    std::printf("%10s %12s %12s %12s %14s %8s\n", "keyframes", "random ns", "sweep ns", "locate ns", "locate+eval ns", "checks");
+    bool succeeded = true;
+    for (const size_t count : { 1'000u, 10'000u, 100'000u }) {
+        std::vector<float> times;
+        std::vector<std::array<float, 3>> positions;
+        std::vector<std::array<float, 2>> rotations;
+        MakeTimeline(count, times, positions, rotations);
+
+        TimelineScrubber scrubber;
+        scrubber.Build({ .times = times, .values = positions }, { .times = times, .values = rotations }, 1);
+
+        std::vector<RE::NiPoint3> points;
+        points.reserve(count);
+        for (const auto& position : positions) {
+            points.emplace_back(position[0], position[1], position[2]);
+        }
+        const std::vector<InterpolationMode> modes(count, InterpolationMode::kCubicHermite);
+        ArcLengthTable table;
+        table.Build(points, modes);
+
+        std::mt19937 random(2);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+        std::vector<float> randomTimes(kLookups);
+        std::vector<float> distances(kLookups);
+        for (size_t i = 0; i < kLookups; ++i) {
+            randomTimes[i] = scrubber.GetStartTime() + unit(random) * (scrubber.GetEndTime() - scrubber.GetStartTime());
+            distances[i] = unit(random) * table.GetTotalLength();
+        }
+
+        float sink = 0.f;
+        TimelineScrubber::Sample sample;
+        const double randomTime = TimePerLookup([&]() {
+            for (const float time : randomTimes) {
+                scrubber.Evaluate(time, sample);
+                sink += sample.position.x + sample.yaw;
+            }
+        });
+        const double sweepTime = TimePerLookup([&]() {
+            const float step = (scrubber.GetEndTime() - scrubber.GetStartTime()) / static_cast<float>(kLookups);
+            for (size_t i = 0; i < kLookups; ++i) {
+                scrubber.Evaluate(scrubber.GetStartTime() + static_cast<float>(i) * step, sample);
+                sink += sample.position.x + sample.yaw;
+            }
+        });
+        const double locateTime = TimePerLookup([&]() {
+            size_t segment = 0;
+            float t = 0.f;
+            for (const float distance : distances) {
+                table.Locate(distance, segment, t);
+                sink += static_cast<float>(segment) + t;
+            }
+        });
+        const double evaluateTime = TimePerLookup([&]() {
+            size_t segment = 0;
+            float t = 0.f;
+            for (const float distance : distances) {
+                table.Locate(distance, segment, t);
+                sink += EvaluatePath(points, modes, segment, t, false, false).x;
+            }
+        });
+
+        // A span starts exactly at its keyframe, and the table's keyframe distances lead back to the keyframes
+        size_t failures = 0;
+        for (size_t i = 0; i < count; ++i) {
+            scrubber.Evaluate(times[i], sample);
+            if (sample.position.GetDistance(points[i]) > 0.01f) {
+                ++failures;
+            }
+            size_t segment = 0;
+            float t = 0.f;
+            table.Locate(table.GetKeyframeDistance(i), segment, t);
+            if (EvaluatePath(points, modes, segment, t, false, false).GetDistance(points[i]) > 0.5f) {
+                ++failures;
+            }
+        }
+
+        const bool isWithinBudget = std::max({ randomTime, sweepTime, locateTime, evaluateTime }) < kBudgetNanoseconds;
+        succeeded &= failures == 0 && isWithinBudget;
+        std::printf("%10zu %12.1f %12.1f %12.1f %14.1f %8s%s\n", count, randomTime, sweepTime, locateTime, evaluateTime,
+                    failures == 0 ? "ok" : "FAILED", isWithinBudget ? "" : "  OVER BUDGET");
+        g_sink = sink;
+    }
+    return succeeded ? 0 : 1;
+}
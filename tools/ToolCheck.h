@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdio>
+
+// Checks for the tests in tools/. A failed check prints where it failed and the test goes on, so one run reports every
+// failure; main returns FCSE::Tools::Finish() for CTest.
+
+namespace FCSE::Tools {
+    inline int g_failureCount = 0;
+
+    inline bool Check(bool a_condition, const char* a_expression, const char* a_file, int a_line) {
+        if (!a_condition) {
+            std::printf("%s:%d: check failed: %s\n", a_file, a_line, a_expression);
+            ++g_failureCount;
+        }
+        return a_condition;
+    }
+
+    inline int Finish() {
+        if (g_failureCount > 0) {
+            std::printf("%d checks failed\n", g_failureCount);
+            return 1;
+        }
+        std::printf("All checks passed\n");
+        return 0;
+    }
+} // namespace FCSE::Tools
+
+#define FCSE_CHECK(a_condition) ::FCSE::Tools::Check((a_condition), #a_condition, __FILE__, __LINE__)
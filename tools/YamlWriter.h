@@ -0,0 +1,89 @@
+#pragma once
+
+#include "TimelineFile.h"
+
+#include <charconv>
+
+// Writes timelines in the YAML layout TimelineFile::ReadYaml assumes, to make input for the tests, benchmarks and the
+// fuzzer. The plugin never writes YAML itself, FCFW does. References are written as the runtime FormIDs the keyframes
+// hold.
+
+namespace FCSE::Tools {
+    namespace detail {
+        inline std::string_view GetModeName(InterpolationMode a_mode) {
+            switch (a_mode) {
+            case InterpolationMode::kNone:
+                return "none"sv;
+            case InterpolationMode::kLinear:
+                return "linear"sv;
+            default:
+                return "cubicHermite"sv;
+            }
+        }
+
+        // Shortest text that reads back as the same float
+        inline void AppendFloat(std::string& a_out, float a_value) {
+            std::array<char, 32> buffer;
+            const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), a_value);
+            a_out.append(buffer.data(), result.ptr);
+        }
+
+        inline void AppendBool(std::string& a_out, bool a_value) {
+            a_out += a_value ? "true"sv : "false"sv;
+        }
+
+        template <size_t N>
+        void AppendYamlPoint(std::string& a_out, const Keyframe<N>& a_keyframe) {
+            const bool isAtCamera = a_keyframe.flags & kKeyframeAtCamera;
+            const bool isReference = a_keyframe.reference != 0 && !isAtCamera;
+            a_out += "  - time: "sv;
+            AppendFloat(a_out, a_keyframe.time);
+            a_out += isAtCamera ? "\n    type: camera\n"sv : (isReference ? "\n    type: reference\n"sv : "\n    type: world\n"sv);
+            if constexpr (N == 3) {
+                a_out += "    position: {x: "sv;
+                AppendFloat(a_out, a_keyframe.value[0]);
+                a_out += ", y: "sv;
+                AppendFloat(a_out, a_keyframe.value[1]);
+                a_out += ", z: "sv;
+                AppendFloat(a_out, a_keyframe.value[2]);
+            } else {
+                a_out += "    rotation: {pitch: "sv;
+                AppendFloat(a_out, a_keyframe.value[0]);
+                a_out += ", yaw: "sv;
+                AppendFloat(a_out, a_keyframe.value[1]);
+            }
+            a_out += "}\n"sv;
+            if (isReference) {
+                std::array<char, 8> hex;
+                const auto result = std::to_chars(hex.data(), hex.data() + hex.size(), a_keyframe.reference, 16);
+                a_out += "    reference: 0x"sv;
+                a_out.append(8 - static_cast<size_t>(result.ptr - hex.data()), '0');
+                a_out.append(hex.data(), result.ptr);
+                a_out += "\n    isOffsetRelative: "sv;
+                AppendBool(a_out, a_keyframe.flags & kKeyframeOffsetRelative);
+                a_out += "\n"sv;
+            }
+            a_out += "    easeIn: "sv;
+            AppendBool(a_out, a_keyframe.flags & kKeyframeEaseIn);
+            a_out += "\n    easeOut: "sv;
+            AppendBool(a_out, a_keyframe.flags & kKeyframeEaseOut);
+            a_out += "\n    interpolationMode: "sv;
+            a_out += GetModeName(a_keyframe.mode);
+            a_out += "\n"sv;
+        }
+    } // namespace detail
+
+    inline bool WriteYaml(std::string_view a_path, const TimelineData& a_data) {
+        std::string text;
+        text.reserve((a_data.translations.size() + a_data.rotations.size()) * 160 + 64);
+        text += "translationPoints:\n";
+        for (const auto& keyframe : a_data.translations) {
+            detail::AppendYamlPoint(text, keyframe);
+        }
+        text += "rotationPoints:\n";
+        for (const auto& keyframe : a_data.rotations) {
+            detail::AppendYamlPoint(text, keyframe);
+        }
+        return TimelineFile::ReplaceFile(a_path, std::as_bytes(std::span(text)));
+    }
+} // namespace FCSE::Tools
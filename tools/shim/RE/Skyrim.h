@@ -0,0 +1,151 @@
+#pragma once
+
+// The few CommonLibSSE types the timeline file code refers to, so it can be built on Linux by the tools in this
+// folder. Only declarations the tools compile against are here; nothing that touches the game does anything.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#define __declspec(a_attribute)
+
+namespace REL {
+    struct Version {
+        std::uint16_t major = 0;
+        std::uint16_t minor = 0;
+        std::uint16_t patch = 0;
+    };
+} // namespace REL
+
+namespace RE {
+    using FormID = std::uint32_t;
+
+    struct NiPoint3 {
+        float x = 0.f;
+        float y = 0.f;
+        float z = 0.f;
+
+        NiPoint3() = default;
+        NiPoint3(float a_x, float a_y, float a_z) : x(a_x), y(a_y), z(a_z) {}
+
+        NiPoint3 operator+(const NiPoint3& a_rhs) const { return { x + a_rhs.x, y + a_rhs.y, z + a_rhs.z }; }
+        NiPoint3 operator-(const NiPoint3& a_rhs) const { return { x - a_rhs.x, y - a_rhs.y, z - a_rhs.z }; }
+        NiPoint3 operator-() const { return { -x, -y, -z }; }
+        NiPoint3 operator*(float a_scale) const { return { x * a_scale, y * a_scale, z * a_scale }; }
+        NiPoint3 operator/(float a_scale) const { return { x / a_scale, y / a_scale, z / a_scale }; }
+        NiPoint3& operator+=(const NiPoint3& a_rhs) { return *this = *this + a_rhs; }
+        NiPoint3& operator-=(const NiPoint3& a_rhs) { return *this = *this - a_rhs; }
+        NiPoint3& operator*=(float a_scale) { return *this = *this * a_scale; }
+        bool operator==(const NiPoint3&) const = default;
+        float& operator[](std::size_t a_index) { return (&x)[a_index]; }
+        const float& operator[](std::size_t a_index) const { return (&x)[a_index]; }
+
+        float Dot(const NiPoint3& a_rhs) const { return x * a_rhs.x + y * a_rhs.y + z * a_rhs.z; }
+        NiPoint3 Cross(const NiPoint3& a_rhs) const { return { y * a_rhs.z - z * a_rhs.y, z * a_rhs.x - x * a_rhs.z, x * a_rhs.y - y * a_rhs.x }; }
+        float SqrLength() const { return Dot(*this); }
+        float Length() const { return std::sqrt(SqrLength()); }
+        float GetDistance(const NiPoint3& a_rhs) const { return (*this - a_rhs).Length(); }
+        float GetSquaredDistance(const NiPoint3& a_rhs) const { return (*this - a_rhs).SqrLength(); }
+        float Unitize() {
+            const float length = Length();
+            if (length > 0.f) {
+                *this = *this / length;
+            }
+            return length;
+        }
+    };
+
+    template <class T>
+    struct BSTPoint2 {
+        T x{};
+        T y{};
+    };
+
+    template <class T>
+    class NiPointer {
+    public:
+        T* get() const { return m_pointer; }
+        T* operator->() const { return m_pointer; }
+        explicit operator bool() const { return m_pointer != nullptr; }
+
+    private:
+        T* m_pointer = nullptr;
+    };
+
+    struct BSFixedString {
+        const char* c_str() const { return ""; }
+    };
+
+    struct NiAVObject {};
+    struct TESObjectREFR {};
+
+    template <class T>
+    struct BSPointerHandle {
+        NiPointer<T> get() const { return {}; }
+    };
+    using ObjectRefHandle = BSPointerHandle<TESObjectREFR>;
+
+    struct BGSBodyPartDefs {
+        enum LIMB_ENUM : std::uint32_t { kTorso, kHead };
+    };
+
+    enum class INPUT_DEVICE : std::uint32_t { kKeyboard, kMouse, kGamepad };
+    enum class INPUT_EVENT_TYPE : std::uint32_t { kButton, kMouseMove, kChar, kThumbstick };
+
+    // Chains of these are built by the tools, standing in for the game's input device manager
+    struct InputEvent {
+        INPUT_DEVICE GetDevice() const { return device; }
+        INPUT_EVENT_TYPE GetEventType() const { return eventType; }
+
+        INPUT_DEVICE device = INPUT_DEVICE::kKeyboard;
+        INPUT_EVENT_TYPE eventType = INPUT_EVENT_TYPE::kButton;
+        InputEvent* next = nullptr;
+    };
+
+    struct IDEvent : InputEvent {
+        std::uint32_t GetIDCode() const { return idCode; }
+
+        std::uint32_t idCode = 0;
+    };
+
+    struct ButtonEvent : IDEvent {
+        bool IsPressed() const { return value > 0.f; }
+        bool IsDown() const { return IsPressed() && heldDownSecs == 0.f; }
+        bool IsHeld() const { return IsPressed() && heldDownSecs > 0.f; }
+        bool IsUp() const { return value == 0.f && heldDownSecs > 0.f; }
+        float HeldDuration() const { return heldDownSecs; }
+
+        float value = 0.f;
+        float heldDownSecs = 0.f;
+    };
+
+    enum class BSEventNotifyControl { kContinue, kStop };
+
+    template <class Event>
+    struct BSTEventSource {};
+
+    template <class Event>
+    struct BSTEventSink {
+        virtual ~BSTEventSink() = default;
+        virtual BSEventNotifyControl ProcessEvent(const Event* a_event, BSTEventSource<Event>* a_source) = 0;
+    };
+
+    struct TESCellAttachDetachEvent {};
+    struct TESObjectLoadedEvent {};
+} // namespace RE
@@ -0,0 +1,53 @@
+#pragma once
+
+// See RE/Skyrim.h. Logging goes to spdlog's default logger, which the tools silence or redirect.
+
+#include <spdlog/spdlog.h>
+
+// API headers look for other plugins' DLLs; there are none to find here
+inline void* GetModuleHandle(const char*) {
+    return nullptr;
+}
+inline void* GetProcAddress(void*, const char*) {
+    return nullptr;
+}
+
+namespace SKSE {
+    using PluginHandle = std::uint32_t;
+
+    struct InputMap {
+        enum : std::uint32_t {
+            kMacro_MouseButtonOffset = 256,
+            kMaxMacros = 282
+        };
+    };
+
+    struct MessagingInterface {
+        struct Message {
+            const char* sender = nullptr;
+            std::uint32_t type = 0;
+            std::uint32_t dataLen = 0;
+            void* data = nullptr;
+        };
+    };
+
+    // Tasks are queued until a tool runs them with RunTasks, standing in for the game's main thread
+    class TaskInterface {
+    public:
+        void AddTask(std::function<void()> a_task) const;
+        // Runs the queued tasks on the calling thread, returns how many ran
+        size_t RunTasks() const;
+    };
+
+    const TaskInterface* GetTaskInterface();
+
+    namespace log {
+        using spdlog::debug;
+        using spdlog::error;
+        using spdlog::info;
+        using spdlog::trace;
+        using spdlog::warn;
+    } // namespace log
+
+    namespace stl {}
+} // namespace SKSE
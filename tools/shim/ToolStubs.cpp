@@ -0,0 +1,45 @@
+#include "ReferenceResolver.h"
+
+namespace SKSE {
+    namespace {
+        std::mutex g_taskMutex;
+        std::vector<std::function<void()>> g_tasks;
+    }
+
+    void TaskInterface::AddTask(std::function<void()> a_task) const {
+        std::lock_guard lock(g_taskMutex);
+        g_tasks.push_back(std::move(a_task));
+    }
+
+    size_t TaskInterface::RunTasks() const {
+        std::vector<std::function<void()>> tasks;
+        {
+            std::lock_guard lock(g_taskMutex);
+            tasks.swap(g_tasks);
+        }
+        for (auto& task : tasks) {
+            task();
+        }
+        return tasks.size();
+    }
+
+    const TaskInterface* GetTaskInterface() {
+        static const TaskInterface taskInterface;
+        return &taskInterface;
+    }
+} // namespace SKSE
+
+// Keyframes bound to references never resolve outside the game
+namespace FCSE {
+    RE::TESObjectREFR* ReferenceResolver::GetReference(RE::FormID) {
+        return nullptr;
+    }
+
+    RE::BSEventNotifyControl ReferenceResolver::ProcessEvent(const RE::TESCellAttachDetachEvent*, RE::BSTEventSource<RE::TESCellAttachDetachEvent>*) {
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    RE::BSEventNotifyControl ReferenceResolver::ProcessEvent(const RE::TESObjectLoadedEvent*, RE::BSTEventSource<RE::TESObjectLoadedEvent>*) {
+        return RE::BSEventNotifyControl::kContinue;
+    }
+} // namespace FCSE